@@ -315,7 +315,11 @@ int main(int argc, char** argv)
         };
     }
     else if (mode == Mode::Trace)
+    {
+        if (!styledJson)
+            st.setOutput(cout);
         onOp = st.onOp();
+    }
 
     Timer timer;
     executive.go(onOp);
@@ -352,7 +356,10 @@ int main(int argc, char** argv)
         }
     }
     else if (mode == Mode::Trace)
-        cout << (styledJson ? st.styledJson() : st.multilineTrace());
+    {
+        if (styledJson)
+            cout << st.styledJson();
+    }
     else if (mode == Mode::OutputOnly)
         cout << toHex(output) << '\n';
     else if (mode == Mode::Test)
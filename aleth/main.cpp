@@ -21,6 +21,7 @@
 #include <libethashseal/GenesisInfo.h>
 #include <libethcore/Common.h>
 #include <libethcore/KeyManager.h>
+#include <libethereum/SnapshotExporter.h>
 #include <libethereum/SnapshotImporter.h>
 #include <libethereum/SnapshotStorage.h>
 #include <libevm/VMFactory.h>
@@ -79,7 +80,9 @@ enum class OperationMode
     Node,
     Import,
     ImportSnapshot,
-    Export
+    ExportSnapshot,
+    Export,
+    BackfillLogIndex
 };
 
 enum class Format
@@ -131,6 +134,7 @@ int main(int argc, char** argv)
     /// Hashes/numbers for export range.
     string exportFrom = "1";
     string exportTo = "latest";
+    unsigned snapshotBlocks = SnapshotExporter::c_defaultBlockCount;
     Format exportFormat = Format::Binary;
 
     bool ipc = true;
@@ -153,12 +157,20 @@ int main(int argc, char** argv)
 	std::string rpcCorsDomain = "";
 	std::string httpsKey = "";
 	std::string httpsCert = "";
+	unsigned rpcBatchThreads = rpc::BatchRequestHandler::c_defaultThreads;
+#if !defined(_WIN32)
+	unsigned ipcThreads = UnixDomainSocketServer::c_defaultThreads;
+	unsigned ipcWriteThreads = UnixDomainSocketServer::c_defaultWriteThreads;
+#endif
+    unsigned debugCheckpoints = 0;
 
     unsigned peers = 11;
     unsigned peerStretch = 7;
     std::map<p2p::NodeID, pair<NodeIPEndpoint, bool>> preferredNodes;
     bool bootstrap = true;
 	bool qpos = false;
+	bool qposPipeline = false;
+	bool qposCompactProposals = false;
     bool disableDiscovery = false;
     bool allowLocalDiscovery = false;
     static const unsigned NoNetworkID = (unsigned)-1;
@@ -218,6 +230,8 @@ int main(int argc, char** argv)
     auto addClientOption = clientDefaultMode.add_options();
     addClientOption("mainnet", "Use the main network protocol");
 	addClientOption("qpos", "Use the qpos network protocol");
+	addClientOption("qpos-pipeline", "Propose the next qpos block while the previous one is still being imported");
+	addClientOption("qpos-compact-proposals", "Propose qpos blocks by transaction hashes; all miners must support it");
     addClientOption("ropsten", "Use the Ropsten testnet");
     addClientOption("test", "Testing mode; disable PoW and provide test rpc interface");
     addClientOption("config", po::value<string>()->value_name("<file>"),
@@ -226,12 +240,23 @@ int main(int argc, char** argv)
     addClientOption("ipcpath", po::value<string>()->value_name("<path>"),
         "Set .ipc socket path (default: data directory)");
     addClientOption("no-ipc", "Disable IPC server");
+#if !defined(_WIN32)
+    addClientOption("ipc-threads", po::value<unsigned>()->value_name("<n>"),
+        ("Run up to n read-only IPC requests in parallel (default: " +
+            toString(UnixDomainSocketServer::c_defaultThreads) + ")").c_str());
+    addClientOption("ipc-write-threads", po::value<unsigned>()->value_name("<n>"),
+        ("Run up to n other IPC requests of different connections in parallel (default: " +
+            toString(UnixDomainSocketServer::c_defaultWriteThreads) + ")").c_str());
+#endif
     addClientOption("admin", po::value<string>()->value_name("<password>"),
         "Specify admin session key for JSON-RPC (default: auto-generated and printed at "
         "start-up)");
     addClientOption("kill,K", "Kill the blockchain first");
     addClientOption("rebuild,R", "Rebuild the blockchain from the existing database");
     addClientOption("rescue", "Attempt to rescue a corrupt database\n");
+    addClientOption("debug-checkpoints", po::value<unsigned>()->value_name("<n>"),
+        "Keep the state every <n> transactions of recently enacted blocks to speed up the debug "
+        "JSON-RPC methods (default: off)");
     addClientOption("import-presale", po::value<string>()->value_name("<file>"),
         "Import a pre-sale key; you'll need to specify the password to this key");
     addClientOption("import-secret,s", po::value<string>()->value_name("<secret>"),
@@ -296,6 +321,9 @@ int main(int argc, char** argv)
         "Https private key.");
 	addNetworkingOption("https_cert", po::value<string>()->value_name("<string>"),
         "Https certificate.");
+	addNetworkingOption("json-rpc-batch-threads", po::value<unsigned>()->value_name("<n>"),
+        ("Run up to n calls of a JSON-RPC batch request in parallel (default: " +
+            toString(rpc::BatchRequestHandler::c_defaultThreads) + ").").c_str());
 	
     addNetworkingOption("network-id", po::value<unsigned>()->value_name("<n>"),
         "Only connect to other hosts with this network id");
@@ -344,7 +372,16 @@ int main(int argc, char** argv)
         po::value<string>(&snapshotPath)->value_name("<path>"),
         "Download Parity Warp Sync snapshot data to the specified path");
     addImportExportOption("import-snapshot", po::value<string>()->value_name("<path>"),
-        "Import blockchain and state data from the Parity Warp Sync snapshot\n");
+        "Import blockchain and state data from the Parity Warp Sync snapshot");
+    addImportExportOption("export-snapshot", po::value<string>()->value_name("<path>"),
+        "Export a Parity Warp Sync snapshot of the state at block --to and the blocks before it "
+        "to the specified path; this node serves it to warp-syncing peers from the next start");
+    addImportExportOption("snapshot-blocks", po::value<unsigned>()->value_name("<n>"),
+        ("Number of blocks included in an exported snapshot (default: " +
+            toString(SnapshotExporter::c_defaultBlockCount) + ")")
+            .c_str());
+    addImportExportOption("backfill-log-index",
+        "Index the logs of the blocks imported before --log-index was enabled, then exit\n");
 
     std::string const logChannels =
         "block blockhdr bq chain client debug discov error ethcap exec host impolite info net "
@@ -402,6 +439,13 @@ int main(int argc, char** argv)
         mode = OperationMode::ImportSnapshot;
         filename = vm["import-snapshot"].as<string>();
     }
+    if (vm.count("export-snapshot"))
+    {
+        mode = OperationMode::ExportSnapshot;
+        filename = vm["export-snapshot"].as<string>();
+    }
+    if (vm.count("snapshot-blocks"))
+        snapshotBlocks = vm["snapshot-blocks"].as<unsigned>();
     if (vm.count("version"))
     {
         version();
@@ -494,6 +538,12 @@ int main(int argc, char** argv)
         setDataDir(vm["data-dir"].as<string>());
     if (vm.count("ipcpath"))
         setIpcPath(vm["ipcpath"].as<string>());
+#if !defined(_WIN32)
+    if (vm.count("ipc-threads"))
+        ipcThreads = vm["ipc-threads"].as<unsigned>();
+    if (vm.count("ipc-write-threads"))
+        ipcWriteThreads = vm["ipc-write-threads"].as<unsigned>();
+#endif
     if (vm.count("config"))
     {
         try
@@ -541,6 +591,10 @@ int main(int argc, char** argv)
         chainConfigIsSet = true;
 		qpos = true;
     }
+	if (vm.count("qpos-pipeline"))
+		qposPipeline = true;
+	if (vm.count("qpos-compact-proposals"))
+		qposCompactProposals = true;
     if (vm.count("ask"))
     {
         try
@@ -635,6 +689,10 @@ int main(int argc, char** argv)
     {
         httpsCert = vm["rpccorsdomain"].as<string>();
     }
+	if (vm.count("json-rpc-batch-threads"))
+    {
+        rpcBatchThreads = vm["json-rpc-batch-threads"].as<unsigned>();
+    }
 
 	
     if (vm.count("import"))
@@ -647,6 +705,11 @@ int main(int argc, char** argv)
         mode = OperationMode::Export;
         filename = vm["export"].as<string>();
     }
+    if (vm.count("backfill-log-index"))
+    {
+        mode = OperationMode::BackfillLogIndex;
+        db::setLogIndexEnabled(true);
+    }
     if (vm.count("password"))
         passwordsToNote.push_back(vm["password"].as<string>());
     if (vm.count("master"))
@@ -708,6 +771,8 @@ int main(int argc, char** argv)
         withExisting = WithExisting::Verify;
     if (vm.count("rescue"))
         withExisting = WithExisting::Rescue;
+    if (vm.count("debug-checkpoints"))
+        debugCheckpoints = vm["debug-checkpoints"].as<unsigned>();
     if (vm.count("address"))
         try
         {
@@ -829,6 +894,10 @@ int main(int argc, char** argv)
 
     if (testingMode)
         chainParams.allowFutureBlocks = true;
+	if (qposPipeline)
+		chainParams.qposPipeline = true;
+	if (qposCompactProposals)
+		chainParams.qposCompactProposals = true;
 
     dev::WebThreeDirect web3(WebThreeDirect::composeClientVersion("aleth"), db::databasePath(),
         snapshotPath, chainParams, withExisting, netPrefs, &nodesState, testingMode);
@@ -836,6 +905,8 @@ int main(int argc, char** argv)
     if (!extraData.empty())
         web3.ethereum()->setExtraData(extraData);
 
+    web3.ethereum()->blockChain().stateCheckpoints().setInterval(debugCheckpoints);
+
     auto toNumber = [&](string const& s) -> unsigned {
         if (s == "latest")
             return web3.ethereum()->number();
@@ -872,6 +943,50 @@ int main(int argc, char** argv)
         return AlethErrors::Success;
     }
 
+    if (mode == OperationMode::ExportSnapshot)
+    {
+        try
+        {
+            BlockChain const& bc = web3.ethereum()->blockChain();
+            h256 const blockHash = bc.numberHash(toNumber(exportTo));
+            SnapshotExporter(filename).exportSnapshot(
+                bc, web3.ethereum()->stateDB(), blockHash, snapshotBlocks);
+
+            // Replace the snapshot this node serves, once the copy has been read back in full.
+            fs::path const served = importedSnapshotPath(db::databasePath(), bc.genesisHash());
+            if (!fs::exists(served) || !fs::equivalent(filename, served))
+            {
+                fs::path const staged = served.string() + ".new";
+                fs::remove_all(staged);
+                createSnapshotStorage(filename)->copyTo(staged);
+                verifySnapshot(*createSnapshotStorage(staged));
+                fs::remove_all(served);
+                fs::rename(staged, served);
+            }
+        }
+        catch (...)
+        {
+            cerr << "Error during exporting the snapshot: " << boost::current_exception_diagnostic_information() << endl;
+            return AlethErrors::SnapshotExportFailure;
+        }
+        return AlethErrors::Success;
+    }
+
+    if (mode == OperationMode::BackfillLogIndex)
+    {
+        chrono::steady_clock::time_point t = chrono::steady_clock::now();
+        unsigned last = 0;
+        web3.ethereum()->rebuildLogIndex([&](unsigned _done, unsigned _total) {
+            double e = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - t).count() / 1000.0;
+            if ((unsigned)e >= last + 10 || _done == _total)
+            {
+                cout << _done << "/" << _total << " blocks indexed in " << e << " seconds\n";
+                last = (unsigned)e;
+            }
+        });
+        return AlethErrors::Success;
+    }
+
     if (mode == OperationMode::Import)
     {
         ifstream fin(filename, std::ifstream::binary);
@@ -1072,7 +1187,12 @@ int main(int argc, char** argv)
             new rpc::Debug(*web3.ethereum()),
             testEth
         ));
+        jsonrpcIpcServer->setBatchThreads(rpcBatchThreads);
+#if defined(_WIN32)
         auto ipcConnector = new IpcServer("geth");
+#else
+        auto ipcConnector = new IpcServer("geth", ipcThreads, ipcWriteThreads);
+#endif
         jsonrpcIpcServer->addConnector(ipcConnector);
         ipcConnector->StartListening();
 
@@ -1120,6 +1240,7 @@ int main(int argc, char** argv)
 		//int port = 8545;
 		auto httpConnector = new SafeHttpServer(httpRpcPort, httpsKey, httpsCert, SensibleHttpThreads);
 		httpConnector->setAllowedOrigin(rpcCorsDomain);
+		jsonrpcHttpServer->setBatchThreads(rpcBatchThreads);
 		jsonrpcHttpServer->addConnector(httpConnector);
 		jsonrpcHttpServer->StartListening();
 
@@ -0,0 +1,38 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+#include "CodeAnalysisCache.h"
+
+namespace dev
+{
+namespace eth
+{
+namespace
+{
+/// Rough cost of the list node, the index entry and the analysis object itself.
+constexpr size_t c_entryOverhead = 128;
+}  // namespace
+
+CodeAnalysisCache& CodeAnalysisCache::instance()
+{
+    static CodeAnalysisCache s_cache(c_defaultCapacity);
+    return s_cache;
+}
+
+std::shared_ptr<CodeAnalysis const> CodeAnalysisCache::find(h256 const& _codeHash, int _revision)
+{
+    std::shared_ptr<CodeAnalysis const> ret;
+    m_cache.lookup(Key{_codeHash, _revision}, ret);
+    return ret;
+}
+
+void CodeAnalysisCache::insert(
+    h256 const& _codeHash, int _revision, std::shared_ptr<CodeAnalysis const> _analysis)
+{
+    size_t const size = _analysis->byteSize() + c_entryOverhead;
+    // Another instance may have analysed the same code meanwhile; the result is identical.
+    m_cache.insert(Key{_codeHash, _revision}, std::move(_analysis), size, false);
+}
+
+}  // namespace eth
+}  // namespace dev
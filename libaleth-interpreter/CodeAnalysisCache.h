@@ -0,0 +1,98 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+#pragma once
+
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/ShardedLruCache.h>
+#include <intx/intx.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace dev
+{
+namespace eth
+{
+/// Result of the interpreter's analysis pass over one piece of code. Never modified once
+/// built, so any number of interpreter instances may run from it at the same time.
+struct CodeAnalysis
+{
+    /// Static cost and stack bounds of one basic block, checked once on entering it.
+    struct Block
+    {
+        /// Gas of the instructions whose cost doesn't depend on their operands or the state.
+        uint64_t gas = 0;
+        /// Stack items the block reads below the height it starts at.
+        int32_t stackRequired = 0;
+        /// Highest stack height the block reaches above the height it starts at.
+        int32_t stackMaxGrowth = 0;
+    };
+
+    /// The code with synthetic instructions patched in, zero-padded so that a PUSH at the end
+    /// can be read without bounds checks.
+    bytes code;
+    /// Constants pushed by PUSHC.
+    std::vector<intx::uint256> pool;
+    /// Offsets of all JUMPDESTs, in ascending order.
+    std::vector<uint64_t> jumpDests;
+    /// Basic blocks of the code, in order, and for each code offset the block starting there.
+    std::vector<Block> blocks;
+    std::vector<uint32_t> blockAt;
+
+    size_t byteSize() const
+    {
+        return code.size() + pool.size() * sizeof(intx::uint256) +
+               jumpDests.size() * sizeof(uint64_t) + blocks.size() * sizeof(Block) +
+               blockAt.size() * sizeof(uint32_t);
+    }
+};
+
+/// Process-wide cache of code analyses keyed by code hash and EVM revision, bounded by their
+/// total size.
+class CodeAnalysisCache
+{
+public:
+    static constexpr size_t c_defaultCapacity = 32 * 1024 * 1024;
+
+    /// The cache shared by all interpreter instances.
+    static CodeAnalysisCache& instance();
+
+    explicit CodeAnalysisCache(size_t _capacityBytes) : m_cache(_capacityBytes) {}
+
+    /// @returns the analysis of the code with hash @a _codeHash for @a _revision, or null if it
+    /// isn't cached.
+    std::shared_ptr<CodeAnalysis const> find(h256 const& _codeHash, int _revision);
+    void insert(
+        h256 const& _codeHash, int _revision, std::shared_ptr<CodeAnalysis const> _analysis);
+
+    /// Changes the budget; shards over it shrink on their next insertion.
+    void setCapacity(size_t _capacityBytes) noexcept { m_cache.setCapacity(_capacityBytes); }
+    size_t capacity() const noexcept { return m_cache.capacity(); }
+
+    uint64_t hits() const { return m_cache.stats().hits; }
+    uint64_t misses() const { return m_cache.stats().misses; }
+    size_t bytes() const { return m_cache.stats().bytes; }
+
+private:
+    struct Key
+    {
+        h256 codeHash;
+        int revision;
+
+        bool operator==(Key const& _k) const
+        {
+            return revision == _k.revision && codeHash == _k.codeHash;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(Key const& _k) const { return h256::hash()(_k.codeHash) + _k.revision; }
+    };
+
+    ShardedLruCache<Key, std::shared_ptr<CodeAnalysis const>, KeyHash> m_cache;
+};
+
+}  // namespace eth
+}  // namespace dev
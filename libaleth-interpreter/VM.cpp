@@ -5,6 +5,7 @@
 #include "VM.h"
 
 #include <aleth/version.h>
+#include <libevm/FramePool.h>
 
 namespace
 {
@@ -28,7 +29,7 @@ evmc_result execute(evmc_vm* _instance, evmc_host_context* _context, evmc_revisi
     const evmc_message* _msg, uint8_t const* _code, size_t _codeSize) noexcept
 {
     (void)_instance;
-    std::unique_ptr<dev::eth::VM> vm{new dev::eth::VM};
+    auto vm = dev::eth::FramePool<dev::eth::VM>::acquire();
 
     evmc_result result = {};
     dev::eth::owning_bytes_ref output;
@@ -85,6 +86,7 @@ evmc_result execute(evmc_vm* _instance, evmc_host_context* _context, evmc_revisi
     {
         result.status_code = EVMC_INTERNAL_ERROR;
     }
+    dev::eth::FramePool<dev::eth::VM>::release(std::move(vm));
 
     if (!output.empty())
     {
@@ -98,6 +100,29 @@ evmc_result execute(evmc_vm* _instance, evmc_host_context* _context, evmc_revisi
 
     return result;
 }
+
+evmc_set_option_result setOption(evmc_vm* _instance, char const* _name, char const* _value) noexcept
+{
+    (void)_instance;
+    // Size of the code analysis cache shared by all instances, in MiB.
+    if (std::string(_name) == "analysis-cache-mb")
+    {
+        try
+        {
+            size_t pos = 0;
+            unsigned long const mb = std::stoul(_value, &pos);
+            if (_value[pos] != '\0')
+                return EVMC_SET_OPTION_INVALID_VALUE;
+            dev::eth::CodeAnalysisCache::instance().setCapacity(mb * 1024 * 1024);
+            return EVMC_SET_OPTION_SUCCESS;
+        }
+        catch (...)
+        {
+            return EVMC_SET_OPTION_INVALID_VALUE;
+        }
+    }
+    return EVMC_SET_OPTION_INVALID_NAME;
+}
 }  // namespace
 
 extern "C" evmc_vm* evmc_create_interpreter() noexcept
@@ -105,7 +130,7 @@ extern "C" evmc_vm* evmc_create_interpreter() noexcept
     // TODO: Allow creating multiple instances with different configurations.
     static evmc_vm s_vm{
         EVMC_ABI_VERSION, "interpreter", aleth_version, ::destroy, ::execute, getCapabilities,
-        nullptr,  // set_option
+        setOption,
     };
     static bool metricsInited = dev::eth::VM::initMetrics();
     (void)metricsInited;
@@ -214,7 +239,13 @@ void VM::fetchInstruction()
 {
     m_OP = Instruction(m_code[m_PC]);
     auto const metric = (*m_metrics)[static_cast<size_t>(m_OP)];
+#if EVM_BLOCK_METERING
+    // stack bounds were checked on entering the basic block
+    m_SP = m_SPP;
+    m_SPP -= metric.stack_height_change;
+#else
     adjustStack(metric.stack_height_required, metric.stack_height_change);
+#endif
 
     // FEES...
     m_runGas = metric.gas_cost;
@@ -222,6 +253,28 @@ void VM::fetchInstruction()
     m_copyMemSize = 0;
 }
 
+#if EVM_BLOCK_METERING
+void VM::chargeBlock()
+{
+    auto const& block = m_analysis->blocks[m_analysis->blockAt[m_PC]];
+
+    int64_t const size = m_stackEnd - m_SPP;
+    if (size < block.stackRequired || size + block.stackMaxGrowth > VMSchedule::stackLimit)
+        throwBadStack(block.stackRequired, block.stackMaxGrowth);
+
+    if (m_io_gas < block.gas)
+        throwOutOfGas();
+    m_io_gas -= block.gas;
+}
+
+void VM::fallIntoBlock()
+{
+    // blocks starting at a JUMPDEST are charged by the JUMPDEST
+    if (Instruction(m_code[m_PC]) != Instruction::JUMPDEST)
+        chargeBlock();
+}
+#endif
+
 evmc_tx_context const& VM::getTxContext()
 {
     if (!m_tx_context)
@@ -239,7 +292,11 @@ owning_bytes_ref VM::exec(evmc_host_context* _context, evmc_revision _rev, const
 {
     m_context = _context;
     m_rev = _rev;
+#if EVM_BLOCK_METERING
+    m_metrics = &s_blockMetrics[m_rev];
+#else
     m_metrics = &s_metrics[m_rev];
+#endif
     m_message = _msg;
     m_io_gas = uint64_t(_msg->gas);
     m_PC = 0;
@@ -255,6 +312,33 @@ owning_bytes_ref VM::exec(evmc_host_context* _context, evmc_revision _rev, const
     return std::move(m_output);
 }
 
+void VM::recycle() noexcept
+{
+    recycleBuffer(m_mem);
+    recycleBuffer(m_returnData);
+    m_beginSubs.clear();
+    m_output = owning_bytes_ref();
+    m_analysis.reset();
+    m_code = nullptr;
+    m_pool = nullptr;
+
+    m_io_gas = 0;
+    m_context = nullptr;
+    m_rev = EVMC_FRONTIER;
+    m_metrics = nullptr;
+    m_message = nullptr;
+    m_tx_context.reset();
+    m_bounce = nullptr;
+    m_nSteps = 0;
+    m_pCode = nullptr;
+    m_codeSize = 0;
+    m_PC = 0;
+    m_SP = m_SPP = m_stackEnd;
+    m_runGas = 0;
+    m_newMemSize = 0;
+    m_copyMemSize = 0;
+}
+
 //
 // main interpreter loop and switch
 //
@@ -1170,6 +1254,19 @@ void VM::interpretCases()
         }
         NEXT
 
+        CASE(POP2)
+        {
+#if EVM_FUSE_INSTRUCTIONS
+            ON_OP();
+            updateIOGas();
+
+            m_PC += 2;
+#else
+            throwBadInstruction();
+#endif
+        }
+        CONTINUE
+
         CASE(PUSHC)
         {
 #if EVM_USE_CONSTANT_POOL
@@ -1261,7 +1358,12 @@ void VM::interpretCases()
             if (m_SP[1])
                 m_PC = verifyJumpDest(m_SP[0]);
             else
+            {
                 ++m_PC;
+#if EVM_BLOCK_METERING
+                fallIntoBlock();
+#endif
+            }
         }
         CONTINUE
 
@@ -1287,7 +1389,12 @@ void VM::interpretCases()
             if (m_SP[1])
                 m_PC = uint64_t(m_SP[0]);
             else
+            {
                 ++m_PC;
+#if EVM_BLOCK_METERING
+                fallIntoBlock();
+#endif
+            }
 #else
             throwBadInstruction();
 #endif
@@ -1349,6 +1456,20 @@ void VM::interpretCases()
         }
         NEXT
 
+        CASE(SWAP1POP)
+        {
+#if EVM_FUSE_INSTRUCTIONS
+            ON_OP();
+            updateIOGas();
+
+            m_SPP[0] = m_SP[0];
+            m_PC += 2;
+#else
+            throwBadInstruction();
+#endif
+        }
+        CONTINUE
+
 
         CASE(SLOAD)
         {
@@ -1387,14 +1508,19 @@ void VM::interpretCases()
             case EVMC_STORAGE_UNCHANGED:
             case EVMC_STORAGE_MODIFIED_AGAIN:
                 m_runGas = (m_rev == EVMC_CONSTANTINOPLE || m_rev >= EVMC_ISTANBUL) ?
-                               (*m_metrics)[OP_SLOAD].gas_cost :
+                               s_metrics[m_rev][OP_SLOAD].gas_cost :
                                VMSchedule::sstoreResetGas;
                 break;
             }
 
             updateIOGas();
+
+            ++m_PC;
+#if EVM_BLOCK_METERING
+            fallIntoBlock();
+#endif
         }
-        NEXT
+        CONTINUE
 
         CASE(PC)
         {
@@ -1420,14 +1546,22 @@ void VM::interpretCases()
             updateIOGas();
 
             m_SPP[0] = m_io_gas;
+
+            ++m_PC;
+#if EVM_BLOCK_METERING
+            fallIntoBlock();
+#endif
         }
-        NEXT
+        CONTINUE
 
         CASE(JUMPDEST)
         {
             m_runGas = VMSchedule::jumpdestGas;
             ON_OP();
             updateIOGas();
+#if EVM_BLOCK_METERING
+            chargeBlock();
+#endif
         }
         NEXT
 
@@ -3,6 +3,7 @@
 // Licensed under the GNU General Public License, Version 3.
 #pragma once
 
+#include "CodeAnalysisCache.h"
 #include "VMConfig.h"
 
 #include <libevm/VMFace.h>
@@ -56,6 +57,9 @@ public:
     owning_bytes_ref exec(evmc_host_context* _context, evmc_revision _rev, const evmc_message* _msg,
         uint8_t const* _code, size_t _codeSize);
 
+    /// Resets the VM for the next frame, keeping its buffers unless they grew unusually large.
+    void recycle() noexcept;
+
     uint64_t m_io_gas = 0;
 private:
     evmc_host_context* m_context = nullptr;
@@ -64,7 +68,11 @@ private:
     evmc_message const* m_message = nullptr;
     boost::optional<evmc_tx_context> m_tx_context;
     static std::array<std::array<evmc_instruction_metrics, 256>, EVMC_MAX_REVISION + 1> s_metrics;
-    void copyCode(int);
+#if EVM_BLOCK_METERING
+    // same as s_metrics, but without the gas charged per basic block
+    static std::array<std::array<evmc_instruction_metrics, 256>, EVMC_MAX_REVISION + 1>
+        s_blockMetrics;
+#endif
     typedef void (VM::*MemFnPtr)();
     MemFnPtr m_bounce = nullptr;
     uint64_t m_nSteps = 0;
@@ -77,8 +85,9 @@ private:
 
     uint8_t const* m_pCode = nullptr;
     size_t m_codeSize = 0;
-    // space for code
-    bytes m_code;
+    // analysed code, possibly shared with other instances
+    std::shared_ptr<CodeAnalysis const> m_analysis;
+    byte const* m_code = nullptr;
 
     /// RETURNDATA buffer for memory returned from direct subcalls.
     bytes m_returnData;
@@ -89,7 +98,7 @@ private:
     size_t stackSize() { return m_stackEnd - m_SP; }
     
     // constant pool
-    std::vector<intx::uint256> m_pool;
+    intx::uint256 const* m_pool = nullptr;
 
     // interpreter state
     Instruction m_OP;         // current operation
@@ -104,7 +113,8 @@ private:
 
     // initialize interpreter
     void initEntry();
-    void optimize();
+    static std::shared_ptr<CodeAnalysis const> analyse(
+        uint8_t const* _code, size_t _codeSize, evmc_revision _rev);
 
     // interpreter loop & switch
     void interpretCases();
@@ -129,8 +139,8 @@ private:
     void throwBufferOverrun(intx::uint512 const& _enfOfAccess);
 
     std::vector<uint64_t> m_beginSubs;
-    std::vector<uint64_t> m_jumpDests;
     int64_t verifyJumpDest(intx::uint256 const& _dest, bool _throw = true);
+    static int64_t findJumpDest(std::vector<uint64_t> const& _jumpDests, intx::uint256 const& _dest);
 
     void onOperation() {}
     void adjustStack(int _removed, int _added);
@@ -140,6 +150,10 @@ private:
     void updateMem(uint64_t _newMem);
     void logGasMem();
     void fetchInstruction();
+#if EVM_BLOCK_METERING
+    void chargeBlock();
+    void fallIntoBlock();
+#endif
     
     uint64_t decodeJumpDest(const byte* const _code, uint64_t& _pc);
     uint64_t decodeJumpvDest(const byte* const _code, uint64_t& _pc, byte _voff);
@@ -76,7 +76,7 @@ void VM::throwBufferOverrun(intx::uint512 const& _endOfAccess)
             bigint(std::string("0x") + intx::hex(_endOfAccess)), bigint(m_returnData.size())));
 }
 
-int64_t VM::verifyJumpDest(intx::uint256 const& _dest, bool _throw)
+int64_t VM::findJumpDest(std::vector<uint64_t> const& _jumpDests, intx::uint256 const& _dest)
 {
     // check for overflow
     if (_dest <= 0x7FFFFFFFFFFFFFFF) {
@@ -84,14 +84,20 @@ int64_t VM::verifyJumpDest(intx::uint256 const& _dest, bool _throw)
         // check for within bounds and to a jump destination
         // use binary search of array because hashtable collisions are exploitable
         uint64_t pc = uint64_t(_dest);
-        if (std::binary_search(m_jumpDests.begin(), m_jumpDests.end(), pc))
+        if (std::binary_search(_jumpDests.begin(), _jumpDests.end(), pc))
             return pc;
     }
-    if (_throw)
-        throwBadJumpDestination();
     return -1;
 }
 
+int64_t VM::verifyJumpDest(intx::uint256 const& _dest, bool _throw)
+{
+    int64_t const pc = findJumpDest(m_analysis->jumpDests, _dest);
+    if (pc < 0 && _throw)
+        throwBadJumpDestination();
+    return pc;
+}
+
 
 //
 // interpreter cases that call out
@@ -157,6 +163,9 @@ void VM::caseCreate()
     else
         m_SPP[0] = 0;
     ++m_PC;
+#if EVM_BLOCK_METERING
+    fallIntoBlock();
+#endif
 }
 
 void VM::caseCall()
@@ -188,6 +197,9 @@ void VM::caseCall()
         m_io_gas += msg.gas;
     }
     ++m_PC;
+#if EVM_BLOCK_METERING
+    fallIntoBlock();
+#endif
 }
 
 bool VM::caseCallSetup(evmc_message& o_msg, bytesRef& o_output)
@@ -20,6 +20,10 @@ namespace eth
 //
 // EVM_REPLACE_CONST_JUMP - pre-verified jumps to save runtime lookup
 //
+// EVM_BLOCK_METERING     - static gas and stack bounds checked once per basic block
+//
+// EVM_FUSE_INSTRUCTIONS  - common instruction pairs replaced by one synthetic instruction
+//
 // EVM_TRACE              - provides various levels of tracing
 
 #ifndef EVM_JUMP_DISPATCH
@@ -44,6 +48,8 @@ namespace eth
 #define EVM_REPLACE_CONST_JUMP true
 #define EVM_USE_CONSTANT_POOL true
 #define EVM_DO_FIRST_PASS_OPTIMIZATION (EVM_REPLACE_CONST_JUMP || EVM_USE_CONSTANT_POOL)
+#define EVM_BLOCK_METERING true
+#define EVM_FUSE_INSTRUCTIONS true
 #endif
 
 
@@ -309,8 +315,8 @@ namespace eth
         &&INVALID,                              \
         &&INVALID,                              \
         &&INVALID,                              \
-        &&INVALID,                              \
-        &&INVALID,                              \
+        &&SWAP1POP,                             \
+        &&POP2,                                 \
         &&PUSHC,                                \
         &&JUMPC,                                \
         &&JUMPCI,                               \
@@ -3,11 +3,78 @@
 // Licensed under the GNU General Public License, Version 3.
 #include "VM.h"
 
+#include <ethash/keccak.hpp>
+
 namespace dev
 {
 namespace eth
 {
+#if EVM_BLOCK_METERING
+namespace
+{
+// Instructions that charge their own gas, because their cost depends on their operands or on
+// the state, or because they read the gas left.
+bool isSelfMetered(Instruction _op)
+{
+    switch (_op)
+    {
+    case Instruction::SHA3:
+    case Instruction::EXP:
+    case Instruction::BLOCKHASH:
+    case Instruction::SSTORE:
+    case Instruction::GAS:
+    case Instruction::JUMPDEST:
+    case Instruction::LOG0:
+    case Instruction::LOG1:
+    case Instruction::LOG2:
+    case Instruction::LOG3:
+    case Instruction::LOG4:
+    case Instruction::CREATE:
+    case Instruction::CREATE2:
+    case Instruction::CALL:
+    case Instruction::CALLCODE:
+    case Instruction::DELEGATECALL:
+    case Instruction::STATICCALL:
+    case Instruction::SELFDESTRUCT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Instructions that don't fall through to the next one, and those that read the gas left, which
+// must not include the cost of any later instruction yet.
+bool endsBlock(Instruction _op)
+{
+    switch (_op)
+    {
+    case Instruction::STOP:
+    case Instruction::JUMP:
+    case Instruction::JUMPI:
+    case Instruction::RETURN:
+    case Instruction::REVERT:
+    case Instruction::INVALID:
+    case Instruction::SELFDESTRUCT:
+    case Instruction::SSTORE:
+    case Instruction::GAS:
+    case Instruction::CREATE:
+    case Instruction::CREATE2:
+    case Instruction::CALL:
+    case Instruction::CALLCODE:
+    case Instruction::DELEGATECALL:
+    case Instruction::STATICCALL:
+        return true;
+    default:
+        return false;
+    }
+}
+}  // namespace
+#endif
+
 std::array<std::array<evmc_instruction_metrics, 256>, EVMC_MAX_REVISION + 1> VM::s_metrics;
+#if EVM_BLOCK_METERING
+std::array<std::array<evmc_instruction_metrics, 256>, EVMC_MAX_REVISION + 1> VM::s_blockMetrics;
+#endif
 
 bool VM::initMetrics()
 {
@@ -24,49 +91,62 @@ bool VM::initMetrics()
         metrics[uint8_t(Instruction::PUSHC)] = metrics[uint8_t(Instruction::PUSH1)];
         metrics[uint8_t(Instruction::JUMPC)] = metrics[uint8_t(Instruction::JUMP)];
         metrics[uint8_t(Instruction::JUMPCI)] = s_metrics[revision][uint8_t(Instruction::JUMPI)];
+        auto const& pop = metrics[uint8_t(Instruction::POP)];
+        metrics[uint8_t(Instruction::SWAP1POP)] = {
+            int16_t(metrics[uint8_t(Instruction::SWAP1)].gas_cost + pop.gas_cost), 2, -1};
+        metrics[uint8_t(Instruction::POP2)] = {int16_t(2 * pop.gas_cost), 2, -2};
+
+#if EVM_BLOCK_METERING
+        // The static cost of everything else is charged on entering its basic block.
+        auto& blockMetrics = s_blockMetrics[revision];
+        blockMetrics = metrics;
+        for (size_t op = 0; op < blockMetrics.size(); ++op)
+            if (blockMetrics[op].gas_cost > 0 && !isSelfMetered(Instruction(op)))
+                blockMetrics[op].gas_cost = 0;
+#endif
     };
     return true;
 }
 
-void VM::copyCode(int _extraBytes)
+std::shared_ptr<CodeAnalysis const> VM::analyse(
+    uint8_t const* _code, size_t _codeSize, evmc_revision _rev)
 {
-    // Copy code so that it can be safely modified and extend code by
-    // _extraBytes zero bytes to allow reading virtual data at the end
-    // of the code without bounds checks.
-    auto extendedSize = m_codeSize + _extraBytes;
-    m_code.reserve(extendedSize);
-    m_code.assign(m_pCode, m_pCode + m_codeSize);
-    m_code.resize(extendedSize);
-}
+    auto analysis = std::make_shared<CodeAnalysis>();
+    bytes& code = analysis->code;
+    std::vector<uint64_t>& jumpDests = analysis->jumpDests;
 
-void VM::optimize()
-{
-    copyCode(33);
+    // Copy code so that it can be safely modified and extend it by 33 zero bytes to allow
+    // reading virtual data at the end of the code without bounds checks.
+    code.reserve(_codeSize + 33);
+    code.assign(_code, _code + _codeSize);
+    code.resize(_codeSize + 33);
 
-    size_t const nBytes = m_codeSize;
+    size_t const nBytes = _codeSize;
 
     // build a table of jump destinations for use in verifyJumpDest
     
     TRACE_STR(1, "Build JUMPDEST table")
     for (size_t pc = 0; pc < nBytes; ++pc)
     {
-        Instruction op = Instruction(m_code[pc]);
+        Instruction op = Instruction(code[pc]);
         TRACE_OP(2, pc, op);
                 
         // make synthetic ops in user code trigger invalid instruction if run
         if (
+            op == Instruction::SWAP1POP ||
+            op == Instruction::POP2 ||
             op == Instruction::PUSHC ||
             op == Instruction::JUMPC ||
             op == Instruction::JUMPCI
         )
         {
             TRACE_OP(1, pc, op);
-            m_code[pc] = (byte)Instruction::UNDEFINED;
+            code[pc] = (byte)Instruction::UNDEFINED;
         }
 
         if (op == Instruction::JUMPDEST)
         {
-            m_jumpDests.push_back(pc);
+            jumpDests.push_back(pc);
         }
         else if (
             (byte)Instruction::PUSH1 <= (byte)op &&
@@ -76,6 +156,80 @@ void VM::optimize()
             pc += (byte)op - (byte)Instruction::PUSH1 + 1;
         }
     }
+
+#if EVM_BLOCK_METERING
+
+    // Split the code into basic blocks and sum up the static gas and stack checks of each. A
+    // block ends after an instruction for which endsBlock() holds or that is undefined in this
+    // revision, and before every JUMPDEST. Works on the original instructions, whose metrics add
+    // up to those of the synthetic ones replacing them below.
+    TRACE_STR(1, "Build basic block table")
+    auto const& metrics = s_metrics[_rev];
+    std::vector<CodeAnalysis::Block>& blocks = analysis->blocks;
+    analysis->blockAt.resize(nBytes + 1);
+    size_t blockStart = 0;
+    int height = 0;
+    auto const startBlock = [&](size_t _pc) {
+        blockStart = _pc;
+        height = 0;
+        analysis->blockAt[_pc] = blocks.size();
+        blocks.emplace_back();
+    };
+    startBlock(0);
+    for (size_t pc = 0; pc < nBytes; ++pc)
+    {
+        Instruction const op = Instruction(code[pc]);
+        if (op == Instruction::JUMPDEST && pc != blockStart)
+            startBlock(pc);
+
+        auto const& metric = metrics[size_t(op)];
+        CodeAnalysis::Block& block = blocks.back();
+        block.stackRequired =
+            std::max<int32_t>(block.stackRequired, metric.stack_height_required - height);
+        height += metric.stack_height_change;
+        block.stackMaxGrowth = std::max<int32_t>(block.stackMaxGrowth, height);
+        if (metric.gas_cost > 0 && !isSelfMetered(op))
+            block.gas += metric.gas_cost;
+
+        if ((byte)Instruction::PUSH1 <= (byte)op && (byte)op <= (byte)Instruction::PUSH32)
+            pc += (byte)op - (byte)Instruction::PUSH1 + 1;
+
+        if ((metric.gas_cost < 0 || endsBlock(op)) && pc + 1 <= nBytes)
+            startBlock(pc + 1);
+    }
+
+#else
+    (void)_rev;
+#endif
+
+#if EVM_FUSE_INSTRUCTIONS
+
+    TRACE_STR(1, "Fuse instruction pairs")
+    for (size_t pc = 0; pc + 1 < nBytes; ++pc)
+    {
+        Instruction op = Instruction(code[pc]);
+        Instruction const next = Instruction(code[pc + 1]);
+        if (op == Instruction::SWAP1 && next == Instruction::POP)
+        {
+            TRACE_PRE_OPT(1, pc, op);
+            code[pc] = byte(op = Instruction::SWAP1POP);
+            TRACE_POST_OPT(1, pc, op);
+            ++pc;
+        }
+        else if (op == Instruction::POP && next == Instruction::POP)
+        {
+            TRACE_PRE_OPT(1, pc, op);
+            code[pc] = byte(op = Instruction::POP2);
+            TRACE_POST_OPT(1, pc, op);
+            ++pc;
+        }
+        else if ((byte)Instruction::PUSH1 <= (byte)op && (byte)op <= (byte)Instruction::PUSH32)
+        {
+            pc += (byte)op - (byte)Instruction::PUSH1 + 1;
+        }
+    }
+
+#endif
     
 #ifdef EVM_DO_FIRST_PASS_OPTIMIZATION
     
@@ -83,16 +237,16 @@ void VM::optimize()
     for (size_t pc = 0; pc < nBytes; ++pc)
     {
         intx::uint256 val = 0;
-        Instruction op = Instruction(m_code[pc]);
+        Instruction op = Instruction(code[pc]);
 
         if ((byte)Instruction::PUSH1 <= (byte)op && (byte)op <= (byte)Instruction::PUSH32)
         {
             byte nPush = (byte)op - (byte)Instruction::PUSH1 + 1;
 
             // decode pushed bytes to integral value
-            val = m_code[pc+1];
+            val = code[pc+1];
             for (uint64_t i = pc+2, n = nPush; --n; ++i) {
-                val = (val << 8) | m_code[i];
+                val = (val << 8) | code[i];
             }
 
         #if EVM_USE_CONSTANT_POOL
@@ -102,16 +256,16 @@ void VM::optimize()
             // followed by one byte count of remaining pushed bytes
             if (5 < nPush)
             {
-                uint16_t pool_off = m_pool.size();
+                uint16_t pool_off = analysis->pool.size();
                 TRACE_VAL(1, "stash", val);
                 TRACE_VAL(1, "... in pool at offset" , pool_off);
-                m_pool.push_back(val);
+                analysis->pool.push_back(val);
 
                 TRACE_PRE_OPT(1, pc, op);
-                m_code[pc] = byte(op = Instruction::PUSHC);
-                m_code[pc+3] = nPush - 2;
-                m_code[pc+2] = pool_off & 0xff;
-                m_code[pc+1] = pool_off >> 8;
+                code[pc] = byte(op = Instruction::PUSHC);
+                code[pc+3] = nPush - 2;
+                code[pc+2] = pool_off & 0xff;
+                code[pc+1] = pool_off >> 8;
                 TRACE_POST_OPT(1, pc, op);
             }
 
@@ -123,14 +277,14 @@ void VM::optimize()
             // outer loop is N = number of bytes in code array
             // so complexity is N log M, worst case is N log N
             size_t i = pc + nPush + 1;
-            op = Instruction(m_code[i]);
+            op = Instruction(code[i]);
             if (op == Instruction::JUMP)
             {
                 TRACE_VAL(1, "Replace const JUMP with JUMPC to", val)
                 TRACE_PRE_OPT(1, i, op);
                 
-                if (0 <= verifyJumpDest(val, false))
-                    m_code[i] = byte(op = Instruction::JUMPC);
+                if (0 <= findJumpDest(jumpDests, val))
+                    code[i] = byte(op = Instruction::JUMPC);
                 
                 TRACE_POST_OPT(1, i, op);
             }
@@ -139,8 +293,8 @@ void VM::optimize()
                 TRACE_VAL(1, "Replace const JUMPI with JUMPCI to", val)
                 TRACE_PRE_OPT(1, i, op);
                 
-                if (0 <= verifyJumpDest(val, false))
-                    m_code[i] = byte(op = Instruction::JUMPCI);
+                if (0 <= findJumpDest(jumpDests, val))
+                    code[i] = byte(op = Instruction::JUMPCI);
                 
                 TRACE_POST_OPT(1, i, op);
             }
@@ -151,6 +305,8 @@ void VM::optimize()
     }
     TRACE_STR(1, "Finished optimizations")
 #endif    
+
+    return analysis;
 }
 
 
@@ -160,7 +316,29 @@ void VM::optimize()
 void VM::initEntry()
 {
     m_bounce = &VM::interpretCases;
-    optimize();
+
+    // Init code rarely runs twice, so only the code of accounts goes through the cache. The key is
+    // hashed from the code itself, as nothing the host passes along is guaranteed to match it.
+    bool const cacheable = m_message->kind != EVMC_CREATE && m_message->kind != EVMC_CREATE2;
+    h256 codeHash;
+    if (cacheable)
+    {
+        auto const hash = ethash::keccak256(m_pCode, m_codeSize);
+        codeHash = h256(hash.bytes, h256::ConstructFromPointer);
+        m_analysis = CodeAnalysisCache::instance().find(codeHash, m_rev);
+    }
+    if (!m_analysis)
+    {
+        m_analysis = analyse(m_pCode, m_codeSize, m_rev);
+        if (cacheable)
+            CodeAnalysisCache::instance().insert(codeHash, m_rev, m_analysis);
+    }
+    m_code = m_analysis->code.data();
+    m_pool = m_analysis->pool.data();
+
+#if EVM_BLOCK_METERING
+    fallIntoBlock();
+#endif
 }
 }
 }
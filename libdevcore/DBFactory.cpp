@@ -20,6 +20,9 @@ namespace po = boost::program_options;
 
 auto g_kind = DatabaseKind::LevelDB;
 fs::path g_dbPath;
+size_t g_stateCacheSize = 64 * 1024 * 1024;
+size_t g_chainCacheSize = 64 * 1024 * 1024;
+bool g_logIndex = false;
 
 /// A helper type to build the table of DB implementations.
 ///
@@ -68,6 +71,46 @@ void setDatabasePath(std::string const& _path)
     g_dbPath = fs::path(_path);
 }
 
+void setStateCacheSizeMB(unsigned _mb)
+{
+    g_stateCacheSize = size_t(_mb) * 1024 * 1024;
+}
+
+size_t stateCacheSize()
+{
+    return g_stateCacheSize;
+}
+
+void setStateCacheSize(size_t _bytes)
+{
+    g_stateCacheSize = _bytes;
+}
+
+void setChainCacheSizeMB(unsigned _mb)
+{
+    g_chainCacheSize = size_t(_mb) * 1024 * 1024;
+}
+
+size_t chainCacheSize()
+{
+    return g_chainCacheSize;
+}
+
+void setChainCacheSize(size_t _bytes)
+{
+    g_chainCacheSize = _bytes;
+}
+
+bool logIndexEnabled()
+{
+    return g_logIndex;
+}
+
+void setLogIndexEnabled(bool _enabled)
+{
+    g_logIndex = _enabled;
+}
+
 bool isDiskDatabase()
 {
     switch (g_kind)
@@ -120,6 +163,25 @@ po::options_description databaseProgramOptions(unsigned _lineLength)
             ->notifier(setDatabasePath),
         "Database path (for non-memory database options)\n");
 
+    add("state-cache-mb",
+        po::value<unsigned>()
+            ->value_name("<size>")
+            ->default_value(unsigned(g_stateCacheSize / (1024 * 1024)))
+            ->notifier(setStateCacheSizeMB),
+        "Size in MB of the cache of state trie nodes read from the database (0 disables it)\n");
+
+    add("chain-cache-mb",
+        po::value<unsigned>()
+            ->value_name("<size>")
+            ->default_value(unsigned(g_chainCacheSize / (1024 * 1024)))
+            ->notifier(setChainCacheSizeMB),
+        "Size in MB of the cache of blocks, receipts and other chain data read from the "
+        "database (0 disables it)\n");
+
+    add("log-index", po::bool_switch()->notifier(setLogIndexEnabled),
+        "Index logs by address and first topic as blocks are imported. Run --backfill-log-index "
+        "once to cover blocks imported before\n");
+
     return opts;
 }
 
@@ -33,6 +33,15 @@ DatabaseKind databaseKind();
 void setDatabaseKindByName(std::string const& _name);
 void setDatabaseKind(DatabaseKind _kind);
 boost::filesystem::path databasePath();
+/// Size in bytes of the cache of state trie nodes read from the database.
+size_t stateCacheSize();
+void setStateCacheSize(size_t _bytes);
+/// Size in bytes of the cache of blocks and their extras read from the blockchain databases.
+size_t chainCacheSize();
+void setChainCacheSize(size_t _bytes);
+/// Whether the blockchain keeps an index of logs by address and first topic.
+bool logIndexEnabled();
+void setLogIndexEnabled(bool _enabled);
 
 class DBFactory
 {
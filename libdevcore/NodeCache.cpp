@@ -0,0 +1,28 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "NodeCache.h"
+
+using namespace std;
+using namespace dev;
+
+namespace
+{
+/// Rough cost of the list node, the index entry and the key next to the value itself.
+constexpr size_t c_entryOverhead = 96;
+}  // namespace
+
+string NodeCache::lookup(h256 const& _h) const
+{
+    string ret;
+    m_cache.lookup(_h, ret);
+    return ret;
+}
+
+void NodeCache::insert(h256 const& _h, string const& _value)
+{
+    // An existing node never changes, so it is kept rather than copied again.
+    if (!_value.empty())
+        m_cache.insert(_h, _value, _value.size() + c_entryOverhead, false);
+}
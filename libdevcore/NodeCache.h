@@ -0,0 +1,37 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#pragma once
+
+#include "FixedHash.h"
+#include "ShardedLruCache.h"
+
+#include <string>
+
+namespace dev
+{
+/// Thread-safe cache of trie nodes that are already in the database, bounded by the total
+/// size of the cached values. Nodes are content-addressed, so a cached value never goes stale.
+class NodeCache
+{
+public:
+    using Stats = ShardedLruCache<h256, std::string, h256::hash>::Stats;
+
+    explicit NodeCache(size_t _capacityBytes) : m_cache(_capacityBytes) {}
+
+    /// @returns the cached value of @a _h or an empty string, counting a hit or a miss.
+    std::string lookup(h256 const& _h) const;
+    /// Same as lookup(), but neither moves the entry nor counts it.
+    bool contains(h256 const& _h) const { return m_cache.contains(_h); }
+    void insert(h256 const& _h, std::string const& _value);
+    void clear() { m_cache.clear(); }
+
+    size_t capacity() const noexcept { return m_cache.capacity(); }
+    Stats stats() const { return m_cache.stats(); }
+
+private:
+    ShardedLruCache<h256, std::string, h256::hash> m_cache;
+};
+
+}  // namespace dev
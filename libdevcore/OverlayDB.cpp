@@ -44,7 +44,12 @@ void OverlayDB::commit()
             for (auto const& i: m_main)
             {
                 if (i.second.second)
+                {
                     writeBatch->insert(toSlice(i.first), toSlice(i.second.first));
+                    // Freshly written nodes are the likeliest to be read by the next block.
+                    if (m_cache)
+                        m_cache->insert(i.first, i.second.first);
+                }
 //              cnote << i.first << "#" << m_main[i.first].second;
             }
             for (auto const& i: m_aux)
@@ -114,13 +119,25 @@ std::string OverlayDB::lookup(h256 const& _h) const
     if (!ret.empty() || !m_db)
         return ret;
 
-    return m_db->lookup(toSlice(_h));
+    if (m_cache)
+    {
+        ret = m_cache->lookup(_h);
+        if (!ret.empty())
+            return ret;
+    }
+
+    ret = m_db->lookup(toSlice(_h));
+    if (m_cache)
+        m_cache->insert(_h, ret);
+    return ret;
 }
 
 bool OverlayDB::exists(h256 const& _h) const
 {
     if (StateCacheDB::exists(_h))
         return true;
+    if (m_cache && m_cache->contains(_h))
+        return true;
     return m_db && m_db->exists(toSlice(_h));
 }
 
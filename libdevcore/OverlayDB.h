@@ -8,6 +8,7 @@
 #include <libdevcore/db.h>
 #include <libdevcore/Common.h>
 #include <libdevcore/Log.h>
+#include <libdevcore/NodeCache.h>
 #include <libdevcore/StateCacheDB.h>
 
 namespace dev
@@ -16,11 +17,14 @@ namespace dev
 class OverlayDB: public StateCacheDB
 {
 public:
-    explicit OverlayDB(std::unique_ptr<db::DatabaseFace> _db = nullptr)
+    /// @param _cacheBytes size of the cache of nodes read from or committed to @a _db, shared
+    /// by all copies of this object; 0 disables it.
+    explicit OverlayDB(std::unique_ptr<db::DatabaseFace> _db = nullptr, size_t _cacheBytes = 0)
       : m_db(_db.release(), [](db::DatabaseFace* db) {
             clog(VerbosityDebug, "overlaydb") << "Closing state DB";
             delete db;
-        })
+        }),
+        m_cache(m_db && _cacheBytes ? std::make_shared<NodeCache>(_cacheBytes) : nullptr)
     {}
 
     ~OverlayDB();
@@ -41,10 +45,14 @@ public:
 
 	bytes lookupAux(h256 const& _h) const;
 
+    /// Statistics of the node cache; all zero if it is disabled.
+    NodeCache::Stats cacheStats() const { return m_cache ? m_cache->stats() : NodeCache::Stats(); }
+
 private:
 	using StateCacheDB::clear;
 
     std::shared_ptr<db::DatabaseFace> m_db;
+    std::shared_ptr<NodeCache> m_cache;
 };
 
 }
@@ -0,0 +1,227 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace dev
+{
+/// Puts every key of a ShardedLruCache into the same group.
+template <class Key>
+struct SingleCacheGroup
+{
+    static constexpr unsigned size = 1;
+    unsigned operator()(Key const&) const { return 0; }
+};
+
+/// Thread-safe LRU cache bounded by the total size of its entries rather than their number.
+/// Keys are spread over shards with an LRU list and a lock each, and every shard gets an equal
+/// part of the budget. The size of an entry is given on insertion.
+/// Keys may be put into groups by @a Group, a functor returning a group below Group::size. The
+/// groups share the budget, but entries, bytes, hits and misses are counted for each of them.
+template <class Key, class Value, class Hash = std::hash<Key>, class Group = SingleCacheGroup<Key>>
+class ShardedLruCache
+{
+public:
+    static constexpr unsigned c_groups = Group::size;
+
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+
+        double hitRate() const { return hits + misses ? double(hits) / (hits + misses) : 0; }
+    };
+
+    explicit ShardedLruCache(size_t _capacityBytes) : m_capacity(_capacityBytes) {}
+
+    ShardedLruCache(ShardedLruCache const&) = delete;
+    ShardedLruCache& operator=(ShardedLruCache const&) = delete;
+
+    /// Copies the entry for @a _key into @a o_value and makes it the most recently used one,
+    /// counting a hit or a miss. @returns false if it isn't cached.
+    bool lookup(Key const& _key, Value& o_value) const
+    {
+        unsigned const group = Group()(_key);
+        assert(group < c_groups);
+        Shard const& s = shard(_key);
+        {
+            std::lock_guard<std::mutex> l(s.x_shard);
+            auto const it = s.index.find(_key);
+            if (it != s.index.end())
+            {
+                s.lru.splice(s.lru.begin(), s.lru, it->second);
+                ++m_hits[group];
+                o_value = it->second->value;
+                return true;
+            }
+        }
+        ++m_misses[group];
+        return false;
+    }
+
+    /// Same as lookup(), but neither moves the entry nor counts it.
+    bool contains(Key const& _key) const
+    {
+        Shard const& s = shard(_key);
+        std::lock_guard<std::mutex> l(s.x_shard);
+        return s.index.count(_key);
+    }
+
+    /// Adds the entry for @a _key, evicting the least recently used ones of its shard as needed.
+    /// @a _bytes is the size counted against the budget; entries bigger than a shard's part are
+    /// not cached. An entry already cached is replaced if @a _replace is true, otherwise it is
+    /// kept and only made the most recently used one.
+    void insert(Key const& _key, Value _value, size_t _bytes, bool _replace = true)
+    {
+        unsigned const group = Group()(_key);
+        assert(group < c_groups);
+        size_t const capacity = m_capacity / c_shards;
+        Shard& s = shard(_key);
+        std::lock_guard<std::mutex> l(s.x_shard);
+
+        auto const it = s.index.find(_key);
+        if (it != s.index.end())
+        {
+            if (!_replace)
+            {
+                s.lru.splice(s.lru.begin(), s.lru, it->second);
+                return;
+            }
+            remove(s, it->second);
+        }
+        if (_bytes > capacity)
+            return;
+
+        while (s.totalBytes + _bytes > capacity)
+            remove(s, std::prev(s.lru.end()));
+
+        s.lru.push_front(Entry{_key, std::move(_value), _bytes, group});
+        s.index[_key] = s.lru.begin();
+        ++s.entries[group];
+        s.bytes[group] += _bytes;
+        s.totalBytes += _bytes;
+    }
+
+    void erase(Key const& _key)
+    {
+        Shard& s = shard(_key);
+        std::lock_guard<std::mutex> l(s.x_shard);
+        auto const it = s.index.find(_key);
+        if (it != s.index.end())
+            remove(s, it->second);
+    }
+
+    /// Drops every entry of @a _group.
+    void clear(unsigned _group)
+    {
+        for (auto& s : m_shards)
+        {
+            std::lock_guard<std::mutex> l(s.x_shard);
+            for (auto it = s.lru.begin(); it != s.lru.end();)
+                if (it->group == _group)
+                    remove(s, it++);
+                else
+                    ++it;
+        }
+    }
+
+    void clear()
+    {
+        for (auto& s : m_shards)
+        {
+            std::lock_guard<std::mutex> l(s.x_shard);
+            s.index.clear();
+            s.lru.clear();
+            s.entries = {};
+            s.bytes = {};
+            s.totalBytes = 0;
+        }
+    }
+
+    /// Changes the budget; shards over it shrink on their next insertion.
+    void setCapacity(size_t _capacityBytes) noexcept { m_capacity = _capacityBytes; }
+    size_t capacity() const noexcept { return m_capacity; }
+
+    Stats stats(unsigned _group) const
+    {
+        assert(_group < c_groups);
+        Stats ret;
+        ret.hits = m_hits[_group];
+        ret.misses = m_misses[_group];
+        for (auto const& s : m_shards)
+        {
+            std::lock_guard<std::mutex> l(s.x_shard);
+            ret.entries += s.entries[_group];
+            ret.bytes += s.bytes[_group];
+        }
+        return ret;
+    }
+
+    Stats stats() const
+    {
+        Stats ret;
+        for (unsigned group = 0; group < c_groups; ++group)
+        {
+            Stats const s = stats(group);
+            ret.hits += s.hits;
+            ret.misses += s.misses;
+            ret.entries += s.entries;
+            ret.bytes += s.bytes;
+        }
+        return ret;
+    }
+
+private:
+    struct Entry
+    {
+        Key key;
+        Value value;
+        size_t bytes;
+        unsigned group;
+    };
+
+    using List = std::list<Entry>;
+
+    struct Shard
+    {
+        mutable std::mutex x_shard;
+        mutable List lru;
+        std::unordered_map<Key, typename List::iterator, Hash> index;
+        std::array<size_t, c_groups> entries = {};
+        std::array<size_t, c_groups> bytes = {};
+        size_t totalBytes = 0;
+    };
+
+    static constexpr unsigned c_shards = 16;
+
+    /// Unlinks @a _it from @a _s; the shard lock must be held.
+    static void remove(Shard& _s, typename List::iterator _it)
+    {
+        --_s.entries[_it->group];
+        _s.bytes[_it->group] -= _it->bytes;
+        _s.totalBytes -= _it->bytes;
+        _s.index.erase(_it->key);
+        _s.lru.erase(_it);
+    }
+
+    Shard& shard(Key const& _key) { return m_shards[Hash()(_key) % c_shards]; }
+    Shard const& shard(Key const& _key) const { return m_shards[Hash()(_key) % c_shards]; }
+
+    std::atomic<size_t> m_capacity;
+    std::array<Shard, c_shards> m_shards;
+    mutable std::array<std::atomic<uint64_t>, c_groups> m_hits = {};
+    mutable std::array<std::atomic<uint64_t>, c_groups> m_misses = {};
+};
+
+}  // namespace dev
@@ -0,0 +1,88 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "ThreadPool.h"
+#include "Guards.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <thread>
+
+using namespace std;
+using namespace dev;
+
+namespace
+{
+struct ParallelForState
+{
+    ParallelForState(size_t _count, function<bool(size_t)> const& _f) : count(_count), f(_f) {}
+
+    /// Runs items until there are none left or the loop was stopped.
+    void run()
+    {
+        while (true)
+        {
+            size_t i;
+            {
+                Guard l(x_state);
+                if (stopped || next >= count)
+                    return;
+                i = next++;
+                ++running;
+            }
+
+            bool const proceed = f(i);
+
+            Guard l(x_state);
+            --running;
+            if (!proceed)
+                stopped = true;
+            if (!running)
+                done.notify_all();
+        }
+    }
+
+    size_t const count;
+    function<bool(size_t)> const& f;
+
+    Mutex x_state;
+    condition_variable done;
+    size_t next = 0;
+    size_t running = 0;
+    bool stopped = false;
+};
+}  // namespace
+
+ThreadPool::ThreadPool(unsigned _threads) : m_size(max(_threads, 1u)), m_pool(m_size) {}
+
+ThreadPool::~ThreadPool()
+{
+    m_pool.join();
+}
+
+ThreadPool& ThreadPool::shared()
+{
+    static ThreadPool s_pool(thread::hardware_concurrency());
+    return s_pool;
+}
+
+void ThreadPool::parallelFor(size_t _count, function<bool(size_t)> const& _f, unsigned _parallelism)
+{
+    if (!_count)
+        return;
+
+    size_t const threads = min<size_t>(_count, _parallelism ? _parallelism : m_size + 1);
+    auto state = make_shared<ParallelForState>(_count, _f);
+    // Helpers that only get scheduled after the loop has finished find it stopped and never
+    // touch _f, which is only valid until this function returns.
+    for (size_t i = 1; i < threads; ++i)
+        post([state]() { state->run(); });
+
+    state->run();
+
+    UniqueGuard l(state->x_state);
+    state->stopped = true;
+    state->done.wait(l, [&]() { return state->running == 0; });
+}
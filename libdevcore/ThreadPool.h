@@ -0,0 +1,46 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#pragma once
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <functional>
+#include <utility>
+
+namespace dev
+{
+/// Fixed-size pool of threads for CPU-bound work split into independent items.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned _threads);
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    /// Pool shared by the whole process, sized to the number of hardware threads.
+    static ThreadPool& shared();
+
+    unsigned size() const noexcept { return m_size; }
+
+    template <class F>
+    void post(F&& _f)
+    {
+        boost::asio::post(m_pool, std::forward<F>(_f));
+    }
+
+    /// Calls @a _f for every index in [0, _count) on up to @a _parallelism threads, the
+    /// calling thread included, and returns once all started calls have finished.
+    /// Stops handing out further indices as soon as @a _f returns false.
+    /// Safe to call from a pool thread: the caller keeps consuming items itself.
+    void parallelFor(size_t _count, std::function<bool(size_t)> const& _f, unsigned _parallelism = 0);
+
+private:
+    unsigned m_size;
+    boost::asio::thread_pool m_pool;
+};
+
+}  // namespace dev
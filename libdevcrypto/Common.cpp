@@ -16,6 +16,7 @@
 #include <libscrypt.h>
 #include <libdevcore/SHA3.h>
 #include <libdevcore/RLP.h>
+#include <libdevcore/ThreadPool.h>
 #include "AES.h"
 #include "CryptoPP.h"
 #include "Exceptions.h"
@@ -295,6 +296,32 @@ bool dev::verify(PublicCompressed const& _key, h512 const& _signature, h256 cons
     return secp256k1_ecdsa_verify(ctx, &rawSig, _hash.data(), &rawPubkey);
 }
 
+size_t dev::verifyBatch(vector<pair<Public, Signature>> const& _sigs, h256 const& _hash, size_t _quorum)
+{
+    // Signatures are grouped by key; a key counts once, as soon as any of its signatures holds.
+    map<Public, vector<Signature>> bySigner;
+    for (auto const& sig : _sigs)
+    {
+        auto& sigs = bySigner[sig.first];
+        if (find(sigs.begin(), sigs.end(), sig.second) == sigs.end())
+            sigs.push_back(sig.second);
+    }
+    vector<pair<Public const, vector<Signature>> const*> signers;
+    for (auto const& signer : bySigner)
+        signers.push_back(&signer);
+
+    atomic<size_t> valid{0};
+    ThreadPool::shared().parallelFor(signers.size(), [&](size_t _i) {
+        Public const& key = signers[_i]->first;
+        auto const& sigs = signers[_i]->second;
+        if (none_of(sigs.begin(), sigs.end(), [&](Signature const& _s) { return verify(key, _s, _hash); }))
+            return true;
+        size_t const found = ++valid;
+        return !_quorum || found < _quorum;
+    });
+    return _quorum ? min(valid.load(), _quorum) : valid.load();
+}
+
 bytesSec dev::pbkdf2(string const& _pass, bytes const& _salt, unsigned _iterations, unsigned _dkLen)
 {
     bytesSec ret(_dkLen);
@@ -122,6 +122,13 @@ bool verify(Public const& _k, Signature const& _s, h256 const& _hash);
 // Verify signature with compressed public key
 bool verify(PublicCompressed const& _key, h512 const& _signature, h256 const& _hash);
 
+/// Verifies a batch of (public key, signature) pairs over the same message hash, spread
+/// across the shared thread pool. A key may appear several times; it is counted once if any
+/// of its signatures is valid.
+/// @param _quorum stop as soon as this many keys have been found to sign; 0 checks all.
+/// @returns the number of distinct keys with a valid signature, at most _quorum if it is non-zero.
+size_t verifyBatch(std::vector<std::pair<Public, Signature>> const& _sigs, h256 const& _hash, size_t _quorum = 0);
+
 /// Derive key via PBKDF2.
 bytesSec pbkdf2(std::string const& _pass, bytes const& _salt, unsigned _iterations, unsigned _dkLen = 32);
 
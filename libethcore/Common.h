@@ -243,7 +243,8 @@ enum AlethErrors
     BadRlp,
     RlpDataNotAList,
     UnsupportedJsonType,
-    InvalidJson
+    InvalidJson,
+    SnapshotExportFailure
 };
 }
 }
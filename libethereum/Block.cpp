@@ -119,6 +119,14 @@ void Block::resetCurrent(int64_t _timestamp)
     updateBlockhashContract();
 }
 
+void Block::startChild(int64_t _timestamp)
+{
+    h256Hash parentTransactions = move(m_transactionSet);
+    m_previousBlock = m_currentBlock;
+    resetCurrent(_timestamp);
+    m_transactionSet = move(parentTransactions);
+}
+
 SealEngineFace* Block::sealEngine() const
 {
     if (!m_sealEngine)
@@ -264,6 +272,12 @@ bool Block::sync(BlockChain const& _bc, h256 const& _block, BlockHeader const& _
 }
 
 pair<TransactionReceipts, bool> Block::sync(BlockChain const& _bc, TransactionQueue& _tq, GasPricer const& _gp, unsigned msTimeout)
+{
+    assert(_bc.currentHash() == m_currentBlock.parentHash());
+    return sync(_bc, _bc.lastBlockHashes(), _tq, _gp, msTimeout);
+}
+
+pair<TransactionReceipts, bool> Block::sync(BlockChain const& _bc, LastBlockHashesFace const& _lh, TransactionQueue& _tq, GasPricer const& _gp, unsigned msTimeout)
 {
     if (isSealed())
         BOOST_THROW_EXCEPTION(InvalidOperationOnSealedBlock());
@@ -277,7 +291,6 @@ pair<TransactionReceipts, bool> Block::sync(BlockChain const& _bc, TransactionQu
     ret.second = (transactions.size() == c_maxSyncTransactions);  // say there's more to the caller
                                                                   // if we hit the limit
 
-    assert(_bc.currentHash() == m_currentBlock.parentHash());
     auto deadline =  chrono::steady_clock::now() + chrono::milliseconds(msTimeout);
 
     for (int goodTxs = max(0, (int)transactions.size() - 1); goodTxs < (int)transactions.size();)
@@ -291,7 +304,7 @@ pair<TransactionReceipts, bool> Block::sync(BlockChain const& _bc, TransactionQu
                     if (t.gasPrice() >= _gp.ask(*this))
                     {
 //						Timer t;
-                        execute(_bc.lastBlockHashes(), t);
+                        execute(_lh, t);
                         ret.first.push_back(m_receipts.back());
                         ++goodTxs;
 //						cnote << "TX took:" << t.elapsed() * 1000;
@@ -467,6 +480,8 @@ u256 Block::enact(VerifiedBlockRef const& _block, BlockChain const& _bc)
             m_receipts.back().streamRLP(receiptRLP);
             receipts.push_back(receiptRLP.out());
             ++i;
+            if (i < _block.transactions.size())
+                _bc.stateCheckpoints().record(_block.info.hash(), i, m_state);
         }
 
     h256 receiptsRoot;
@@ -704,7 +719,8 @@ void Block::commitToSeal(BlockChain const& _bc, bytes const& _extraData)
 
     RLPStream unclesData;
     unsigned unclesCount = 0;
-    if (m_previousBlock.number() != 0)
+    // A parent that is not imported yet has no kin in the chain.
+    if (m_previousBlock.number() != 0 && _bc.isKnown(m_previousBlock.hash()))
     {
         // Find great-uncles (or second-cousins or whatever they are) - children of great-grandparents, great-great-grandparents... that were not already uncles in previous generations.
         LOG(m_loggerDetailed) << "Checking " << m_previousBlock.hash()
@@ -200,6 +200,10 @@ public:
     /// @returns a list of receipts one for each transaction placed from the queue into the state and bool, true iff there are more transactions to be processed.
     std::pair<TransactionReceipts, bool> sync(BlockChain const& _bc, TransactionQueue& _tq, GasPricer const& _gp, unsigned _msTimeout = 100);
 
+    /// Same as above, but for a block whose parent need not be the head of @a _bc; @a _lh
+    /// provides the hashes preceding the block.
+    std::pair<TransactionReceipts, bool> sync(BlockChain const& _bc, LastBlockHashesFace const& _lh, TransactionQueue& _tq, GasPricer const& _gp, unsigned _msTimeout = 100);
+
     /// Sync our state with the block chain.
     /// This basically involves wiping ourselves if we've been superceded and rebuilding from the transaction queue.
     bool sync(BlockChain const& _bc);
@@ -218,6 +222,12 @@ public:
     /// optionally modifies the timestamp.
     void resetCurrent(int64_t _timestamp = utcTime());
 
+    /// Starts the child of the block this object was committed to seal for; the parent need not
+    /// be in the chain yet. The parent's post state becomes the child's pre state and the
+    /// parent's transactions stay in pendingHashes(), so they are not taken from the queue again.
+    /// Only valid on a copy taken after commitToSeal().
+    void startChild(int64_t _timestamp = utcTime());
+
     // Sealing
 
     /// Prepares the current state for mining.
@@ -32,6 +32,28 @@ namespace
 {
 std::string const c_chainStart{"chainStart"};
 db::Slice const c_sliceChainStart{c_chainStart};
+std::string const c_logIndexFrom{"logIndexFrom"};
+db::Slice const c_sliceLogIndexFrom{c_logIndexFrom};
+
+/// Number of consecutive blocks whose log index entries are counted under one key.
+unsigned const c_logIndexBucketSize = 4096;
+
+h256 logIndexKey(Address const& _address, h256 const& _topic0)
+{
+    return sha3(rlpList(_address, _topic0));
+}
+
+/// Holds the number of entries of a bucket.
+h256 logIndexBucketKey(h256 const& _key, unsigned _bucket)
+{
+    return sha3(rlpList(_key, _bucket));
+}
+
+/// Holds the number of one block of a bucket.
+h256 logIndexEntryKey(h256 const& _key, unsigned _bucket, unsigned _entry)
+{
+    return sha3(rlpList(_key, _bucket, _entry));
+}
 }
 
 std::ostream& dev::eth::operator<<(std::ostream& _out, BlockChain const& _bc)
@@ -139,20 +161,12 @@ void addBlockInfo(Exception& io_ex, BlockHeader const& _header, bytes&& _blockDa
 }
 
 
-/// Duration between flushes.
+/// Duration between reports of the cache statistics.
 static const chrono::system_clock::duration c_collectionDuration = chrono::seconds(60);
 
-/// Length of death row (total time in cache is multiple of this and collection duration).
-static const unsigned c_collectionQueueSize = 20;
-
-/// Max size, above which we start forcing cache reduction.
-static const unsigned c_maxCacheSize = 1024 * 1024 * 64;
-
-/// Min size, below which we don't bother flushing it.
-static const unsigned c_minCacheSize = 1024 * 1024 * 32;
-
 
 BlockChain::BlockChain(ChainParams const& _p, fs::path const& _dbPath, WithExisting _we, ProgressCallback const& _pc):
+    m_cache(db::chainCacheSize()),
     m_lastBlockHashes(new LastBlockHashes(*this)),
     m_dbPath(_dbPath)
 {
@@ -181,8 +195,6 @@ BlockHeader const& BlockChain::genesis() const
 
 void BlockChain::init(ChainParams const& _p)
 {
-    // initialise deathrow.
-    m_cacheUsage.resize(c_collectionQueueSize);
     m_lastCollection = chrono::system_clock::now();
 
     // Initialise with the genesis as the last block on the longest chain.
@@ -272,9 +284,10 @@ unsigned BlockChain::open(fs::path const& _path, WithExisting _we)
     {
         BlockHeader gb(m_params.genesisBlock());
         // Insert details of genesis block.
-        m_details[m_genesisHash] = BlockDetails(0, gb.difficulty(), h256(), {});
-        auto r = m_details[m_genesisHash].rlp();
+        BlockDetails const genesisDetails(0, gb.difficulty(), h256(), {});
+        auto r = genesisDetails.rlp();
         m_extrasDB->insert(toSlice(m_genesisHash, ExtraDetails), (db::Slice)dev::ref(r));
+        m_cache.insert(m_genesisHash, ExtraDetails, genesisDetails, r.size());
         assert(isKnown(gb.hash()));
     }
 
@@ -284,6 +297,22 @@ unsigned BlockChain::open(fs::path const& _path, WithExisting _we)
 
     m_lastBlockNumber = number(m_lastBlockHash);
 
+    auto const logIndexFrom = m_extrasDB->lookup(c_sliceLogIndexFrom);
+    if (!db::logIndexEnabled())
+    {
+        // Blocks imported from now on would be missing from the index.
+        if (!logIndexFrom.empty())
+            m_extrasDB->kill(c_sliceLogIndexFrom);
+        m_logIndexFrom = numeric_limits<unsigned>::max();
+    }
+    else if (logIndexFrom.empty())
+    {
+        m_logIndexFrom = m_lastBlockNumber + 1;
+        m_extrasDB->insert(c_sliceLogIndexFrom, (db::Slice)dev::ref(rlp(m_logIndexFrom.load())));
+    }
+    else
+        m_logIndexFrom = RLP(logIndexFrom).toInt<unsigned>();
+
     ctrace << "Opened blockchain DB. Latest: " << currentHash() << (lastMinor == c_minorProtocolVersion ? "(rebuild not needed)" : "*** REBUILD NEEDED ***");
     return lastMinor;
 }
@@ -312,15 +341,7 @@ void BlockChain::close()
         m_lastBlockHash = m_genesisHash;
         m_lastBlockNumber = 0;
     }
-    m_details.clear();
-    m_blocks.clear();
-    m_logBlooms.clear();
-    m_receipts.clear();
-    m_transactionAddresses.clear();
-    m_blockHashes.clear();
-    m_blocksBlooms.clear();
-    m_cacheUsage.clear();
-    m_inUse.clear();
+    m_cache.clear();
     m_lastBlockHashes->clear();
 }
 
@@ -354,20 +375,16 @@ void BlockChain::rebuild(fs::path const& _path, std::function<void(unsigned, uns
     Block s = genesisBlock(State::openDB(path.string(), m_genesisHash, WithExisting::Kill));
 
     // Clear all memos ready for replay.
-    m_details.clear();
-    m_logBlooms.clear();
-    m_receipts.clear();
-    m_transactionAddresses.clear();
-    m_blockHashes.clear();
-    m_blocksBlooms.clear();
+    m_cache.clear();
     m_lastBlockHashes->clear();
     m_lastBlockHash = genesisHash();
     m_lastBlockNumber = 0;
 
-    m_details[m_lastBlockHash].totalDifficulty = s.info().difficulty();
-
-    m_extrasDB->insert(toSlice(m_lastBlockHash, ExtraDetails),
-        (db::Slice)dev::ref(m_details[m_lastBlockHash].rlp()));
+    BlockDetails genesisDetails;
+    genesisDetails.totalDifficulty = s.info().difficulty();
+    auto const r = genesisDetails.rlp();
+    m_extrasDB->insert(toSlice(m_lastBlockHash, ExtraDetails), (db::Slice)dev::ref(r));
+    m_cache.insert(m_lastBlockHash, ExtraDetails, genesisDetails, r.size());
 
     h256 lastHash = m_lastBlockHash;
     Timer t;
@@ -380,8 +397,8 @@ void BlockChain::rebuild(fs::path const& _path, std::function<void(unsigned, uns
         }
         try
         {
-            bytes b = block(queryExtras<BlockHash, uint64_t, ExtraBlockHash>(
-                d, m_blockHashes, x_blockHashes, NullBlockHash, oldExtrasDB.get())
+            bytes b = block(queryExtras<BlockHash, ExtraBlockHash>(
+                h256(d), NullBlockHash, oldExtrasDB.get())
                                 .value);
 
             BlockHeader bi(&b);
@@ -595,22 +612,15 @@ void BlockChain::insert(VerifiedBlockRef _block, bytesConstRef _receipts, bool _
     for (auto i: RLP(_receipts))
         blb.blooms.push_back(TransactionReceipt(i.data()).bloom());
 
-    // ensure parent is cached for later addition.
-    // TODO: this is a bit horrible would be better refactored into an enveloping UpgradableGuard
-    // together with an "ensureCachedWithUpdatableLock(l)" method.
-    // This is safe in practice since the caches don't get flushed nearly often enough to be
-    // done here.
-    details(_block.info.parentHash());
-    DEV_WRITE_GUARDED(x_details)
-    {
-        if (!dev::contains(m_details[_block.info.parentHash()].children, _block.info.hash()))
-            m_details[_block.info.parentHash()].children.push_back(_block.info.hash());
-    }
+    BlockDetails parentDetails = details(_block.info.parentHash());
+    if (!dev::contains(parentDetails.children, _block.info.hash()))
+        parentDetails.children.push_back(_block.info.hash());
+    bytes const parentDetailsRLP = parentDetails.rlp();
+    m_cache.insert(_block.info.parentHash(), ExtraDetails, move(parentDetails), parentDetailsRLP.size());
 
     blocksWriteBatch->insert(toSlice(_block.info.hash()), db::Slice(_block.block));
-    DEV_READ_GUARDED(x_details)
     extrasWriteBatch->insert(toSlice(_block.info.parentHash(), ExtraDetails),
-        (db::Slice)dev::ref(m_details[_block.info.parentHash()].rlp()));
+        (db::Slice)dev::ref(parentDetailsRLP));
 
     BlockDetails bd((unsigned)pd.number + 1, pd.totalDifficulty + _block.info.difficulty(), _block.info.parentHash(), {});
     extrasWriteBatch->insert(
@@ -764,21 +774,16 @@ ImportRoute BlockChain::insertBlockAndExtras(VerifiedBlockRef const& _block, byt
 
     try
     {
-        // ensure parent is cached for later addition.
-        // TODO: this is a bit horrible would be better refactored into an enveloping UpgradableGuard
-        // together with an "ensureCachedWithUpdatableLock(l)" method.
-        // This is safe in practice since the caches don't get flushed nearly often enough to be
-        // done here.
-        details(_block.info.parentHash());
-        DEV_WRITE_GUARDED(x_details)
-            m_details[_block.info.parentHash()].children.push_back(_block.info.hash());
+        BlockDetails parentDetails = details(_block.info.parentHash());
+        parentDetails.children.push_back(_block.info.hash());
+        bytes const parentDetailsRLP = parentDetails.rlp();
+        m_cache.insert(_block.info.parentHash(), ExtraDetails, move(parentDetails), parentDetailsRLP.size());
 
         _performanceLogger.onStageFinished("collation");
 
         blocksWriteBatch->insert(toSlice(_block.info.hash()), db::Slice(_block.block));
-        DEV_READ_GUARDED(x_details)
         extrasWriteBatch->insert(toSlice(_block.info.parentHash(), ExtraDetails),
-            (db::Slice)dev::ref(m_details[_block.info.parentHash()].rlp()));
+            (db::Slice)dev::ref(parentDetailsRLP));
 
         BlockDetails const details((unsigned)_block.info.number(), _totalDifficulty, _block.info.parentHash(), {});
         extrasWriteBatch->insert(
@@ -812,15 +817,19 @@ ImportRoute BlockChain::insertBlockAndExtras(VerifiedBlockRef const& _block, byt
         // just tack it on afterwards.
         unsigned commonIndex;
         tie(route, common, commonIndex) = treeRoute(last, _block.info.parentHash());
+        LogIndexUpdates logIndexUpdates;
         route.push_back(_block.info.hash());
 
+        // Bloom chunks altered along the route, written once all blocks are collated.
+        BlocksBloomsHash alteredBlooms;
+
         // Most of the time these two will be equal - only when we're doing a chain revert will they not be
         if (common != last)
             DEV_READ_GUARDED(x_lastBlockHash)
-                clearCachesDuringChainReversion(number(common) + 1);
+                clearCachesDuringChainReversion(number(common) + 1, alteredBlooms);
 
         // Go through ret backwards (i.e. from new head to common) until hash != last.parent and
-        // update m_transactionAddresses, m_blockHashes
+        // update the transaction addresses and block hashes
         for (auto i = route.rbegin(); i != route.rend() && *i != common; ++i)
         {
             BlockHeader tbi;
@@ -830,22 +839,19 @@ ImportRoute BlockChain::insertBlockAndExtras(VerifiedBlockRef const& _block, byt
                 tbi = BlockHeader(block(*i));
 
             // Collate logs into blooms.
-            h256s alteredBlooms;
             {
                 LogBloom blockBloom = tbi.logBloom();
                 blockBloom.shiftBloom<3>(sha3(tbi.author().ref()));
 
-                // Pre-memoize everything we need before locking x_blocksBlooms
-                for (unsigned level = 0, index = (unsigned)tbi.number(); level < c_bloomIndexLevels; level++, index /= c_bloomIndexSize)
-                    blocksBlooms(chunkId(level, index / c_bloomIndexSize));
-
-                WriteGuard l(x_blocksBlooms);
                 for (unsigned level = 0, index = (unsigned)tbi.number(); level < c_bloomIndexLevels; level++, index /= c_bloomIndexSize)
                 {
                     unsigned i = index / c_bloomIndexSize;
                     unsigned o = index % c_bloomIndexSize;
-                    alteredBlooms.push_back(chunkId(level, i));
-                    m_blocksBlooms[alteredBlooms.back()].blooms[o] |= blockBloom;
+                    h256 const id = chunkId(level, i);
+                    auto it = alteredBlooms.find(id);
+                    if (it == alteredBlooms.end())
+                        it = alteredBlooms.emplace(id, blocksBlooms(id)).first;
+                    it->second.blooms[o] |= blockBloom;
                 }
             }
             // Collate transaction hashes and remember who they were.
@@ -861,14 +867,16 @@ ImportRoute BlockChain::insertBlockAndExtras(VerifiedBlockRef const& _block, byt
                         (db::Slice)dev::ref(ta.rlp()));
             }
 
-            // Update database with them.
-            ReadGuard l1(x_blocksBlooms);
-            for (auto const& h: alteredBlooms)
-                extrasWriteBatch->insert(
-                    toSlice(h, ExtraBlocksBlooms), (db::Slice)dev::ref(m_blocksBlooms[h].rlp()));
             extrasWriteBatch->insert(toSlice(h256(tbi.number()), ExtraBlockHash),
                 (db::Slice)dev::ref(BlockHash(tbi.hash()).rlp()));
+
+            if (tbi.number() >= m_logIndexFrom.load())
+                collectLogIndex((unsigned)tbi.number(),
+                    *i == _block.info.hash() ? BlockReceipts(RLP(_receipts)) : receipts(*i),
+                    logIndexUpdates);
         }
+        writeBlocksBlooms(alteredBlooms, *extrasWriteBatch);
+        writeLogIndex(logIndexUpdates, *extrasWriteBatch);
 
         // FINALLY! change our best hash.
         {
@@ -959,7 +967,7 @@ ImportRoute BlockChain::insertBlockAndExtras(VerifiedBlockRef const& _block, byt
     return ImportRoute{dead, fresh, _block.transactions};
 }
 
-void BlockChain::clearBlockBlooms(unsigned _begin, unsigned _end)
+void BlockChain::clearBlockBlooms(unsigned _begin, unsigned _end, BlocksBloomsHash& io_blooms)
 {
     //   ... c c c c c c c c c c C o o o o o o
     //   ...                               /=15        /=21
@@ -977,6 +985,13 @@ void BlockChain::clearBlockBlooms(unsigned _begin, unsigned _end)
 
     // algorithm doesn't have the best memoisation coherence, but eh well...
 
+    auto chunk = [&](h256 const& _id) -> BlocksBlooms& {
+        auto it = io_blooms.find(_id);
+        if (it == io_blooms.end())
+            it = io_blooms.emplace(_id, blocksBlooms(_id)).first;
+        return it->second;
+    };
+
     unsigned beginDirty = _begin;
     unsigned endDirty = _end;
     for (unsigned level = 0; level < c_bloomIndexLevels; level++, beginDirty /= c_bloomIndexSize, endDirty = (endDirty - 1) / c_bloomIndexSize + 1)
@@ -992,15 +1007,24 @@ void BlockChain::clearBlockBlooms(unsigned _begin, unsigned _end)
             {
                 // rebuild the bloom from the previous (lower) level (if there is one).
                 auto lowerChunkId = chunkId(level - 1, item);
-                for (auto const& bloom: blocksBlooms(lowerChunkId).blooms)
+                for (auto const& bloom: chunk(lowerChunkId).blooms)
                     acc |= bloom;
             }
-            blocksBlooms(id);   // make sure it has been memoized.
-            m_blocksBlooms[id].blooms[offset] = acc;
+            chunk(id).blooms[offset] = acc;
         }
     }
 }
 
+void BlockChain::writeBlocksBlooms(BlocksBloomsHash const& _blooms, db::WriteBatchFace& _batch) const
+{
+    for (auto const& b: _blooms)
+    {
+        bytes const r = b.second.rlp();
+        _batch.insert(toSlice(b.first, ExtraBlocksBlooms), (db::Slice)dev::ref(r));
+        m_cache.insert(b.first, ExtraBlocksBlooms, b.second, r.size());
+    }
+}
+
 void BlockChain::rescue(OverlayDB const& _db)
 {
     cout << "Rescuing database..." << endl;
@@ -1057,12 +1081,16 @@ void BlockChain::rewind(unsigned _newHead)
     {
         if (_newHead >= m_lastBlockNumber)
             return;
-        clearCachesDuringChainReversion(_newHead + 1);
+        BlocksBloomsHash clearedBlooms;
+        clearCachesDuringChainReversion(_newHead + 1, clearedBlooms);
         m_lastBlockHash = numberHash(_newHead);
         m_lastBlockNumber = _newHead;
         try
         {
-            m_extrasDB->insert(db::Slice("best"), db::Slice((char const*)&m_lastBlockHash, 32));
+            std::unique_ptr<db::WriteBatchFace> batch = m_extrasDB->createWriteBatch();
+            writeBlocksBlooms(clearedBlooms, *batch);
+            batch->insert(db::Slice("best"), db::Slice((char const*)&m_lastBlockHash, 32));
+            m_extrasDB->commit(std::move(batch));
         }
         catch (boost::exception const& ex)
         {
@@ -1129,117 +1157,43 @@ tuple<h256s, h256, unsigned> BlockChain::treeRoute(h256 const& _from, h256 const
     return make_tuple(ret, from, i);
 }
 
-void BlockChain::noteUsed(h256 const& _h, unsigned _extra) const
-{
-    auto id = CacheID(_h, _extra);
-    Guard l(x_cacheUsage);
-    m_cacheUsage[0].insert(id);
-    if (m_cacheUsage[1].count(id))
-        m_cacheUsage[1].erase(id);
-    else
-        m_inUse.insert(id);
-}
-
-template <class K, class T> static unsigned getHashSize(unordered_map<K, T> const& _map)
-{
-    unsigned ret = 0;
-    for (auto const& i: _map)
-        ret += i.second.size + 64;
-    return ret;
-}
-
 void BlockChain::updateStats() const
 {
-    m_lastStats.memBlocks = 0;
-    DEV_READ_GUARDED(x_blocks)
-        for (auto const& i: m_blocks)
-            m_lastStats.memBlocks += i.second.size() + 64;
-    DEV_READ_GUARDED(x_details)
-        m_lastStats.memDetails = getHashSize(m_details);
-    size_t logBloomsSize = 0;
-    size_t blocksBloomsSize = 0;
-    DEV_READ_GUARDED(x_logBlooms)
-        logBloomsSize = getHashSize(m_logBlooms);
-    DEV_READ_GUARDED(x_blocksBlooms)
-        blocksBloomsSize = getHashSize(m_blocksBlooms);
-    m_lastStats.memLogBlooms = logBloomsSize + blocksBloomsSize;
-    DEV_READ_GUARDED(x_receipts)
-        m_lastStats.memReceipts = getHashSize(m_receipts);
-    DEV_READ_GUARDED(x_blockHashes)
-        m_lastStats.memBlockHashes = getHashSize(m_blockHashes);
-    DEV_READ_GUARDED(x_transactionAddresses)
-        m_lastStats.memTransactionAddresses = getHashSize(m_transactionAddresses);
+    m_lastStats.memBlocks = m_cache.stats(c_blockCacheKind).bytes;
+    m_lastStats.memDetails = m_cache.stats(ExtraDetails).bytes;
+    m_lastStats.memLogBlooms = m_cache.stats(ExtraLogBlooms).bytes + m_cache.stats(ExtraBlocksBlooms).bytes;
+    m_lastStats.memReceipts = m_cache.stats(ExtraReceipts).bytes;
+    m_lastStats.memBlockHashes = m_cache.stats(ExtraBlockHash).bytes;
+    m_lastStats.memTransactionAddresses = m_cache.stats(ExtraTransactionAddress).bytes;
 }
 
 void BlockChain::garbageCollect(bool _force)
 {
+    if (_force)
+        m_cache.clear();
     updateStats();
 
-    if (!_force && chrono::system_clock::now() < m_lastCollection + c_collectionDuration && m_lastStats.memTotal() < c_maxCacheSize)
+    if (chrono::system_clock::now() < m_lastCollection + c_collectionDuration)
         return;
-    if (m_lastStats.memTotal() < c_minCacheSize)
-        return;
-
     m_lastCollection = chrono::system_clock::now();
 
-    Guard l(x_cacheUsage);
-    for (CacheID const& id: m_cacheUsage.back())
+    static char const* const c_kindNames[] = {"details", "blockHashes", "transactionAddresses",
+        "logBlooms", "receipts", "blocksBlooms", "logIndex", "blocks"};
+    ChainCache::Stats const total = m_cache.stats();
+    LOG(m_logger) << "Chain cache: " << total.bytes / 1024 << " of " << m_cache.capacity() / 1024
+                  << " KiB, hit rate " << total.hitRate();
+    for (unsigned kind = 0; kind <= c_blockCacheKind; ++kind)
     {
-        m_inUse.erase(id);
-        // kill i from cache.
-        switch (id.second)
-        {
-        case (unsigned)-1:
-        {
-            WriteGuard l(x_blocks);
-            m_blocks.erase(id.first);
-            break;
-        }
-        case ExtraDetails:
-        {
-            WriteGuard l(x_details);
-            m_details.erase(id.first);
-            break;
-        }
-        case ExtraBlockHash:
-        {
-            // m_cacheUsage should not contain ExtraBlockHash elements currently.  See the second noteUsed() in BlockChain.h, which is a no-op.
-            assert(false);
-            break;
-        }
-        case ExtraReceipts:
-        {
-            WriteGuard l(x_receipts);
-            m_receipts.erase(id.first);
-            break;
-        }
-        case ExtraLogBlooms:
-        {
-            WriteGuard l(x_logBlooms);
-            m_logBlooms.erase(id.first);
-            break;
-        }
-        case ExtraTransactionAddress:
-        {
-            WriteGuard l(x_transactionAddresses);
-            m_transactionAddresses.erase(id.first);
-            break;
-        }
-        case ExtraBlocksBlooms:
-        {
-            WriteGuard l(x_blocksBlooms);
-            m_blocksBlooms.erase(id.first);
-            break;
-        }
-        }
+        ChainCache::Stats const s = m_cache.stats(kind);
+        if (s.hits + s.misses)
+            LOG(m_logger) << "  " << c_kindNames[kind] << ": " << s.entries << " entries, "
+                          << s.bytes / 1024 << " KiB, hit rate " << s.hitRate();
     }
-    m_cacheUsage.pop_back();
-    m_cacheUsage.push_front(std::unordered_set<CacheID>{});
 }
 
 void BlockChain::checkConsistency()
 {
-    DEV_WRITE_GUARDED(x_details) { m_details.clear(); }
+    m_cache.clear(ExtraDetails);
 
     m_blocksDB->forEach([this](db::Slice const& _key, db::Slice const& /* _value */) {
         if (_key.size() == 32)
@@ -1264,18 +1218,16 @@ void BlockChain::checkConsistency()
     });
 }
 
-void BlockChain::clearCachesDuringChainReversion(unsigned _firstInvalid)
+void BlockChain::clearCachesDuringChainReversion(unsigned _firstInvalid, BlocksBloomsHash& io_blooms)
 {
     unsigned end = m_lastBlockNumber + 1;
-    DEV_WRITE_GUARDED(x_blockHashes)
-        for (auto i = _firstInvalid; i < end; ++i)
-            m_blockHashes.erase(i);
-    DEV_WRITE_GUARDED(x_transactionAddresses)
-        m_transactionAddresses.clear(); // TODO: could perhaps delete them individually?
+    for (auto i = _firstInvalid; i < end; ++i)
+        m_cache.erase(h256(i), ExtraBlockHash);
+    m_cache.clear(ExtraTransactionAddress); // TODO: could perhaps delete them individually?
 
     // If we are reverting previous blocks, we need to clear their blooms (in particular, to
     // rebuild any higher level blooms that they contributed to).
-    clearBlockBlooms(_firstInvalid, end);
+    clearBlockBlooms(_firstInvalid, end, io_blooms);
 }
 
 static inline unsigned upow(unsigned a, unsigned b) { if (!b) return 1; while (--b > 0) a *= a; return a; }
@@ -1295,6 +1247,11 @@ static inline unsigned ceilDiv(unsigned n, unsigned d) { return (n + d - 1) / d;
 // F = 14. T = 32
 
 vector<unsigned> BlockChain::withBlockBloom(LogBloom const& _b, unsigned _earliest, unsigned _latest) const
+{
+    return withBlockBloom([&](LogBloom const& _bloom) { return _bloom.contains(_b); }, _earliest, _latest);
+}
+
+vector<unsigned> BlockChain::withBlockBloom(function<bool(LogBloom const&)> const& _match, unsigned _earliest, unsigned _latest) const
 {
     vector<unsigned> ret;
 
@@ -1302,13 +1259,18 @@ vector<unsigned> BlockChain::withBlockBloom(LogBloom const& _b, unsigned _earlie
     unsigned u = upow(c_bloomIndexSize, c_bloomIndexLevels);
 
     // run through each of the top-level blockbloom blocks
-    for (unsigned index = _earliest / u; index <= ceilDiv(_latest, u); ++index)             // 0
-        ret += withBlockBloom(_b, _earliest, _latest, c_bloomIndexLevels - 1, index);
+    for (unsigned index = _earliest / u; index <= _latest / u; ++index)             // 0
+        ret += withBlockBloom(_match, _earliest, _latest, c_bloomIndexLevels - 1, index);
 
     return ret;
 }
 
 vector<unsigned> BlockChain::withBlockBloom(LogBloom const& _b, unsigned _earliest, unsigned _latest, unsigned _level, unsigned _index) const
+{
+    return withBlockBloom([&](LogBloom const& _bloom) { return _bloom.contains(_b); }, _earliest, _latest, _level, _index);
+}
+
+vector<unsigned> BlockChain::withBlockBloom(function<bool(LogBloom const&)> const& _match, unsigned _earliest, unsigned _latest, unsigned _level, unsigned _index) const
 {
     // 14, 32, 1, 0
         // 14, 32, 0, 0
@@ -1337,17 +1299,118 @@ vector<unsigned> BlockChain::withBlockBloom(LogBloom const& _b, unsigned _earlie
 
     BlocksBlooms bb = blocksBlooms(_level, _index);
     for (unsigned o = obegin; o < oend; ++o)
-        if (bb.blooms[o].contains(_b))
+        if (_match(bb.blooms[o]))
         {
             // This level has something like what we want.
             if (_level > 0)
-                ret += withBlockBloom(_b, _earliest, _latest, _level - 1, o + _index * c_bloomIndexSize);
+                ret += withBlockBloom(_match, _earliest, _latest, _level - 1, o + _index * c_bloomIndexSize);
             else
                 ret.push_back(o + _index * c_bloomIndexSize);
         }
     return ret;
 }
 
+vector<unsigned> BlockChain::withLogIndex(Address const& _address, h256 const& _topic0, unsigned _earliest, unsigned _latest) const
+{
+    vector<unsigned> ret;
+    h256 const key = logIndexKey(_address, _topic0);
+    for (unsigned bucket: logIndexBuckets(key))
+    {
+        if (bucket < _earliest / c_logIndexBucketSize)
+            continue;
+        if (bucket > _latest / c_logIndexBucketSize)
+            break;
+
+        // Entries are in import order, which a reorg may have taken back below earlier ones.
+        size_t const first = ret.size();
+        unsigned const entries = logIndexEntries(key, bucket);
+        for (unsigned i = 0; i < entries; ++i)
+        {
+            unsigned const n = RLP(m_extrasDB->lookup(toSlice(logIndexEntryKey(key, bucket, i), ExtraLogIndex))).toInt<unsigned>();
+            if (n >= _earliest && n <= _latest)
+                ret.push_back(n);
+        }
+        sort(ret.begin() + first, ret.end());
+    }
+    ret.erase(unique(ret.begin(), ret.end()), ret.end());
+    return ret;
+}
+
+set<unsigned> BlockChain::logIndexBuckets(h256 const& _key) const
+{
+    string const buckets = m_extrasDB->lookup(toSlice(_key, ExtraLogIndex));
+    return buckets.empty() ? set<unsigned>() : RLP(buckets).toSet<unsigned>();
+}
+
+unsigned BlockChain::logIndexEntries(h256 const& _key, unsigned _bucket) const
+{
+    string const entries = m_extrasDB->lookup(toSlice(logIndexBucketKey(_key, _bucket), ExtraLogIndex));
+    return entries.empty() ? 0 : RLP(entries).toInt<unsigned>();
+}
+
+void BlockChain::collectLogIndex(unsigned _number, BlockReceipts const& _receipts, LogIndexUpdates& io_updates) const
+{
+    unsigned const bucket = _number / c_logIndexBucketSize;
+    for (auto const& receipt: _receipts.receipts)
+        for (auto const& log: receipt.log())
+        {
+            // Filters without a topic0 go through the address-only key.
+            io_updates[logIndexKey(log.address, h256())][bucket].insert(_number);
+            if (!log.topics.empty())
+                io_updates[logIndexKey(log.address, log.topics[0])][bucket].insert(_number);
+        }
+}
+
+void BlockChain::writeLogIndex(LogIndexUpdates const& _updates, db::WriteBatchFace& _batch) const
+{
+    // Every block gets an entry of its own, appended behind the bucket's others without reading
+    // them, so that an import costs the same however full the bucket is.
+    for (auto const& key: _updates)
+    {
+        set<unsigned> buckets = logIndexBuckets(key.first);
+        bool newBuckets = false;
+        for (auto const& bucket: key.second)
+        {
+            newBuckets = buckets.insert(bucket.first).second || newBuckets;
+            unsigned entries = logIndexEntries(key.first, bucket.first);
+            for (unsigned number: bucket.second)
+                _batch.insert(toSlice(logIndexEntryKey(key.first, bucket.first, entries++), ExtraLogIndex), (db::Slice)dev::ref(rlp(number)));
+            _batch.insert(toSlice(logIndexBucketKey(key.first, bucket.first), ExtraLogIndex), (db::Slice)dev::ref(rlp(entries)));
+        }
+        if (newBuckets)
+            _batch.insert(toSlice(key.first, ExtraLogIndex), (db::Slice)dev::ref(rlp(buckets)));
+    }
+}
+
+void BlockChain::rebuildLogIndex(ProgressCallback const& _progress)
+{
+    unsigned const first = chainStartBlockNumber();
+    unsigned const last = min(m_logIndexFrom.load(), number() + 1);
+
+    // Read straight from the database so that walking the whole chain doesn't fill the caches.
+    LogIndexUpdates updates;
+    for (unsigned n = first; n < last; ++n)
+    {
+        h256 const hash = n ? BlockHash(RLP(m_extrasDB->lookup(toSlice(h256(n), ExtraBlockHash)))).value : m_genesisHash;
+        string const receipts = m_extrasDB->lookup(toSlice(hash, ExtraReceipts));
+        if (!receipts.empty())
+            collectLogIndex(n, BlockReceipts(RLP(receipts)), updates);
+
+        if ((n + 1) % c_logIndexBucketSize == 0 || n + 1 == last)
+        {
+            std::unique_ptr<db::WriteBatchFace> batch = m_extrasDB->createWriteBatch();
+            writeLogIndex(updates, *batch);
+            m_extrasDB->commit(std::move(batch));
+            updates.clear();
+            if (_progress)
+                _progress(n + 1 - first, last - first);
+        }
+    }
+
+    m_extrasDB->insert(c_sliceLogIndexFrom, (db::Slice)dev::ref(rlp(first)));
+    m_logIndexFrom = first;
+}
+
 h256Hash BlockChain::allKinFrom(h256 const& _parent, unsigned _generations) const
 {
     // Get all uncles cited given a parent (i.e. featured as uncles/main in parent, parent + 1, ... parent + 5).
@@ -1369,16 +1432,10 @@ bool BlockChain::isKnown(h256 const& _hash, bool _isCurrent) const
     if (_hash == m_genesisHash)
         return true;
 
-    DEV_READ_GUARDED(x_blocks)
-    if (!m_blocks.count(_hash) && !m_blocksDB->exists(toSlice(_hash)))
-    {
+    if (!m_cache.contains(_hash, c_blockCacheKind) && !m_blocksDB->exists(toSlice(_hash)))
         return false;
-        }
-    DEV_READ_GUARDED(x_details)
-    if (!m_details.count(_hash) && !m_extrasDB->exists(toSlice(_hash, ExtraDetails)))
-    {
+    if (!m_cache.contains(_hash, ExtraDetails) && !m_extrasDB->exists(toSlice(_hash, ExtraDetails)))
         return false;
-        }
 //  return true;
     return !_isCurrent || details(_hash).number <= m_lastBlockNumber;       // to allow rewind functionality.
 }
@@ -1388,12 +1445,9 @@ bytes BlockChain::block(h256 const& _hash) const
     if (_hash == m_genesisHash)
         return m_params.genesisBlock();
 
-    {
-        ReadGuard l(x_blocks);
-        auto it = m_blocks.find(_hash);
-        if (it != m_blocks.end())
-            return it->second;
-    }
+    bytes ret;
+    if (m_cache.lookup(_hash, c_blockCacheKind, ret))
+        return ret;
 
     string const d = m_blocksDB->lookup(toSlice(_hash));
     if (d.empty())
@@ -1402,13 +1456,9 @@ bytes BlockChain::block(h256 const& _hash) const
         return bytes();
     }
 
-    noteUsed(_hash);
-
-    WriteGuard l(x_blocks);
-    m_blocks[_hash].resize(d.size());
-    memcpy(m_blocks[_hash].data(), d.data(), d.size());
-
-    return m_blocks[_hash];
+    ret = asBytes(d);
+    m_cache.populate(_hash, c_blockCacheKind, ret, ret.size());
+    return ret;
 }
 
 bytes BlockChain::headerData(h256 const& _hash) const
@@ -1416,27 +1466,10 @@ bytes BlockChain::headerData(h256 const& _hash) const
     if (_hash == m_genesisHash)
         return m_genesisHeaderBytes;
 
-    {
-        ReadGuard l(x_blocks);
-        auto it = m_blocks.find(_hash);
-        if (it != m_blocks.end())
-            return BlockHeader::extractHeader(&it->second).data().toBytes();
-    }
-
-    string const d = m_blocksDB->lookup(toSlice(_hash));
-    if (d.empty())
-    {
-        cwarn << "Couldn't find requested block:" << _hash;
+    bytes b = block(_hash);
+    if (b.empty())
         return bytes();
-    }
-
-    noteUsed(_hash);
-
-    WriteGuard l(x_blocks);
-    m_blocks[_hash].resize(d.size());
-    memcpy(m_blocks[_hash].data(), d.data(), d.size());
-
-    return BlockHeader::extractHeader(&m_blocks[_hash]).data().toBytes();
+    return BlockHeader::extractHeader(&b).data().toBytes();
 }
 
 Block BlockChain::genesisBlock(OverlayDB const& _db) const
@@ -1522,27 +1555,53 @@ VerifiedBlockRef BlockChain::verifyBlock(bytesConstRef _block, std::function<voi
         }
     i = 0;
     if (_ir & (ImportRequirements::TransactionBasic | ImportRequirements::TransactionSignatures))
+    {
+        // Decode first and recover all senders in one go across the thread pool; the checks
+        // below and the execution of the block then find them cached.
+        bool const checkSignatures = _ir & ImportRequirements::TransactionSignatures;
+        auto const onBad = [&](Exception& _ex, bytesConstRef _tx) {
+            _ex << errinfo_phase(1);
+            _ex << errinfo_transactionIndex(i);
+            _ex << errinfo_transaction(_tx.toBytes());
+            addBlockInfo(_ex, h, _block.toBytes());
+            if (_onBad)
+                _onBad(_ex);
+        };
+        res.transactions.reserve(r[1].itemCount());
         for (RLP const& tr: r[1])
         {
             bytesConstRef d = tr.data();
             try
             {
-                Transaction t(d, (_ir & ImportRequirements::TransactionSignatures) ? CheckTransaction::Everything : CheckTransaction::None);
+                res.transactions.emplace_back(d, checkSignatures ? CheckTransaction::Cheap : CheckTransaction::None);
+            }
+            catch (Exception& ex)
+            {
+                onBad(ex, d);
+                throw;
+            }
+            ++i;
+        }
+
+        recoverSenders(res.transactions);
+
+        i = 0;
+        for (Transaction const& t: res.transactions)
+        {
+            try
+            {
+                if (checkSignatures)
+                    t.sender();
                 m_sealEngine->verifyTransaction(_ir, t, h, 0); // the gasUsed vs blockGasLimit is checked later in enact function
-                res.transactions.push_back(t);
             }
             catch (Exception& ex)
             {
-                ex << errinfo_phase(1);
-                ex << errinfo_transactionIndex(i);
-                ex << errinfo_transaction(d.toBytes());
-                addBlockInfo(ex, h, _block.toBytes());
-                if (_onBad)
-                    _onBad(ex);
+                onBad(ex, r[1][i].data());
                 throw;
             }
             ++i;
         }
+    }
     res.block = bytesConstRef(_block);
     return res;
 }
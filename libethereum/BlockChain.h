@@ -7,9 +7,11 @@
 #include "Account.h"
 #include "BlockDetails.h"
 #include "BlockQueue.h"
+#include "ChainCache.h"
 #include "ChainParams.h"
 #include "LastBlockHashesFace.h"
 #include "State.h"
+#include "StateCheckpoints.h"
 #include "Transaction.h"
 #include "VerifiedBlock.h"
 #include <libdevcore/db.h>
@@ -19,8 +21,13 @@
 #include <libethcore/BlockHeader.h>
 #include <libethcore/Common.h>
 #include <libethcore/SealEngine.h>
+#include <atomic>
 #include <chrono>
 #include <deque>
+#include <limits>
+#include <map>
+#include <set>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <boost/filesystem/path.hpp>
@@ -69,9 +76,13 @@ enum {
     ExtraTransactionAddress,
     ExtraLogBlooms,
     ExtraReceipts,
-    ExtraBlocksBlooms
+    ExtraBlocksBlooms,
+    ExtraLogIndex
 };
 
+/// Kind of the whole blocks in the BlockChain cache, next to the Extra* ids of the extras.
+static const unsigned c_blockCacheKind = ExtraLogIndex + 1;
+
 using ProgressCallback = std::function<void(unsigned, unsigned)>;
 
 class VersionChecker
@@ -147,23 +158,23 @@ public:
     bytes headerData() const { return headerData(currentHash()); }
 
     /// Get the familial details concerning a block (or the most recent mined if none given). Thread-safe.
-    BlockDetails details(h256 const& _hash) const { return queryExtras<BlockDetails, ExtraDetails>(_hash, m_details, x_details, NullBlockDetails); }
+    BlockDetails details(h256 const& _hash) const { return queryExtras<BlockDetails, ExtraDetails>(_hash, NullBlockDetails); }
     BlockDetails details() const { return details(currentHash()); }
 
     /// Get the transactions' log blooms of a block (or the most recent mined if none given). Thread-safe.
-    BlockLogBlooms logBlooms(h256 const& _hash) const { return queryExtras<BlockLogBlooms, ExtraLogBlooms>(_hash, m_logBlooms, x_logBlooms, NullBlockLogBlooms); }
+    BlockLogBlooms logBlooms(h256 const& _hash) const { return queryExtras<BlockLogBlooms, ExtraLogBlooms>(_hash, NullBlockLogBlooms); }
     BlockLogBlooms logBlooms() const { return logBlooms(currentHash()); }
 
     /// Get the transactions' receipts of a block (or the most recent mined if none given). Thread-safe.
     /// receipts are given in the same order are in the same order as the transactions
-    BlockReceipts receipts(h256 const& _hash) const { return queryExtras<BlockReceipts, ExtraReceipts>(_hash, m_receipts, x_receipts, NullBlockReceipts); }
+    BlockReceipts receipts(h256 const& _hash) const { return queryExtras<BlockReceipts, ExtraReceipts>(_hash, NullBlockReceipts); }
     BlockReceipts receipts() const { return receipts(currentHash()); }
 
     /// Get the transaction by block hash and index;
     TransactionReceipt transactionReceipt(h256 const& _blockHash, unsigned _i) const { return receipts(_blockHash).receipts[_i]; }
 
     /// Get the transaction receipt by transaction hash. Thread-safe.
-    TransactionReceipt transactionReceipt(h256 const& _transactionHash) const { TransactionAddress ta = queryExtras<TransactionAddress, ExtraTransactionAddress>(_transactionHash, m_transactionAddresses, x_transactionAddresses, NullTransactionAddress); if (!ta) return bytesConstRef(); return transactionReceipt(ta.blockHash, ta.index); }
+    TransactionReceipt transactionReceipt(h256 const& _transactionHash) const { TransactionAddress ta = queryExtras<TransactionAddress, ExtraTransactionAddress>(_transactionHash, NullTransactionAddress); if (!ta) return bytesConstRef(); return transactionReceipt(ta.blockHash, ta.index); }
 
     /// Get a list of transaction hashes for a given block. Thread-safe.
     TransactionHashes transactionHashes(h256 const& _hash) const { auto b = block(_hash); RLP rlp(b); h256s ret; for (auto t: rlp[1]) ret.push_back(sha3(t.data())); return ret; }
@@ -174,7 +185,7 @@ public:
     UncleHashes uncleHashes() const { return uncleHashes(currentHash()); }
     
     /// Get the hash for a given block's number.
-    h256 numberHash(unsigned _i) const { if (!_i) return genesisHash(); return queryExtras<BlockHash, uint64_t, ExtraBlockHash>(_i, m_blockHashes, x_blockHashes, NullBlockHash).value; }
+    h256 numberHash(unsigned _i) const { if (!_i) return genesisHash(); return queryExtras<BlockHash, ExtraBlockHash>(h256(_i), NullBlockHash).value; }
 
     LastBlockHashesFace const& lastBlockHashes() const { return *m_lastBlockHashes;  }
 
@@ -195,17 +206,35 @@ public:
      * i * (x ^ n) + o * x ^ (n - 1)
      */
     BlocksBlooms blocksBlooms(unsigned _level, unsigned _index) const { return blocksBlooms(chunkId(_level, _index)); }
-    BlocksBlooms blocksBlooms(h256 const& _chunkId) const { return queryExtras<BlocksBlooms, ExtraBlocksBlooms>(_chunkId, m_blocksBlooms, x_blocksBlooms, NullBlocksBlooms); }
+    BlocksBlooms blocksBlooms(h256 const& _chunkId) const { return queryExtras<BlocksBlooms, ExtraBlocksBlooms>(_chunkId, NullBlocksBlooms); }
     LogBloom blockBloom(unsigned _number) const { return blocksBlooms(chunkId(0, _number / c_bloomIndexSize)).blooms[_number % c_bloomIndexSize]; }
     std::vector<unsigned> withBlockBloom(LogBloom const& _b, unsigned _earliest, unsigned _latest) const;
     std::vector<unsigned> withBlockBloom(LogBloom const& _b, unsigned _earliest, unsigned _latest, unsigned _topLevel, unsigned _index) const;
+    /// Numbers of the blocks in [_earliest, _latest], in ascending order, whose bloom satisfies
+    /// @a _match. Only chunks whose combined bloom satisfies it are descended into, so @a _match
+    /// must hold for any superset of a bloom it holds for.
+    std::vector<unsigned> withBlockBloom(std::function<bool(LogBloom const&)> const& _match, unsigned _earliest, unsigned _latest) const;
+    std::vector<unsigned> withBlockBloom(std::function<bool(LogBloom const&)> const& _match, unsigned _earliest, unsigned _latest, unsigned _topLevel, unsigned _index) const;
+
+    /// @returns the first block number covered by the (address, topic0) log index, or
+    /// std::numeric_limits<unsigned>::max() if there is no index. Thread-safe.
+    unsigned logIndexFrom() const { return m_logIndexFrom; }
+    /// Numbers of the blocks in [_earliest, _latest], in ascending order, the log index lists for
+    /// @a _address and @a _topic0. A zero @a _topic0 stands for any log of @a _address.
+    /// Entries of blocks that have since left the canonical chain are not removed, so the
+    /// receipts still have to be matched against the filter. Thread-safe.
+    std::vector<unsigned> withLogIndex(Address const& _address, h256 const& _topic0, unsigned _earliest, unsigned _latest) const;
+    /// Index the logs of the canonical blocks imported before the log index was enabled.
+    /// Must not be called concurrently with block imports.
+    /// Will call _progress with the progress in this operation first param done, second total.
+    void rebuildLogIndex(ProgressCallback const& _progress = ProgressCallback());
 
     /// Returns true if transaction is known. Thread-safe
-    bool isKnownTransaction(h256 const& _transactionHash) const { TransactionAddress ta = queryExtras<TransactionAddress, ExtraTransactionAddress>(_transactionHash, m_transactionAddresses, x_transactionAddresses, NullTransactionAddress); return !!ta; }
+    bool isKnownTransaction(h256 const& _transactionHash) const { TransactionAddress ta = queryExtras<TransactionAddress, ExtraTransactionAddress>(_transactionHash, NullTransactionAddress); return !!ta; }
 
     /// Get a transaction from its hash. Thread-safe.
-    bytes transaction(h256 const& _transactionHash) const { TransactionAddress ta = queryExtras<TransactionAddress, ExtraTransactionAddress>(_transactionHash, m_transactionAddresses, x_transactionAddresses, NullTransactionAddress); if (!ta) return bytes(); return transaction(ta.blockHash, ta.index); }
-    std::pair<h256, unsigned> transactionLocation(h256 const& _transactionHash) const { TransactionAddress ta = queryExtras<TransactionAddress, ExtraTransactionAddress>(_transactionHash, m_transactionAddresses, x_transactionAddresses, NullTransactionAddress); if (!ta) return std::pair<h256, unsigned>(h256(), 0); return std::make_pair(ta.blockHash, ta.index); }
+    bytes transaction(h256 const& _transactionHash) const { TransactionAddress ta = queryExtras<TransactionAddress, ExtraTransactionAddress>(_transactionHash, NullTransactionAddress); if (!ta) return bytes(); return transaction(ta.blockHash, ta.index); }
+    std::pair<h256, unsigned> transactionLocation(h256 const& _transactionHash) const { TransactionAddress ta = queryExtras<TransactionAddress, ExtraTransactionAddress>(_transactionHash, NullTransactionAddress); if (!ta) return std::pair<h256, unsigned>(h256(), 0); return std::make_pair(ta.blockHash, ta.index); }
 
     /// Get a block's transaction (RLP format) for the given block hash (or the most recent mined if none given) & index. Thread-safe.
     bytes transaction(h256 const& _blockHash, unsigned _i) const { bytes b = block(_blockHash); return RLP(b)[1][_i].data().toBytes(); }
@@ -279,10 +308,17 @@ public:
 
     /// @returns statistics about memory usage.
     Statistics usage(bool _freshen = false) const { if (_freshen) updateStats(); return m_lastStats; }
+    /// @returns hits, misses and size of the cached blocks (c_blockCacheKind) or extras of kind @a _kind.
+    ChainCache::Stats cacheStats(unsigned _kind) const { return m_cache.stats(_kind); }
 
-    /// Deallocate unused data.
+    /// Refreshes the statistics and periodically logs the cache hit rates; with @a _force, also
+    /// empties the cache. The cache itself stays within its budget as entries are inserted.
     void garbageCollect(bool _force = false);
 
+    /// States part way through recently enacted blocks, recorded by Block::enact() once
+    /// given an interval.
+    StateCheckpoints& stateCheckpoints() const { return m_stateCheckpoints; }
+
     /// Change the function that is called with a bad block.
     void setOnBad(std::function<void(Exception&)> _t) { m_onBad = _t; }
 
@@ -325,66 +361,46 @@ private:
     void checkBlockIsNew(VerifiedBlockRef const& _block) const;
     void checkBlockTimestamp(BlockHeader const& _header) const;
 
-    template <class T, class K, unsigned N>
-    T queryExtras(K const& _h, std::unordered_map<K, T>& _m, boost::shared_mutex& _x, T const& _n,
-        db::DatabaseFace* _extrasDB = nullptr) const
+    /// Numbers of the blocks to add to the log index, by key and bucket.
+    using LogIndexUpdates = std::map<h256, std::map<unsigned, std::set<unsigned>>>;
+    void collectLogIndex(unsigned _number, BlockReceipts const& _receipts, LogIndexUpdates& io_updates) const;
+    void writeLogIndex(LogIndexUpdates const& _updates, db::WriteBatchFace& _batch) const;
+    std::set<unsigned> logIndexBuckets(h256 const& _key) const;
+    /// @returns the number of blocks listed in bucket @a _bucket of log index key @a _key.
+    unsigned logIndexEntries(h256 const& _key, unsigned _bucket) const;
+
+    template <class T, unsigned N>
+    T queryExtras(h256 const& _h, T const& _n, db::DatabaseFace* _extrasDB = nullptr) const
     {
-        {
-            ReadGuard l(_x);
-            auto it = _m.find(_h);
-            if (it != _m.end())
-                return it->second;
-        }
+        T ret;
+        if (m_cache.lookup(_h, N, ret))
+            return ret;
 
         std::string const s = (_extrasDB ? _extrasDB : m_extrasDB.get())->lookup(toSlice(_h, N));
         if (s.empty())
             return _n;
 
-        noteUsed(_h, N);
-
-        WriteGuard l(_x);
-        auto ret = _m.insert(std::make_pair(_h, T(RLP(s))));
-        return ret.first->second;
-    }
-
-    template <class T, unsigned N>
-    T queryExtras(h256 const& _h, std::unordered_map<h256, T>& _m, boost::shared_mutex& _x,
-        T const& _n, db::DatabaseFace* _extrasDB = nullptr) const
-    {
-        return queryExtras<T, h256, N>(_h, _m, _x, _n, _extrasDB);
+        ret = T(RLP(s));
+        m_cache.populate(_h, N, ret, s.size());
+        return ret;
     }
 
     void checkConsistency();
 
     /// Clears all caches from the tip of the chain up to (including) _firstInvalid.
     /// These include the blooms, the block hashes and the transaction lookup tables.
-    void clearCachesDuringChainReversion(unsigned _firstInvalid);
-    void clearBlockBlooms(unsigned _begin, unsigned _end);
-
-    /// The caches of the disk DB and their locks.
-    mutable SharedMutex x_blocks;
-    mutable BlocksHash m_blocks;
-    mutable SharedMutex x_details;
-    mutable BlockDetailsHash m_details;
-    mutable SharedMutex x_logBlooms;
-    mutable BlockLogBloomsHash m_logBlooms;
-    mutable SharedMutex x_receipts;
-    mutable BlockReceiptsHash m_receipts;
-    mutable SharedMutex x_transactionAddresses;
-    mutable TransactionAddressHash m_transactionAddresses;
-    mutable SharedMutex x_blockHashes;
-    mutable BlockHashHash m_blockHashes;
-    mutable SharedMutex x_blocksBlooms;
-    mutable BlocksBloomsHash m_blocksBlooms;
-
-    using CacheID = std::pair<h256, unsigned>;
-    mutable Mutex x_cacheUsage;
-    mutable std::deque<std::unordered_set<CacheID>> m_cacheUsage;
-    mutable std::unordered_set<CacheID> m_inUse;
-    void noteUsed(h256 const& _h, unsigned _extra = (unsigned)-1) const;
-    void noteUsed(uint64_t const& _h, unsigned _extra = (unsigned)-1) const { (void)_h; (void)_extra; } // don't note non-hash types
+    /// The rebuilt chunks are put into @a io_blooms rather than the cache; the caller writes them.
+    void clearCachesDuringChainReversion(unsigned _firstInvalid, BlocksBloomsHash& io_blooms);
+    void clearBlockBlooms(unsigned _begin, unsigned _end, BlocksBloomsHash& io_blooms);
+    /// Writes @a _blooms to @a _batch and the cache.
+    void writeBlocksBlooms(BlocksBloomsHash const& _blooms, db::WriteBatchFace& _batch) const;
+
+    /// The cache of the disk DBs, shared by the blocks (c_blockCacheKind) and every kind of extras.
+    mutable ChainCache m_cache;
     std::chrono::system_clock::time_point m_lastCollection;
 
+    mutable StateCheckpoints m_stateCheckpoints;
+
     void noteCanonChanged() const { m_lastBlockHashes->clear(); }
     std::unique_ptr<LastBlockHashesFace> m_lastBlockHashes;
 
@@ -400,6 +416,9 @@ private:
     h256 m_lastBlockHash;
     unsigned m_lastBlockNumber = 0;
 
+    /// First block number whose logs are written to the log index on import.
+    std::atomic<unsigned> m_logIndexFrom{std::numeric_limits<unsigned>::max()};
+
     ChainParams m_params;
     std::shared_ptr<SealEngineFace> m_sealEngine;   // consider shared_ptr.
     mutable SharedMutex x_genesis;
@@ -21,14 +21,16 @@ class BlockChainImporter: public BlockChainImporterFace
 public:
 	explicit BlockChainImporter(BlockChain& _blockChain): m_blockChain(_blockChain) {}
 
-	void importBlock(BlockHeader const& _header, RLP _transactions, RLP _uncles, RLP _receipts, u256 const& _totalDifficulty) override
+	void importBlock(BlockHeader const& _header, RLP _transactions, RLP _uncles, RLP _extraItems, RLP _receipts, u256 const& _totalDifficulty) override
 	{
 		RLPStream headerRlp;
 		_header.streamRLP(headerRlp);
 
-		RLPStream block(3);
+		RLPStream block(3 + _extraItems.itemCount());
 		block.appendRaw(headerRlp.out());
 		block << _transactions << _uncles;
+		for (auto const& item: _extraItems)
+			block.appendRaw(item.data());
 
 		m_blockChain.insertWithoutParent(block.out(), _receipts.data(), _totalDifficulty);
 	}
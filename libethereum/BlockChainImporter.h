@@ -26,7 +26,8 @@ class BlockChainImporterFace
 public:
 	virtual ~BlockChainImporterFace() = default;
 
-	virtual void importBlock(BlockHeader const& _header, RLP _transactions, RLP _uncles, RLP _receipts, u256 const& _totalDifficulty) = 0;
+	/// @param _extraItems list of the items the block has after its uncles, e.g. Qpos' signatures.
+	virtual void importBlock(BlockHeader const& _header, RLP _transactions, RLP _uncles, RLP _extraItems, RLP _receipts, u256 const& _totalDifficulty) = 0;
 
 	virtual void setChainStartBlockNumber(u256 const& _number) = 0;
 };
@@ -12,6 +12,7 @@
 #include <libethcore/Exceptions.h>
 #include <libp2p/Host.h>
 #include <libp2p/Session.h>
+#include <algorithm>
 #include <chrono>
 
 using namespace std;
@@ -32,7 +33,6 @@ namespace  // Helper functions.
 
 constexpr unsigned c_maxPeerUknownNewBlocks = 1024; /// Max number of unknown new blocks peer can give us
 constexpr unsigned c_maxRequestHeaders = 1024;
-constexpr unsigned c_maxRequestBodies = 1024;
 
 template<typename T> bool haveItem(std::map<unsigned, T>& _container, unsigned _number)
 {
@@ -135,6 +135,13 @@ template<typename T> void mergeInto(std::map<unsigned, std::vector<T>>& _contain
     }
 }
 
+template<typename T> void eraseOne(std::unordered_multiset<T>& _container, T const& _item)
+{
+    auto it = _container.find(_item);
+    if (it != _container.end())
+        _container.erase(it);
+}
+
 }  // Anonymous namespace -- helper functions.
 
 BlockChainSync::BlockChainSync(EthereumCapability& _host)
@@ -171,6 +178,14 @@ void BlockChainSync::onBlockImported(BlockHeader const& _info)
     }
 }
 
+void BlockChainSync::rescheduleStalledBodies()
+{
+    RecursiveGuard l(x_sync);
+    // Idle peers pick up late bodies when asked for more work
+    if (m_state == SyncState::Blocks && !m_bodyRequests.empty())
+        continueSync();
+}
+
 void BlockChainSync::abortSync()
 {
     RecursiveGuard l(x_sync);
@@ -191,8 +206,8 @@ void BlockChainSync::onPeerStatus(EthereumPeer const& _peer)
     if (peerSessionInfo->clientVersion.find("/v0.7.0/") != string::npos)
         disconnectReason = "Blacklisted client version.";
     else
-        disconnectReason = _peer.validate(
-            host().chain().genesisHash(), host().protocolVersion(), host().networkId());
+        disconnectReason = _peer.validate(host().chain().genesisHash(), host().networkId(),
+            host().forkIds(), host().chain().number());
 
     if (!disconnectReason.empty())
     {
@@ -301,11 +316,16 @@ void BlockChainSync::requestBlocks(NodeID const& _peerID)
     h256s neededBodies;
     vector<unsigned> neededNumbers;
     unsigned index = 0;
+    unsigned const maxBodies = m_bodyRequests.requestSize(_peerID);
+    // bodies far ahead would only wait in memory for the ones before them
+    unsigned const bodiesEnd = BodyRequestTracker::bodiesEnd(m_lastImportedBlock);
     if (m_haveCommonHeader && !m_headers.empty() && m_headers.begin()->first == m_lastImportedBlock + 1)
     {
-        while (header != m_headers.end() && neededBodies.size() < c_maxRequestBodies && index < header->second.size())
+        while (header != m_headers.end() && neededBodies.size() < maxBodies && index < header->second.size())
         {
             unsigned block = header->first + index;
+            if (block >= bodiesEnd)
+                break;
             if (m_downloadingBodies.count(block) == 0 && !haveItem(m_bodies, block))
             {
                 neededBodies.push_back(header->second[index].hash);
@@ -317,10 +337,14 @@ void BlockChainSync::requestBlocks(NodeID const& _peerID)
             if (index >= header->second.size())
                 break; // Download bodies only for validated header chain
         }
+        if (neededBodies.empty())
+            takeOverStragglerBodies(_peerID, maxBodies, neededBodies, neededNumbers);
     }
     if (neededBodies.size() > 0)
     {
-        m_bodySyncPeers[_peerID] = neededNumbers;
+        LOG(m_loggerDetail) << "Requesting " << neededBodies.size() << " block bodies from "
+                            << _peerID;
+        m_bodyRequests.requested(_peerID, neededNumbers, BodyRequestTracker::Clock::now());
         m_host.peer(_peerID).requestBlockBodies(neededBodies);
     }
     else
@@ -342,6 +366,7 @@ void BlockChainSync::requestBlocks(NodeID const& _peerID)
         if (m_haveCommonHeader)
         {
             start = m_lastImportedBlock + 1;
+            unsigned const headersEnd = BodyRequestTracker::headersEnd(m_lastImportedBlock);
             auto next = m_headers.begin();
             unsigned count = 0;
             if (!m_headers.empty() && start >= m_headers.begin()->first)
@@ -350,9 +375,9 @@ void BlockChainSync::requestBlocks(NodeID const& _peerID)
                 ++next;
             }
 
-            while (count == 0 && next != m_headers.end())
+            while (count == 0 && next != m_headers.end() && start < headersEnd)
             {
-                count = std::min(c_maxRequestHeaders, next->first - start);
+                count = std::min({c_maxRequestHeaders, next->first - start, headersEnd - start});
                 while(count > 0 && m_downloadingHeaders.count(start) != 0)
                 {
                     start++;
@@ -393,13 +418,8 @@ void BlockChainSync::clearPeerDownload(NodeID const& _peerID)
             m_downloadingHeaders.erase(block);
         m_headerSyncPeers.erase(syncPeer);
     }
-    syncPeer = m_bodySyncPeers.find(_peerID);
-    if (syncPeer != m_bodySyncPeers.end())
-    {
-        for (unsigned block : syncPeer->second)
-            m_downloadingBodies.erase(block);
-        m_bodySyncPeers.erase(syncPeer);
-    }
+    for (unsigned block : m_bodyRequests.remove(_peerID))
+        eraseOne(m_downloadingBodies, block);
     m_daoChallengedPeers.erase(_peerID);
 }
 
@@ -416,17 +436,10 @@ void BlockChainSync::clearPeerDownload()
         else
             ++s;
     }
-    for (auto s = m_bodySyncPeers.begin(); s != m_bodySyncPeers.end();)
-    {
-        if (!m_host.capabilityHost().peerSessionInfo(s->first))
-        {
-            for (unsigned block : s->second)
-                m_downloadingBodies.erase(block);
-            m_bodySyncPeers.erase(s++);
-        }
-        else
-            ++s;
-    }
+    for (auto const& peer : m_bodyRequests.peers())
+        if (!m_host.capabilityHost().peerSessionInfo(peer))
+            for (unsigned block : m_bodyRequests.peerGone(peer))
+                eraseOne(m_downloadingBodies, block);
     for (auto s = m_daoChallengedPeers.begin(); s != m_daoChallengedPeers.end();)
     {
         if (!m_host.capabilityHost().peerSessionInfo(*s))
@@ -436,6 +449,32 @@ void BlockChainSync::clearPeerDownload()
     }
 }
 
+bool BlockChainSync::takeOverStragglerBodies(
+    NodeID const& _peerID, unsigned _maxCount, h256s& o_hashes, vector<unsigned>& o_numbers)
+{
+    // The first missing body is the one the block queue is waiting for
+    unsigned firstMissing = m_lastImportedBlock + 1;
+    if (!m_bodies.empty() && m_bodies.begin()->first == firstMissing)
+        firstMissing += m_bodies.begin()->second.size();
+
+    bool const taken = m_bodyRequests.takeOver(
+        _peerID, firstMissing, BodyRequestTracker::Clock::now(), [&](unsigned _block) {
+            if (o_numbers.size() >= _maxCount)
+                return false;
+            Header const* header = findItem(m_headers, _block);
+            if (_block < firstMissing || !header || haveItem(m_bodies, _block))
+                return false;
+            o_hashes.push_back(header->hash);
+            o_numbers.push_back(_block);
+            m_downloadingBodies.insert(_block);
+            return true;
+        });
+    if (taken)
+        LOG(m_logger) << "Block bodies late, requesting " << o_numbers.size() << " of them from "
+                      << _peerID;
+    return taken;
+}
+
 void BlockChainSync::logNewBlock(h256 const& _h)
 {
     m_knownNewHashes.erase(_h);
@@ -595,6 +634,7 @@ void BlockChainSync::onPeerBlockBodies(NodeID const& _peerID, RLP const& _r)
     size_t itemCount = _r.itemCount();
     LOG(m_logger) << "BlocksBodies (" << dec << itemCount << " entries) "
                   << (itemCount ? "" : ": NoMoreBodies") << " from " << _peerID;
+    m_bodyRequests.received(_peerID, itemCount, BodyRequestTracker::Clock::now());
     clearPeerDownload(_peerID);
     if (m_state != SyncState::Blocks && m_state != SyncState::Waiting) {
         LOG(m_logger) << "Ignoring unexpected blocks from " << _peerID;
@@ -852,7 +892,7 @@ void BlockChainSync::resetSync()
     m_headers.clear();
     m_bodies.clear();
     m_headerSyncPeers.clear();
-    m_bodySyncPeers.clear();
+    m_bodyRequests.clearRequests();
     m_headerIdToNumber.clear();
     m_syncingTotalDifficulty = 0;
     m_state = SyncState::NotSynced;
@@ -956,7 +996,7 @@ bool BlockChainSync::invariants() const
         BOOST_THROW_EXCEPTION(FailedInvariant() << errinfo_comment("Header is too old"));
     if (m_headerSyncPeers.empty() != m_downloadingHeaders.empty())
         BOOST_THROW_EXCEPTION(FailedInvariant() << errinfo_comment("Header download map mismatch"));
-    if (m_bodySyncPeers.empty() != m_downloadingBodies.empty() && m_downloadingBodies.size() <= m_headerIdToNumber.size())
+    if (m_bodyRequests.empty() != m_downloadingBodies.empty() && m_downloadingBodies.size() <= m_headerIdToNumber.size())
         BOOST_THROW_EXCEPTION(FailedInvariant() << errinfo_comment("Body download map mismatch"));
     return true;
 }
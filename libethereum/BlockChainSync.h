@@ -6,11 +6,13 @@
 
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <libdevcore/Guards.h>
 #include <libethcore/Common.h>
 #include <libethcore/BlockHeader.h>
 #include <libp2p/Common.h>
+#include "BodyRequestTracker.h"
 #include "CommonNet.h"
 
 namespace dev
@@ -65,6 +67,9 @@ public:
     /// Called when a blockchain has imported a new block onto the DB
     void onBlockImported(BlockHeader const& _info);
 
+    /// Called periodically to hand block bodies held up by a slow peer to idle peers
+    void rescheduleStalledBodies();
+
     /// @returns Synchonization status
     SyncStatus status() const;
 
@@ -87,6 +92,11 @@ private:
     void clearPeerDownload(NodeID const& _peerID);
     void clearPeerDownload();
     void collectBlocks();
+    /// Picks up to @a _maxCount bodies of the request holding up the next import, if it takes
+    /// much longer than expected and @a _peerID is not known to be slower.
+    /// @returns true if any bodies were picked.
+    bool takeOverStragglerBodies(NodeID const& _peerID, unsigned _maxCount, h256s& o_hashes,
+        std::vector<unsigned>& o_numbers);
     bool requestDaoForkBlockHeader(NodeID const& _peerID);
     bool verifyDaoChallengeResponse(RLP const& _r);
     void logImported(unsigned _success, unsigned _future, unsigned _got, unsigned _unknown);
@@ -134,13 +144,14 @@ private:
     unsigned m_startingBlock = 0;      	    	///< Last block number for the start of sync
     unsigned m_highestBlock = 0;       	     	///< Highest block number seen
     std::unordered_set<unsigned> m_downloadingHeaders;		///< Set of block body numbers being downloaded
-    std::unordered_set<unsigned> m_downloadingBodies;		///< Set of block header numbers being downloaded
+    /// Block body numbers being downloaded, once per peer downloading them
+    std::unordered_multiset<unsigned> m_downloadingBodies;
     std::map<unsigned, std::vector<Header>> m_headers;	    ///< Downloaded headers
     std::map<unsigned, std::vector<bytes>> m_bodies;	    ///< Downloaded block bodies
     /// Peers to m_downloadingHeaders number map
     std::map<NodeID, std::vector<unsigned>> m_headerSyncPeers;
-    /// Peers to m_downloadingBodies number map
-    std::map<NodeID, std::vector<unsigned>> m_bodySyncPeers;
+    /// Peers to their requests of m_downloadingBodies and their throughput
+    BodyRequestTracker m_bodyRequests;
     std::unordered_map<HeaderId, unsigned, HeaderIdHash> m_headerIdToNumber;
     bool m_haveCommonHeader = false;			///< True if common block for our and remote chain has been found
     unsigned m_lastImportedBlock = 0; 			///< Last imported block number
@@ -0,0 +1,113 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "BodyRequestTracker.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+constexpr unsigned BodyRequestTracker::c_minRequestBodies;
+constexpr unsigned BodyRequestTracker::c_maxRequestBodies;
+constexpr unsigned BodyRequestTracker::c_initialRequestBodies;
+constexpr double BodyRequestTracker::c_targetResponseSeconds;
+constexpr double BodyRequestTracker::c_stragglerFactor;
+constexpr unsigned BodyRequestTracker::c_maxBodiesLookahead;
+constexpr unsigned BodyRequestTracker::c_maxHeadersLookahead;
+
+unsigned BodyRequestTracker::requestSize(p2p::NodeID const& _peer) const
+{
+    auto const rate = m_bodiesPerSecond.find(_peer);
+    if (rate == m_bodiesPerSecond.end())
+        return c_initialRequestBodies;
+    auto const size = static_cast<unsigned>(
+        min<double>(rate->second * c_targetResponseSeconds, c_maxRequestBodies));
+    return max(size, c_minRequestBodies);
+}
+
+void BodyRequestTracker::requested(
+    p2p::NodeID const& _peer, vector<unsigned> _numbers, Clock::time_point _now)
+{
+    m_requests[_peer] = {move(_numbers), _now, _now};
+}
+
+void BodyRequestTracker::received(p2p::NodeID const& _peer, size_t _received, Clock::time_point _now)
+{
+    auto const request = m_requests.find(_peer);
+    if (request == m_requests.end())
+        return;
+
+    double const seconds =
+        max(chrono::duration<double>(_now - request->second.sent).count(), 1e-3);
+    double const rate = min(_received, request->second.numbers.size()) / seconds;
+    auto const average = m_bodiesPerSecond.find(_peer);
+    if (average == m_bodiesPerSecond.end())
+        m_bodiesPerSecond[_peer] = rate;
+    else
+        average->second = (average->second + rate) / 2;
+}
+
+vector<unsigned> BodyRequestTracker::remove(p2p::NodeID const& _peer)
+{
+    auto const request = m_requests.find(_peer);
+    if (request == m_requests.end())
+        return {};
+    vector<unsigned> ret = move(request->second.numbers);
+    m_requests.erase(request);
+    return ret;
+}
+
+vector<unsigned> BodyRequestTracker::peerGone(p2p::NodeID const& _peer)
+{
+    m_bodiesPerSecond.erase(_peer);
+    return remove(_peer);
+}
+
+bool BodyRequestTracker::takeOver(p2p::NodeID const& _peer, unsigned _block,
+    Clock::time_point _now, function<bool(unsigned)> const& _pick)
+{
+    auto straggler = m_requests.begin();
+    for (; straggler != m_requests.end(); ++straggler)
+    {
+        auto const& numbers = straggler->second.numbers;
+        if (straggler->first != _peer && find(numbers.begin(), numbers.end(), _block) != numbers.end())
+            break;
+    }
+    if (straggler == m_requests.end())
+        return false;
+
+    Request& request = straggler->second;
+    double expected = c_targetResponseSeconds;
+    auto const stragglerRate = m_bodiesPerSecond.find(straggler->first);
+    if (stragglerRate != m_bodiesPerSecond.end() && stragglerRate->second > 0)
+        expected = max(expected, request.numbers.size() / stragglerRate->second);
+    double const waited = chrono::duration<double>(_now - request.takenOver).count();
+    if (waited < c_stragglerFactor * expected)
+        return false;
+
+    double const elapsed = chrono::duration<double>(_now - request.sent).count();
+    auto const rate = m_bodiesPerSecond.find(_peer);
+    if (rate != m_bodiesPerSecond.end() && rate->second <= request.numbers.size() / elapsed)
+        return false;
+
+    bool taken = false;
+    for (unsigned block : request.numbers)
+        taken = _pick(block) || taken;
+    if (taken)
+        request.takenOver = _now;
+    return taken;
+}
+
+vector<p2p::NodeID> BodyRequestTracker::peers() const
+{
+    vector<p2p::NodeID> ret;
+    for (auto const& request : m_requests)
+        ret.push_back(request.first);
+    for (auto const& rate : m_bodiesPerSecond)
+        if (!m_requests.count(rate.first))
+            ret.push_back(rate.first);
+    return ret;
+}
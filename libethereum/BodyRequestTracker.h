@@ -0,0 +1,99 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#pragma once
+
+#include <libp2p/Common.h>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace dev
+{
+namespace eth
+{
+/// Keeps the block bodies requested from each peer and the peers' measured throughput, sizes
+/// new requests by it and finds requests held up by a slow peer, so that BlockChainSync can ask
+/// their bodies from another peer.
+/// Not thread-safe; used under BlockChainSync's lock.
+class BodyRequestTracker
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr unsigned c_minRequestBodies = 16;
+    static constexpr unsigned c_maxRequestBodies = 1024;
+    /// Bodies asked from a peer with unknown throughput.
+    static constexpr unsigned c_initialRequestBodies = 128;
+    /// Requests are sized to take about this long.
+    static constexpr double c_targetResponseSeconds = 2;
+    /// Requests taking this many times longer than expected are taken over by other peers.
+    static constexpr double c_stragglerFactor = 2;
+    /// Bodies are downloaded at most this far ahead of the last imported block.
+    static constexpr unsigned c_maxBodiesLookahead = 4096;
+    /// Headers are downloaded at most this far ahead of the last imported block.
+    static constexpr unsigned c_maxHeadersLookahead = 32768;
+
+    /// @returns the block number from which on bodies aren't requested yet while @a _lastImported
+    /// is the last imported block.
+    static unsigned bodiesEnd(unsigned _lastImported)
+    {
+        return _lastImported + 1 + c_maxBodiesLookahead;
+    }
+    /// @returns the block number from which on headers aren't requested yet while
+    /// @a _lastImported is the last imported block.
+    static unsigned headersEnd(unsigned _lastImported)
+    {
+        return _lastImported + 1 + c_maxHeadersLookahead;
+    }
+
+    /// @returns the number of bodies to ask from @a _peer, sized from its measured throughput.
+    unsigned requestSize(p2p::NodeID const& _peer) const;
+
+    /// Notes that the bodies of blocks @a _numbers have been asked from @a _peer at @a _now.
+    void requested(p2p::NodeID const& _peer, std::vector<unsigned> _numbers, Clock::time_point _now);
+
+    /// Updates the throughput of @a _peer from its answer of @a _received bodies arriving at
+    /// @a _now. The request stays noted until removed.
+    void received(p2p::NodeID const& _peer, size_t _received, Clock::time_point _now);
+
+    /// Forgets the request of @a _peer. @returns the block numbers it asked for.
+    std::vector<unsigned> remove(p2p::NodeID const& _peer);
+
+    /// Forgets the request and the throughput of @a _peer. @returns the block numbers it asked for.
+    std::vector<unsigned> peerGone(p2p::NodeID const& _peer);
+
+    /// Finds the request of a peer other than @a _peer holding block @a _block that has taken
+    /// c_stragglerFactor times longer than expected since it was sent or last taken over, unless
+    /// @a _peer is known to be slower. Offers its block numbers to @a _pick in order, which
+    /// @returns whether it took the number. The request counts as taken over at @a _now only if
+    /// any number was taken, and may be taken over again after another such wait.
+    /// @returns true if any number was taken.
+    bool takeOver(p2p::NodeID const& _peer, unsigned _block, Clock::time_point _now,
+        std::function<bool(unsigned)> const& _pick);
+
+    /// @returns the peers with a request or a measured throughput.
+    std::vector<p2p::NodeID> peers() const;
+
+    bool empty() const { return m_requests.empty(); }
+    void clearRequests() { m_requests.clear(); }
+
+private:
+    struct Request
+    {
+        std::vector<unsigned> numbers;
+        Clock::time_point sent;
+        /// Last time the bodies were asked from another peer as well.
+        Clock::time_point takenOver;
+    };
+
+    std::map<p2p::NodeID, Request> m_requests;
+    /// Moving average of bodies per second received from each peer.
+    std::map<p2p::NodeID, double> m_bodiesPerSecond;
+};
+
+}  // namespace eth
+}  // namespace dev
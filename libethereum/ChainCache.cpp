@@ -0,0 +1,11 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "ChainCache.h"
+
+using namespace dev;
+using namespace dev::eth;
+
+constexpr unsigned ChainCache::c_kinds;
+constexpr size_t ChainCache::c_entryOverhead;
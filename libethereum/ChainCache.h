@@ -0,0 +1,103 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#pragma once
+
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/ShardedLruCache.h>
+
+#include <memory>
+
+namespace dev
+{
+namespace eth
+{
+/// Thread-safe cache of the decoded blocks and extras BlockChain reads from its databases,
+/// bounded by the total size of the cached entries. Each entry is keyed by a hash and a kind,
+/// and all kinds share one budget.
+class ChainCache
+{
+public:
+    /// Highest kind + 1 that may be cached.
+    static constexpr unsigned c_kinds = 8;
+    /// Rough cost of the list node, the index entry and the decoded object, counted for each
+    /// entry on top of its encoded size.
+    static constexpr size_t c_entryOverhead = 96;
+
+private:
+    struct Key
+    {
+        h256 hash;
+        unsigned kind;
+
+        bool operator==(Key const& _k) const { return kind == _k.kind && hash == _k.hash; }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(Key const& _k) const { return h256::hash()(_k.hash) + _k.kind; }
+    };
+
+    struct KindOf
+    {
+        static constexpr unsigned size = c_kinds;
+        unsigned operator()(Key const& _k) const { return _k.kind; }
+    };
+
+    using Cache = ShardedLruCache<Key, std::shared_ptr<void const>, KeyHash, KindOf>;
+
+public:
+    using Stats = Cache::Stats;
+
+    explicit ChainCache(size_t _capacityBytes) : m_cache(_capacityBytes) {}
+
+    /// Copies the entry for @a _key of @a _kind into @a o_value, counting a hit or a miss.
+    /// @returns false if it isn't cached. The entry must have been inserted as a @a T.
+    template <class T>
+    bool lookup(h256 const& _key, unsigned _kind, T& o_value) const
+    {
+        std::shared_ptr<void const> value;
+        if (!m_cache.lookup(Key{_key, _kind}, value))
+            return false;
+        o_value = *std::static_pointer_cast<T const>(value);
+        return true;
+    }
+
+    /// Adds or replaces the entry for @a _key of @a _kind. @a _bytes is its encoded size.
+    template <class T>
+    void insert(h256 const& _key, unsigned _kind, T _value, size_t _bytes)
+    {
+        m_cache.insert(Key{_key, _kind}, std::make_shared<T const>(std::move(_value)),
+            _bytes + c_entryOverhead, true);
+    }
+
+    /// Same as insert(), but keeps an entry that is already cached. Meant for values just read
+    /// from the database, which may be older than one inserted concurrently by a writer.
+    template <class T>
+    void populate(h256 const& _key, unsigned _kind, T _value, size_t _bytes)
+    {
+        m_cache.insert(Key{_key, _kind}, std::make_shared<T const>(std::move(_value)),
+            _bytes + c_entryOverhead, false);
+    }
+
+    /// Same as lookup(), but neither moves the entry nor counts it.
+    bool contains(h256 const& _key, unsigned _kind) const
+    {
+        return m_cache.contains(Key{_key, _kind});
+    }
+    void erase(h256 const& _key, unsigned _kind) { m_cache.erase(Key{_key, _kind}); }
+    /// Drops every entry of @a _kind.
+    void clear(unsigned _kind) { m_cache.clear(_kind); }
+    void clear() { m_cache.clear(); }
+
+    size_t capacity() const noexcept { return m_cache.capacity(); }
+    Stats stats(unsigned _kind) const { return m_cache.stats(_kind); }
+    Stats stats() const { return m_cache.stats(); }
+
+private:
+    Cache m_cache;
+};
+
+}  // namespace eth
+}  // namespace dev
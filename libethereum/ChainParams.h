@@ -57,6 +57,11 @@ struct ChainParams: public ChainOperationParams
 	std::vector<p2p::NodeSpec> exnodes;
 	bool exnodesMe = false;
 	bool exnodesAnyone = false;
+	/// Qpos leaders propose the next block while the previous one is still being imported.
+	bool qposPipeline = false;
+	/// Qpos leaders propose blocks by transaction hashes. Nodes not knowing the compact packets
+	/// cannot vote on such proposals, so every miner has to be upgraded before this is turned on.
+	bool qposCompactProposals = false;
 private:
     void populateFromGenesis(bytes const& _genesisRLP, AccountMap const& _state);
 
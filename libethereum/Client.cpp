@@ -33,6 +33,8 @@ namespace
 constexpr unsigned c_syncMinBlockCount = 1;
 constexpr unsigned c_syncMaxBlockCount = 1000;
 constexpr double c_targetDurationS = 1;
+/// Blocks kept by stateView(). Each holds the block's state changes in memory.
+constexpr size_t c_maxStateViews = 8;
 
 std::string filtersToString(h256Hash const& _fs)
 {
@@ -126,6 +128,10 @@ void Client::init(p2p::Host& _extNet, fs::path const& _dbPath,
         auto ethCapability = make_shared<EthereumCapability>(
             _extNet.capabilityHost(), bc(), m_stateDB, m_tq, m_bq, _networkId);
         _extNet.registerCapability(ethCapability);
+        // Same handler, offered as the version with transaction hash announcements too; each
+        // peer gets the highest version both sides support.
+        _extNet.registerCapability(
+            ethCapability, ethCapability->name(), c_pooledTransactionsProtocolVersion);
         m_host = ethCapability;
     }
 
@@ -278,6 +284,10 @@ void Client::reopenChain(ChainParams const& _p, WithExisting _we)
         m_postSeal = Block(chainParams().accountStartNonce);
         m_working = Block(chainParams().accountStartNonce);
 
+        // Both hold on to the state DB.
+        DEV_GUARDED(x_stateViews)
+            m_stateViews.clear();
+        bc().stateCheckpoints().clear();
         m_stateDB = OverlayDB();
         bc().reopen(_p, _we);
         m_stateDB = State::openDB(db::databasePath(), bc().genesisHash(), _we);
@@ -395,8 +405,11 @@ void Client::syncBlockQueue()
 
     if (count)
     {
+        NodeCache::Stats const cache = m_stateDB.cacheStats();
         LOG(m_logger) << count << " blocks imported in " << unsigned(elapsed * 1000) << " ms ("
-                      << (count / elapsed) << " blocks/s) in #" << bc().number();
+                      << (count / elapsed) << " blocks/s) in #" << bc().number()
+                      << ", state node cache hit rate " << unsigned(cache.hitRate() * 100) << "% ("
+                      << cache.entries << " nodes, " << cache.bytes / 1024 << " KB)";
     }
 
     if (elapsed > c_targetDurationS * 1.1 && count > c_syncMinBlockCount)
@@ -801,6 +814,41 @@ Block Client::block(h256 const& _block) const
     }
 }
 
+shared_ptr<Block const> Client::stateView(BlockNumber _h) const
+{
+    // The pending block changes with every transaction; not worth keeping.
+    if (_h == PendingBlock)
+        return make_shared<Block const>(postSeal());
+    return stateView(_h == LatestBlock ? bc().currentHash() : bc().numberHash(_h));
+}
+
+shared_ptr<Block const> Client::stateView(h256 const& _blockHash) const
+{
+    if (!bc().isKnown(_blockHash))
+        return make_shared<Block const>(block(_blockHash));
+
+    {
+        Guard l(x_stateViews);
+        for (auto it = m_stateViews.begin(); it != m_stateViews.end(); ++it)
+            if (it->first == _blockHash)
+            {
+                m_stateViews.splice(m_stateViews.begin(), m_stateViews, it);
+                return it->second;
+            }
+    }
+
+    // Enacted without the lock; concurrent misses on the same block just do the work twice.
+    auto view = make_shared<Block const>(block(_blockHash));
+    Guard l(x_stateViews);
+    for (auto const& v : m_stateViews)
+        if (v.first == _blockHash)
+            return v.second;
+    m_stateViews.emplace_front(_blockHash, view);
+    if (m_stateViews.size() > c_maxStateViews)
+        m_stateViews.pop_back();
+    return view;
+}
+
 Block Client::block(h256 const& _blockHash, PopulationStatistics* o_stats) const
 {
     try
@@ -944,7 +992,7 @@ ExecutionResult Client::call(Address const& _from, u256 _value, Address _dest, b
     ExecutionResult ret;
     try
     {
-        Block temp = blockByNumber(_blockNumber);
+        Block temp(*stateView(_blockNumber));
         u256 nonce = max<u256>(temp.transactionsFrom(_from), m_tq.maxNonce(_from));
         u256 gas = _gas == Invalid256 ? gasLimitRemaining() : _gas;
         u256 gasPrice = _gasPrice == Invalid256 ? gasBidPrice() : _gasPrice;
@@ -121,6 +121,8 @@ public:
     /// Get some information on the transaction queue.
     TransactionQueue::Status transactionQueueStatus() const { return m_tq.status(); }
     TransactionQueue::Limits transactionQueueLimits() const { return m_tq.limits(); }
+    /// Get a transaction waiting in the queue by its hash, or a null one if it is not there.
+    Transaction queuedTransaction(h256 const& _txHash) const { return m_tq.transaction(_txHash); }
 
     /// Freeze worker thread and sync some of the block queue.
     std::tuple<ImportRoute, bool, unsigned> syncQueue(unsigned _max = 1);
@@ -187,6 +189,9 @@ public:
     void rewind(unsigned _n);
     /// Rescue the chain.
     void rescue() { bc().rescue(m_stateDB); }
+    /// Index the logs of the blocks imported before the log index was enabled.
+    /// Must not be called while blocks are being imported.
+    void rebuildLogIndex(ProgressCallback const& _progress) { bc().rebuildLogIndex(_progress); }
 
     std::unique_ptr<StateImporterFace> createStateImporter() { return dev::eth::createStateImporter(m_stateDB); }
     std::unique_ptr<BlockChainImporterFace> createBlockChainImporter() { return dev::eth::createBlockChainImporter(m_bc); }
@@ -197,6 +202,11 @@ public:
     Block block(h256 const& _block) const override;
     using ClientBase::block;
 
+    /// Past and latest blocks are kept by hash for a while, so that calls against the same block
+    /// don't enact it again each time.
+    std::shared_ptr<Block const> stateView(BlockNumber _h) const override;
+    std::shared_ptr<Block const> stateView(h256 const& _blockHash) const;
+
     /// should be called after the constructor of the most derived class finishes.
     void startWorking() { Worker::startWorking(); };
 
@@ -337,6 +347,8 @@ protected:
     mutable SharedMutex x_working;          ///< Lock on m_working.
     Block m_working;                        ///< The state of the client which we're sealing (i.e. it'll have all the rewards added), while we're actually working on it.
     BlockHeader m_sealingInfo;              ///< The header we're attempting to seal on (derived from m_postSeal).
+    mutable Mutex x_stateViews;             ///< Lock on m_stateViews.
+    mutable std::list<std::pair<h256, std::shared_ptr<Block const>>> m_stateViews;  ///< Blocks recently handed out by stateView(), most recent first.
     std::atomic<bool> m_remoteWorking = { false };          ///< Has the remote worker recently been reset?
     std::atomic<bool> m_needStateReset = { false };         ///< Need reset working state to premin on next sync
     std::chrono::system_clock::time_point m_lastGetWork;    ///< Is there an active and valid remote worker?
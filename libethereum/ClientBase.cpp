@@ -8,12 +8,27 @@
 #include "BlockChain.h"
 #include "Executive.h"
 #include "State.h"
+#include <libdevcore/ThreadPool.h>
 
 using namespace std;
 using namespace dev;
 using namespace dev::eth;
 
 static const int64_t c_maxGasEstimate = 50000000;
+/// Candidate blocks decoded in parallel before their logs are handed out.
+static const size_t c_logScanBatch = 256;
+
+namespace
+{
+bool ranOutOfGas(ExecutionResult const& _er)
+{
+    return _er.excepted == TransactionException::OutOfGas ||
+           _er.excepted == TransactionException::OutOfGasBase ||
+           _er.excepted == TransactionException::OutOfGasIntrinsic ||
+           _er.codeDeposit == CodeDeposit::Failed ||
+           _er.excepted == TransactionException::BadJumpDestination;
+}
+}  // namespace
 
 std::pair<u256, ExecutionResult> ClientBase::estimateGas(Address const& _from, u256 _value, Address _dest, bytes const& _data, int64_t _maxGas, u256 _gasPrice, BlockNumber _blockNumber, GasEstimationCallback const& _callback)
 {
@@ -23,45 +38,62 @@ std::pair<u256, ExecutionResult> ClientBase::estimateGas(Address const& _from, u
         if (upperBound == Invalid256 || upperBound > c_maxGasEstimate)
             upperBound = c_maxGasEstimate;
         int64_t lowerBound = Transaction::baseGasRequired(!_dest, &_data, EVMSchedule());
-        Block bk = blockByNumber(_blockNumber);
+        // Every probe starts from a copy of this, so the block is never enacted more than once.
+        shared_ptr<Block const> const bk = stateView(_blockNumber);
+        State const base(bk->state());
+        u256 const n = State(base).getNonce(_from);
         u256 gasPrice = _gasPrice == Invalid256 ? gasBidPrice() : _gasPrice;
-        ExecutionResult er;
-        ExecutionResult lastGood;
-        bool good = false;
-        while (upperBound != lowerBound)
-        {
-            int64_t mid = (lowerBound + upperBound) / 2;
-            u256 n = bk.transactionsFrom(_from);
+
+        auto execute = [&](int64_t _gas) {
             Transaction t;
             if (_dest)
-                t = Transaction(_value, gasPrice, mid, _dest, _data, n);
+                t = Transaction(_value, gasPrice, _gas, _dest, _data, n);
             else
-                t = Transaction(_value, gasPrice, mid, _data, n);
+                t = Transaction(_value, gasPrice, _gas, _data, n);
             t.forceSender(_from);
-            EnvInfo const env(bk.info(), bc().lastBlockHashes(), 0, mid);
-            State tempState(bk.state());
+            EnvInfo const env(bk->info(), bc().lastBlockHashes(), 0, _gas);
+            State tempState(base);
             tempState.addBalance(_from, (u256)(t.gas() * t.gasPrice() + t.value()));
-            er = tempState.execute(env, *bc().sealEngine(), t, Permanence::Reverted).first;
-			cdebug << "er.excepted=" << (int)er.excepted << ",upperBound=" << upperBound << ",lowerBound=" << lowerBound;
-            if (er.excepted == TransactionException::OutOfGas ||
-                er.excepted == TransactionException::OutOfGasBase ||
-                er.excepted == TransactionException::OutOfGasIntrinsic ||
-                er.codeDeposit == CodeDeposit::Failed ||
-                er.excepted == TransactionException::BadJumpDestination)
-                    lowerBound = lowerBound == mid ? upperBound : mid;
+            return tempState.execute(env, *bc().sealEngine(), t, Permanence::Reverted).first;
+        };
+
+        // Run once with all the gas allowed. If that fails nothing less will do; otherwise the
+        // gas it used bounds the answer from below, and with the 1/64 every call keeps back
+        // added it is usually enough already.
+        ExecutionResult er = execute(upperBound);
+        if (ranOutOfGas(er))
+        {
+            if (_callback)
+                _callback(GasEstimationProgress { upperBound, upperBound });
+            return make_pair(upperBound, er);
+        }
+        ExecutionResult lastGood = er;
+        int64_t const used = static_cast<int64_t>(er.gasUsed);
+        lowerBound = min(max(lowerBound, used), upperBound);
+        int64_t const spent = used + static_cast<int64_t>(min(er.gasRefunded, er.gasUsed));
+        int64_t mid = spent + spent / 63 + 1;
+        if (mid >= upperBound)
+            mid = (lowerBound + upperBound) / 2;
+
+        while (upperBound != lowerBound)
+        {
+            er = execute(mid);
+            cdebug << "er.excepted=" << (int)er.excepted << ",upperBound=" << upperBound << ",lowerBound=" << lowerBound;
+            if (ranOutOfGas(er))
+                lowerBound = lowerBound == mid ? upperBound : mid;
             else
             {
                 lastGood = er;
                 upperBound = upperBound == mid ? lowerBound : mid;
-                good = true;
             }
 
             if (_callback)
                 _callback(GasEstimationProgress { lowerBound, upperBound });
+            mid = (lowerBound + upperBound) / 2;
         }
         if (_callback)
             _callback(GasEstimationProgress { lowerBound, upperBound });
-        return make_pair(upperBound, good ? lastGood : er);
+        return make_pair(upperBound, lastGood);
     }
     catch (...)
     {
@@ -127,22 +159,33 @@ LocalisedLogEntries ClientBase::logs(unsigned _watchId) const
 }
 
 LocalisedLogEntries ClientBase::logs(LogFilter const& _f) const
+{
+    boost::optional<unsigned> cursor;
+    return logs(_f, 0, cursor);
+}
+
+LocalisedLogEntries ClientBase::logs(LogFilter const& _f, unsigned _limit, boost::optional<unsigned>& io_cursor) const
 {
     LocalisedLogEntries ret;
     unsigned begin = min(bc().number() + 1, (unsigned)numberFromHash(_f.latest()));
     unsigned end = min(bc().number(), min(begin, (unsigned)numberFromHash(_f.earliest())));
+    // Pending and reverted blocks only go into the first page.
+    bool const firstPage = !io_cursor;
     
     // Handle pending transactions differently as they're not on the block chain.
     if (begin > bc().number())
     {
-        Block temp = postSeal();
-        for (unsigned i = 0; i < temp.pending().size(); ++i)
+        if (firstPage)
         {
-            // Might have a transaction that contains a matching log.
-            TransactionReceipt const& tr = temp.receipt(i);
-            LogEntries le = _f.matches(tr);
-            for (unsigned j = 0; j < le.size(); ++j)
-                ret.insert(ret.begin(), LocalisedLogEntry(le[j]));
+            Block temp = postSeal();
+            for (unsigned i = 0; i < temp.pending().size(); ++i)
+            {
+                // Might have a transaction that contains a matching log.
+                TransactionReceipt const& tr = temp.receipt(i);
+                LogEntries le = _f.matches(tr);
+                for (unsigned j = 0; j < le.size(); ++j)
+                    ret.insert(ret.begin(), LocalisedLogEntry(le[j]));
+            }
         }
         begin = bc().number();
     }
@@ -154,7 +197,7 @@ LocalisedLogEntries ClientBase::logs(LogFilter const& _f) const
     unsigned ancestorIndex;
     tie(blocks, ancestor, ancestorIndex) = bc().treeRoute(_f.earliest(), _f.latest(), false);
 
-    for (size_t i = 0; i < ancestorIndex; i++)
+    for (size_t i = 0; firstPage && i < ancestorIndex; i++)
         prependLogsFromBlock(_f, blocks[i], BlockPolarity::Dead, ret);
 
     // cause end is our earliest block, let's compare it with our ancestor
@@ -170,36 +213,102 @@ LocalisedLogEntries ClientBase::logs(LogFilter const& _f) const
     // and we want to get all logs from 1 (ancestor + 1) to 3
     // so we have to move 2a to g + 1
     end = min(end, (unsigned)numberFromHash(ancestor) + 1);
+    reverse(ret.begin(), ret.end());
 
     // Handle blocks from main chain
-    set<unsigned> matchingBlocks;
-    if (!_f.isRangeFilter())
-        for (auto const& i: _f.bloomPossibilities())
-            for (auto u: bc().withBlockBloom(i, end, begin))
-                matchingBlocks.insert(u);
-    else
-        // if it is a range filter, we want to get all logs from all blocks in given range
-        for (unsigned i = end; i <= begin; i++)
-            matchingBlocks.insert(i);
-
-    for (auto n: matchingBlocks)
-        prependLogsFromBlock(_f, bc().numberHash(n), BlockPolarity::Live, ret);
+    if (!firstPage)
+        end = max(end, *io_cursor);
+    if (end > begin)
+    {
+        io_cursor = boost::none;
+        return ret;
+    }
 
-    reverse(ret.begin(), ret.end());
+    // Cut at block boundaries, but always take at least one block so that paging advances.
+    io_cursor = streamLogs(_f, end, begin, [&](LocalisedLogEntries const& _logs) {
+        if (_limit && !ret.empty() && ret.size() + _logs.size() > _limit)
+            return false;
+        ret.insert(ret.end(), _logs.begin(), _logs.end());
+        return true;
+    });
     return ret;
 }
 
-void ClientBase::prependLogsFromBlock(LogFilter const& _f, h256 const& _blockHash, BlockPolarity _polarity, LocalisedLogEntries& io_logs) const
+boost::optional<unsigned> ClientBase::streamLogs(LogFilter const& _f, unsigned _earliest, unsigned _latest, function<bool(LocalisedLogEntries const&)> const& _onBlock) const
+{
+    // Blocks covered by the log index are looked up there, the earlier ones through the blooms.
+    unsigned const indexed = _f.addresses().empty() ? _latest + 1 : max(_earliest, bc().logIndexFrom());
+
+    vector<unsigned> candidates;
+    if (_earliest < indexed && _f.isRangeFilter())
+        // Every block with logs at all.
+        candidates = bc().withBlockBloom([](LogBloom const& _b) { return !!_b; }, _earliest, _latest);
+    else if (_earliest < indexed)
+    {
+        vector<LogBloom> const possibilities = _f.bloomPossibilities();
+        candidates = bc().withBlockBloom([&](LogBloom const& _b) {
+            for (auto const& p: possibilities)
+                if (_b.contains(p))
+                    return true;
+            return false;
+        }, _earliest, min(_latest, indexed - 1));
+    }
+
+    if (indexed <= _latest)
+    {
+        set<unsigned> found;
+        h256Hash const anyTopic{h256()};
+        h256Hash const& topics = _f.topics(0).empty() ? anyTopic : _f.topics(0);
+        for (auto const& a: _f.addresses())
+            for (auto const& t: topics)
+                for (unsigned n: bc().withLogIndex(a, t, indexed, _latest))
+                    found.insert(n);
+        candidates.insert(candidates.end(), found.begin(), found.end());
+    }
+
+    for (size_t first = 0; first < candidates.size(); first += c_logScanBatch)
+    {
+        size_t const count = min(c_logScanBatch, candidates.size() - first);
+        vector<LocalisedLogEntries> batch(count);
+        ThreadPool::shared().parallelFor(count, [&](size_t _i) {
+            batch[_i] = logsFromBlock(_f, bc().numberHash(candidates[first + _i]), BlockPolarity::Live);
+            return true;
+        });
+
+        for (size_t i = 0; i < count; ++i)
+            if (!batch[i].empty() && !_onBlock(batch[i]))
+                return candidates[first + i];
+    }
+    return boost::none;
+}
+
+LocalisedLogEntries ClientBase::logsFromBlock(LogFilter const& _f, h256 const& _blockHash, BlockPolarity _polarity) const
 {
-    auto receipts = bc().receipts(_blockHash).receipts;
+    LocalisedLogEntries ret;
+    auto const receipts = bc().receipts(_blockHash).receipts;
+    // The block is only decoded once a receipt matches.
+    h256s hashes;
+    BlockNumber number = 0;
     for (size_t i = 0; i < receipts.size(); i++)
     {
-        TransactionReceipt receipt = receipts[i];
-        auto th = transaction(_blockHash, i).sha3();
-        LogEntries le = _f.matches(receipt);
+        LogEntries le = _f.matches(receipts[i]);
+        if (le.empty())
+            continue;
+        if (hashes.empty())
+        {
+            hashes = bc().transactionHashes(_blockHash);
+            number = bc().number(_blockHash);
+        }
         for (unsigned j = 0; j < le.size(); ++j)
-            io_logs.insert(io_logs.begin(), LocalisedLogEntry(le[j], _blockHash, (BlockNumber)bc().number(_blockHash), th, i, 0, _polarity));
+            ret.push_back(LocalisedLogEntry(le[j], _blockHash, number, i < hashes.size() ? hashes[i] : h256(), i, 0, _polarity));
     }
+    return ret;
+}
+
+void ClientBase::prependLogsFromBlock(LogFilter const& _f, h256 const& _blockHash, BlockPolarity _polarity, LocalisedLogEntries& io_logs) const
+{
+    LocalisedLogEntries const le = logsFromBlock(_f, _blockHash, _polarity);
+    io_logs.insert(io_logs.begin(), le.rbegin(), le.rend());
 }
 
 unsigned ClientBase::installWatch(LogFilter const& _f, Reaping _r)
@@ -507,6 +616,11 @@ Block ClientBase::blockByNumber(BlockNumber _h) const
     return block(bc().numberHash(_h));
 }
 
+shared_ptr<Block const> ClientBase::stateView(BlockNumber _h) const
+{
+    return make_shared<Block const>(blockByNumber(_h));
+}
+
 int ClientBase::chainId() const
 {
 	return bc().chainParams().chainID;
@@ -75,8 +75,17 @@ public:
 
     LocalisedLogEntries logs(unsigned _watchId) const override;
     LocalisedLogEntries logs(LogFilter const& _filter) const override;
+    LocalisedLogEntries logs(LogFilter const& _filter, unsigned _limit, boost::optional<unsigned>& io_cursor) const override;
     virtual void prependLogsFromBlock(LogFilter const& _filter, h256 const& _blockHash, BlockPolarity _polarity, LocalisedLogEntries& io_logs) const;
 
+    /// Hands the logs matching @a _filter in the canonical blocks [_earliest, _latest] to
+    /// @a _onBlock, one block at a time in ascending order. Candidate blocks come from the bloom
+    /// index, for range filters too, and are decoded in parallel.
+    /// @returns the first block @a _onBlock returned false for, or nothing if the range was exhausted.
+    boost::optional<unsigned> streamLogs(LogFilter const& _filter, unsigned _earliest, unsigned _latest, std::function<bool(LocalisedLogEntries const&)> const& _onBlock) const;
+    /// @returns the logs in block @a _blockHash matching @a _filter, in order.
+    LocalisedLogEntries logsFromBlock(LogFilter const& _filter, h256 const& _blockHash, BlockPolarity _polarity) const;
+
     /// Install, uninstall and query watches.
     unsigned installWatch(LogFilter const& _filter, Reaping _r = Reaping::Automatic) override;
     unsigned installWatch(h256 _filterId, Reaping _r = Reaping::Automatic) override;
@@ -149,6 +158,10 @@ public:
     }
 
     Block blockByNumber(BlockNumber _h) const;
+    /// @returns the state of block @a _h for read-only use, possibly shared with other callers.
+    /// Queries on its State fill the State's caches, so copy the State or the whole Block before
+    /// querying or executing on it.
+    virtual std::shared_ptr<Block const> stateView(BlockNumber _h) const;
 
     int chainId() const override;
 
@@ -39,6 +39,12 @@ char const* ethPacketTypeToString(EthSubprotocolPacketType _packetType)
         return "BlockBodies";
     case NewBlockPacket:
         return "NewBlock";
+    case NewPooledTransactionHashesPacket:
+        return "NewPooledTransactionHashes";
+    case GetPooledTransactionsPacket:
+        return "GetPooledTransactions";
+    case PooledTransactionsPacket:
+        return "PooledTransactions";
     case GetNodeDataPacket:
         return "GetNodeData";
     case NodeDataPacket:
@@ -27,6 +27,15 @@ static const unsigned c_maxBlocksAsk = 128;     ///< Maximum number of blocks we
 static const unsigned c_maxPayload = 262144;    ///< Maximum size of packet for us to send.
 static const unsigned c_maxNodes = c_maxBlocks; ///< Maximum number of nodes will ever send.
 static const unsigned c_maxReceipts = c_maxBlocks; ///< Maximum number of receipts will ever send.
+static const unsigned c_maxPooledTransactionsAsk = 256; ///< Maximum number of transactions we ask for in GetPooledTransactions.
+static const unsigned c_maxTransactionHashesAnnounce = 4096; ///< Maximum number of hashes we take from one NewPooledTransactionHashes.
+
+/// First eth version whose Status message carries the EIP-2124 fork id.
+static const unsigned c_forkIdProtocolVersion = 64;
+
+/// First eth version with transaction hash announcements (NewPooledTransactionHashes,
+/// GetPooledTransactions and PooledTransactions).
+static const unsigned c_pooledTransactionsProtocolVersion = 65;
 
 class BlockChain;
 class TransactionQueue;
@@ -43,6 +52,9 @@ enum EthSubprotocolPacketType : byte
     GetBlockBodiesPacket = 0x05,
     BlockBodiesPacket = 0x06,
     NewBlockPacket = 0x07,
+    NewPooledTransactionHashesPacket = 0x08,
+    GetPooledTransactionsPacket = 0x09,
+    PooledTransactionsPacket = 0x0a,
 
     GetNodeDataPacket = 0x0d,
     NodeDataPacket = 0x0e,
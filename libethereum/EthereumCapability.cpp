@@ -12,6 +12,7 @@
 #include <libp2p/Host.h>
 #include <libp2p/Session.h>
 #include <chrono>
+#include <cmath>
 #include <thread>
 
 using namespace std;
@@ -397,6 +398,7 @@ EthereumCapability::EthereumCapability(shared_ptr<p2p::CapabilityHostFace> _host
     m_tq(_tq),
     m_bq(_bq),
     m_networkId(_networkId),
+    m_forkIds(_ch.genesisHash(), _ch.chainParams()),
     m_hostData(new EthereumHostData(m_chain, m_db))
 {
     // TODO: Composition would be better. Left like that to avoid initialization
@@ -452,48 +454,75 @@ void EthereumCapability::completeSync()
 
 void EthereumCapability::maintainTransactions()
 {
-    // Send any new transactions.
-    unordered_map<NodeID, std::vector<size_t>> peerTransactions;
     auto ts = m_tq.topTransactions(c_maxSendTransactionsCount);
-    {
-        for (size_t i = 0; i < ts.size(); ++i)
-        {
-            auto const& t = ts[i];
-            bool unsent = !m_transactionsSent.count(t.sha3());
-
-            // Build list of peers to send transactions to
-            auto const peers = selectPeers([&](EthereumPeer const& _peer) {
-                return _peer.isWaitingForTransactions() ||
-                       (unsent && !_peer.isTransactionKnown(t.sha3()));
-            });
-            for (auto const& p: peers)
-                peerTransactions[p].push_back(i);
-        }
-        for (auto const& t: ts)
-            m_transactionsSent.insert(t.sha3());
-    }
-
-    // Send transactions to peers
+    vector<size_t> unsent;
+    for (size_t i = 0; i < ts.size(); ++i)
+        if (!m_transactionsSent.count(ts[i].sha3()))
+            unsent.push_back(i);
+
+    // Whole transactions go to a random sqrt(peers) of the peers and to those that can't take
+    // announcements; the rest are told the hashes and ask for what they miss.
+    vector<pair<NodeID const, EthereumPeer>*> peers;
+    peers.reserve(m_peers.size());
     for (auto& peer : m_peers)
+        peers.push_back(&peer);
+    shuffle(peers.begin(), peers.end(), m_urng);
+    size_t const fullPeers = max<size_t>(1, sqrt(peers.size()));
+
+    for (size_t k = 0; k < peers.size(); ++k)
     {
+        NodeID const& peerID = peers[k]->first;
+        EthereumPeer& peer = peers[k]->second;
+        bool const full = k < fullPeers || !peer.supportsPooledTransactions();
+
         bytes b;
         unsigned n = 0;
-        for (auto const& i : peerTransactions[peer.first])
+        h256s hashes;
+        if (peer.isWaitingForTransactions())
+            // Asked for everything we have, so it gets the bodies.
+            for (auto const& t : ts)
+            {
+                peer.markTransactionAsKnown(t.sha3());
+                b += t.rlp();
+                ++n;
+            }
+        else
+            for (auto i : unsent)
+            {
+                h256 const h = ts[i].sha3();
+                if (peer.isTransactionKnown(h))
+                    continue;
+                peer.markTransactionAsKnown(h);
+                if (full)
+                {
+                    b += ts[i].rlp();
+                    ++n;
+                }
+                else
+                    hashes.push_back(h);
+            }
+
+        if (n || peer.isWaitingForTransactions())
         {
-            peer.second.markTransactionAsKnown(ts[i].sha3());
-            b += ts[i].rlp();
-            ++n;
+            RLPStream s;
+            m_host->prep(peerID, name(), s, TransactionsPacket, n).appendRaw(b, n);
+            m_host->sealAndSend(peerID, s);
+            LOG(m_logger) << "Sent " << n << " transactions to " << peerID;
         }
-
-        if (n || peer.second.isWaitingForTransactions())
+        if (!hashes.empty())
         {
-            RLPStream ts;
-            m_host->prep(peer.first, name(), ts, TransactionsPacket, n).appendRaw(b, n);
-            m_host->sealAndSend(peer.first, ts);
-            LOG(m_logger) << "Sent " << n << " transactions to " << peer.first;
+            RLPStream s;
+            m_host->prep(peerID, name(), s, NewPooledTransactionHashesPacket, hashes.size());
+            for (auto const& h : hashes)
+                s << h;
+            m_host->sealAndSend(peerID, s);
+            LOG(m_logger) << "Announced " << hashes.size() << " transactions to " << peerID;
         }
-        peer.second.setWaitingForTransactions(false);
+        peer.setWaitingForTransactions(false);
     }
+
+    for (auto i : unsent)
+        m_transactionsSent.insert(ts[i].sha3());
 }
 
 vector<NodeID> EthereumCapability::selectPeers(
@@ -558,7 +587,7 @@ void EthereumCapability::maintainBlockHashes(h256 const& _currentHash)
         auto itPeer = m_peers.find(peerID);
         if (itPeer != m_peers.end())
         {
-            m_host->sealAndSend(peerID, ts);
+            m_host->sealAndSend(peerID, ts, p2p::PacketPriority::Urgent);
             itPeer->second.clearKnownBlocks();
         }
     }
@@ -608,6 +637,25 @@ void EthereumCapability::onTransactionImported(
     });
 }
 
+void EthereumCapability::requestPooledTransactions(EthereumPeer& _peer, h256s const& _hashes)
+{
+    for (size_t i = 0; i < _hashes.size(); i += c_maxPooledTransactionsAsk)
+        _peer.requestPooledTransactions(h256s(_hashes.begin() + i,
+            _hashes.begin() + min<size_t>(_hashes.size(), i + c_maxPooledTransactionsAsk)));
+}
+
+void EthereumCapability::requestPooledTransactions(
+    PooledTransactionFetcher::Retries const& _retries)
+{
+    for (auto const& retry : _retries)
+    {
+        // A peer that has gone meanwhile is left to time out like one that doesn't answer.
+        auto peer = m_peers.find(retry.first);
+        if (peer != m_peers.end())
+            requestPooledTransactions(peer->second, retry.second);
+    }
+}
+
 void EthereumCapability::onConnect(NodeID const& _peerID, u256 const& _peerCapabilityVersion)
 {
     m_host->addNote(_peerID, "manners", m_host->isRude(_peerID, name()) ? "RUDE" : "nice");
@@ -615,7 +663,7 @@ void EthereumCapability::onConnect(NodeID const& _peerID, u256 const& _peerCapab
     EthereumPeer peer{m_host, _peerID, _peerCapabilityVersion};
     m_peers.emplace(_peerID, peer);
     peer.requestStatus(m_networkId, m_chain.details().totalDifficulty, m_chain.currentHash(),
-        m_chain.genesisHash());
+        m_chain.genesisHash(), m_forkIds.at(m_chain.number()));
 }
 
 void EthereumCapability::onDisconnect(NodeID const& _peerID)
@@ -624,6 +672,8 @@ void EthereumCapability::onDisconnect(NodeID const& _peerID)
     m_peerObserver->onPeerAborting();
 
     m_peers.erase(_peerID);
+    requestPooledTransactions(
+        m_transactionFetcher.peerGone(_peerID, PooledTransactionFetcher::Clock::now()));
 }
 
 bool EthereumCapability::interpretCapabilityPacket(
@@ -647,13 +697,16 @@ bool EthereumCapability::interpretCapabilityPacket(
             auto const totalDifficulty = _r[2].toInt<u256>();
             auto const latestHash = _r[3].toHash<h256>();
             auto const genesisHash = _r[4].toHash<h256>();
+            boost::optional<ForkId> forkId;
+            if (peerProtocolVersion >= c_forkIdProtocolVersion && _r.itemCount() > 5)
+                forkId = ForkId::fromRLP(_r[5]);
 
             LOG(m_logger) << "Status (from " << _peerID << "): " << peerProtocolVersion << " / "
                           << networkId << " / " << genesisHash << ", TD: " << totalDifficulty
                           << " = " << latestHash;
 
             peer.setStatus(
-                peerProtocolVersion, networkId, totalDifficulty, latestHash, genesisHash);
+                peerProtocolVersion, networkId, totalDifficulty, latestHash, genesisHash, forkId);
             setIdle(_peerID);
             m_peerObserver->onPeerStatus(peer);
             break;
@@ -663,6 +716,59 @@ bool EthereumCapability::interpretCapabilityPacket(
             m_peerObserver->onPeerTransactions(_peerID, _r);
             break;
         }
+        case NewPooledTransactionHashesPacket:
+        {
+            unsigned itemCount = _r.itemCount();
+            if (itemCount > c_maxTransactionHashesAnnounce)
+            {
+                LOG(m_logger) << "Received too many transaction hashes (" << itemCount
+                              << ") from " << _peerID << ", only processing first "
+                              << c_maxTransactionHashesAnnounce;
+                itemCount = c_maxTransactionHashesAnnounce;
+            }
+
+            h256s unknown;
+            for (unsigned i = 0; i < itemCount; ++i)
+            {
+                auto const h = _r[i].toHash<h256>();
+                peer.markTransactionAsKnown(h);
+                if (!m_tq.isKnown(h))
+                    unknown.push_back(h);
+            }
+            h256s const wanted = m_transactionFetcher.request(
+                _peerID, unknown, PooledTransactionFetcher::Clock::now());
+            requestPooledTransactions(peer, wanted);
+            LOG(m_loggerDetail) << "Transaction hashes (" << itemCount << " entries, "
+                                << wanted.size() << " requested) from " << _peerID;
+            break;
+        }
+        case GetPooledTransactionsPacket:
+        {
+            unsigned const count = min<unsigned>(_r.itemCount(), c_maxPooledTransactionsAsk);
+            bytes b;
+            unsigned n = 0;
+            for (unsigned i = 0; i < count && b.size() < c_maxPayload; ++i)
+            {
+                // Transactions that have left the pool meanwhile are left out.
+                Transaction const t = m_tq.transaction(_r[i].toHash<h256>());
+                if (!t)
+                    continue;
+                b += t.rlp();
+                ++n;
+            }
+            RLPStream s;
+            m_host->prep(_peerID, name(), s, PooledTransactionsPacket, n).appendRaw(b, n);
+            m_host->sealAndSend(_peerID, s);
+            m_host->updateRating(_peerID, 0);
+            break;
+        }
+        case PooledTransactionsPacket:
+        {
+            for (auto const& tx : _r)
+                m_transactionFetcher.delivered(sha3(tx.data()));
+            m_peerObserver->onPeerTransactions(_peerID, _r);
+            break;
+        }
         case GetBlockHeadersPacket:
         {
             /// Packet layout:
@@ -873,6 +979,9 @@ void EthereumCapability::doBackgroundWork()
     if (now - m_lastTick >= 1)
     {
         m_lastTick = now;
+        requestPooledTransactions(
+            m_transactionFetcher.expire(PooledTransactionFetcher::Clock::now()));
+        m_sync->rescheduleStalledBodies();
         for (auto const& peer : m_peers)
         {
             time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
@@ -986,7 +1095,7 @@ void EthereumCapability::propagateNewBlocks(std::shared_ptr<VerifiedBlocks const
                 auto itPeer = m_peers.find(peerID);
                 if (itPeer != m_peers.end())
                 {
-                    m_host->sealAndSend(peerID, ts);
+                    m_host->sealAndSend(peerID, ts, p2p::PacketPriority::Urgent);
                     // We don't want to send new block hashes to these same peers
                     itPeer->second.markBlockAsKnown(b.verified.info.hash());
                 }
@@ -5,6 +5,7 @@
 
 #include "CommonNet.h"
 #include "EthereumPeer.h"
+#include "PooledTransactionFetcher.h"
 #include <libdevcore/Guards.h>
 #include <libdevcore/OverlayDB.h>
 #include <libethcore/BlockHeader.h>
@@ -100,6 +101,8 @@ public:
 
     unsigned protocolVersion() const { return c_protocolVersion; }
     u256 networkId() const { return m_networkId; }
+    /// Fork ids of our chain, sent and checked in the Status exchange.
+    ForkIds const& forkIds() const { return m_forkIds; }
     void setNetworkId(u256 _n) { m_networkId = _n; }
 
     void reset();
@@ -162,6 +165,11 @@ private:
     void maintainBlockHashes(h256 const& _currentBlock);
     void onTransactionImported(ImportResult _ir, h256 const& _h, h512 const& _nodeId);
 
+    /// Asks @a _peer for the pooled transactions @a _hashes, in as many packets as needed.
+    void requestPooledTransactions(EthereumPeer& _peer, h256s const& _hashes);
+    /// Sends the requests the transaction fetcher moved to other peers.
+    void requestPooledTransactions(PooledTransactionFetcher::Retries const& _retries);
+
     /// Initialises the network peer-state, doing the stuff that needs to be once-only. @returns true if it really was first.
     bool ensureInitialised();
 
@@ -182,6 +190,7 @@ private:
     BlockQueue& m_bq;						///< Maintains a list of incoming blocks not yet on the blockchain (to be imported).
 
     u256 m_networkId;
+    ForkIds const m_forkIds;
 
     // We need to keep track of sent blocks and block hashes separately since we propagate new
     // blocks after we've verified their PoW (and a few other things i.e. they've been imported into
@@ -190,6 +199,8 @@ private:
     h256 m_latestBlockHashSent;
     h256 m_latestBlockSent;
     h256Hash m_transactionsSent;
+    /// Transactions asked from peers after they announced them.
+    PooledTransactionFetcher m_transactionFetcher;
 
     std::atomic<bool> m_newTransactions = {false};
     std::atomic<bool> m_newBlocks = {false};
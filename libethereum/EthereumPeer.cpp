@@ -41,29 +41,35 @@ string toString(Asking _a)
 }  // namespace
 
 void EthereumPeer::setStatus(unsigned _protocolVersion, u256 const& _networkId,
-    u256 const& _totalDifficulty, h256 const& _latestHash, h256 const& _genesisHash)
+    u256 const& _totalDifficulty, h256 const& _latestHash, h256 const& _genesisHash,
+    boost::optional<ForkId> const& _forkId)
 {
     m_protocolVersion = _protocolVersion;
     m_networkId = _networkId;
     m_totalDifficulty = _totalDifficulty;
     m_latestHash = _latestHash;
     m_genesisHash = _genesisHash;
+    m_forkId = _forkId;
 }
 
 
-std::string EthereumPeer::validate(
-    h256 const& _hostGenesisHash, unsigned _hostProtocolVersion, u256 const& _hostNetworkId) const
+std::string EthereumPeer::validate(h256 const& _hostGenesisHash, u256 const& _hostNetworkId,
+    ForkIds const& _hostForkIds, uint64_t _hostHead) const
 {
     std::stringstream error;
     if (m_networkId != _hostNetworkId)
         error << "Network identifier mismatch. Host network id: " << _hostNetworkId
               << ", peer network id: " << m_networkId;
-    else if (m_protocolVersion != _hostProtocolVersion)
-        error << "Protocol version mismatch. Host protocol version: " << _hostProtocolVersion
+    else if (m_protocolVersion != m_capabilityVersion)
+        error << "Protocol version mismatch. Host protocol version: " << m_capabilityVersion
               << ", peer protocol version: " << m_protocolVersion;
     else if (m_genesisHash != _hostGenesisHash)
         error << "Genesis hash mismatch. Host genesis hash: " << _hostGenesisHash.abridged()
               << ", peer genesis hash: " << m_genesisHash.abridged();
+    else if (m_protocolVersion >= c_forkIdProtocolVersion && !m_forkId)
+        error << "Fork id missing from status.";
+    else if (m_protocolVersion >= c_forkIdProtocolVersion)
+        error << _hostForkIds.check(*m_forkId, _hostHead);
     else if (m_asking != Asking::State && m_asking != Asking::Nothing)
         error << "Peer banned for unexpected status message.";
 
@@ -71,15 +77,19 @@ std::string EthereumPeer::validate(
 }
 
 void EthereumPeer::requestStatus(
-    u256 _hostNetworkId, u256 _chainTotalDifficulty, h256 _chainCurrentHash, h256 _chainGenesisHash)
+    u256 _hostNetworkId, u256 _chainTotalDifficulty, h256 _chainCurrentHash, h256 _chainGenesisHash,
+    ForkId const& _forkId)
 {
     assert(m_asking == Asking::Nothing);
     setAsking(Asking::State);
     m_requireTransactions = true;
+    bool const withForkId = m_capabilityVersion >= c_forkIdProtocolVersion;
     RLPStream s;
-    m_host->prep(m_id, c_ethCapability, s, StatusPacket, 5)
-        << c_protocolVersion << _hostNetworkId << _chainTotalDifficulty << _chainCurrentHash
+    m_host->prep(m_id, c_ethCapability, s, StatusPacket, withForkId ? 6 : 5)
+        << m_capabilityVersion << _hostNetworkId << _chainTotalDifficulty << _chainCurrentHash
         << _chainGenesisHash;
+    if (withForkId)
+        _forkId.streamRLP(s);
     m_host->sealAndSend(m_id, s);
 }
 
@@ -133,6 +143,15 @@ void EthereumPeer::requestReceipts(h256s const& _blocks)
     requestByHashes(_blocks, Asking::Receipts, GetReceiptsPacket);
 }
 
+void EthereumPeer::requestPooledTransactions(h256s const& _hashes)
+{
+    RLPStream s;
+    m_host->prep(m_id, c_ethCapability, s, GetPooledTransactionsPacket, _hashes.size());
+    for (auto const& h : _hashes)
+        s << h;
+    m_host->sealAndSend(m_id, s);
+}
+
 void EthereumPeer::requestByHashes(
     h256s const& _hashes, Asking _asking, EthSubprotocolPacketType _packetType)
 {
@@ -4,6 +4,9 @@
 #pragma once
 
 #include "CommonNet.h"
+#include "ForkId.h"
+
+#include <boost/optional.hpp>
 
 namespace dev
 {
@@ -19,8 +22,10 @@ class EthereumPeer
 public:
     EthereumPeer() = default;
     EthereumPeer(std::shared_ptr<p2p::CapabilityHostFace> _host, NodeID const& _peerID,
-        u256 const& /*_capabilityVersion*/)
-      : m_host(std::move(_host)), m_id(_peerID)
+        u256 const& _capabilityVersion)
+      : m_host(std::move(_host)),
+        m_id(_peerID),
+        m_capabilityVersion(static_cast<unsigned>(_capabilityVersion))
     {
         m_logger.add_attribute(
             "Suffix", boost::log::attributes::constant<std::string>{m_id.abridged()});
@@ -29,13 +34,24 @@ public:
     bool statusReceived() const { return m_protocolVersion != 0; }
 
     void setStatus(unsigned _protocolVersion, u256 const& _networkId, u256 const& _totalDifficulty,
-        h256 const& _latestHash, h256 const& _genesisHash);
+        h256 const& _latestHash, h256 const& _genesisHash,
+        boost::optional<ForkId> const& _forkId = boost::none);
 
-    std::string validate(h256 const& _hostGenesisHash, unsigned _hostProtocolVersion,
-        u256 const& _hostNetworkId) const;
+    /// Checks the peer's status against ours. The protocol version must be the one negotiated
+    /// for the session, and from eth/64 on the fork id must fit our chain at @a _hostHead.
+    std::string validate(h256 const& _hostGenesisHash, u256 const& _hostNetworkId,
+        ForkIds const& _hostForkIds, uint64_t _hostHead) const;
 
     NodeID id() const { return m_id; }
 
+    /// Version of the eth protocol negotiated with the peer.
+    unsigned capabilityVersion() const { return m_capabilityVersion; }
+    /// Can the peer be sent transaction hashes instead of whole transactions?
+    bool supportsPooledTransactions() const
+    {
+        return m_capabilityVersion >= c_pooledTransactionsProtocolVersion;
+    }
+
     u256 totalDifficulty() const { return m_totalDifficulty; }
 
     time_t lastAsk() const { return m_lastAsk; }
@@ -61,8 +77,9 @@ public:
     unsigned unknownNewBlocks() const { return m_unknownNewBlocks; }
     void incrementUnknownNewBlocks() { ++m_unknownNewBlocks; }
 
+    /// Sends our Status; @a _forkId goes along if the negotiated version has it.
     void requestStatus(u256 _hostNetworkId, u256 _chainTotalDifficulty, h256 _chainCurrentHash,
-        h256 _chainGenesPeersh);
+        h256 _chainGenesPeersh, ForkId const& _forkId);
 
     /// Request hashes for given parent hash.
     void requestBlockHeaders(
@@ -78,6 +95,10 @@ public:
     /// Request receipts for specified blocks from peer.
     void requestReceipts(h256s const& _blocks);
 
+    /// Request the transactions with the given hashes from the peer's pool. Unlike the requests
+    /// above it doesn't take part in syncing, so it leaves asking() alone.
+    void requestPooledTransactions(h256s const& _hashes);
+
 private:
     // Request of type _packetType with _hashes as input parameters
     void requestByHashes(
@@ -86,6 +107,7 @@ private:
     std::shared_ptr<p2p::CapabilityHostFace> m_host;
 
     NodeID const m_id;
+    unsigned const m_capabilityVersion = 0;
 
     /// What, if anything, we last asked the other peer for.
     Asking m_asking = Asking::Nothing;
@@ -101,6 +123,7 @@ private:
     /// Peer's latest block's total difficulty.
     u256 m_totalDifficulty;
     h256 m_genesisHash;  ///< Peer's genesis hash
+    boost::optional<ForkId> m_forkId;  ///< Peer's fork id, from eth/64 on
     /// Have we received a GetTransactions packet that we haven't yet answered?
     bool m_requireTransactions = false;
 
@@ -17,8 +17,6 @@
 
 #include <json/json.h>
 
-#include <numeric>
-
 using namespace std;
 using namespace dev;
 using namespace dev::eth;
@@ -151,7 +149,10 @@ void StandardTrace::operator()(uint64_t _steps, uint64_t PC, Instruction inst, b
     if (!!newMemSize)
         r["memexpand"] = toString(newMemSize);
 
-    m_trace.append(r);
+    if (m_out)
+        *m_out << m_writer.write(r);
+    else
+        m_trace.append(r);
 }
 
 std::string StandardTrace::styledJson() const
@@ -161,13 +162,12 @@ std::string StandardTrace::styledJson() const
 
 string StandardTrace::multilineTrace() const
 {
-    if (m_trace.empty())
-        return {};
-
     // Each opcode trace on a separate line
-    return std::accumulate(std::next(m_trace.begin()), m_trace.end(),
-        Json::FastWriter().write(m_trace[0]),
-        [](std::string a, Json::Value b) { return a + Json::FastWriter().write(b); });
+    Json::FastWriter writer;
+    string ret;
+    for (auto const& step : m_trace)
+        ret += writer.write(step);
+    return ret;
 }
 
 Executive::Executive(Block& _s, BlockChain const& _bc, unsigned _level)
@@ -12,6 +12,7 @@
 
 #include <json/json.h>
 #include <functional>
+#include <ostream>
 
 namespace Json
 {
@@ -50,8 +51,14 @@ public:
 
     void setShowMnemonics() { m_showMnemonics = true; }
     void setOptions(DebugOptions _options) { m_options = _options; }
-
-    Json::Value jsonValue() const { return m_trace; }
+    /// Writes each step to @a _out as a line of JSON as soon as it's taken instead of collecting
+    /// the steps, so that a long trace doesn't build up a tree in memory. The output is that of
+    /// multilineTrace().
+    void setOutput(std::ostream& _out) { m_out = &_out; }
+
+    Json::Value const& jsonValue() const { return m_trace; }
+    /// Exchanges the collected steps with @a io_trace, saving a copy of a large trace.
+    void swapJsonValue(Json::Value& io_trace) { m_trace.swap(io_trace); }
     std::string styledJson() const;
     std::string multilineTrace() const;
 
@@ -68,6 +75,8 @@ private:
     std::vector<Instruction> m_lastInst;
     Json::Value m_trace;
     DebugOptions m_options;
+    std::ostream* m_out = nullptr;
+    Json::FastWriter m_writer;
 };
 
 /**
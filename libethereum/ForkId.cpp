@@ -0,0 +1,113 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "ForkId.h"
+
+#include <libethcore/ChainOperationParams.h>
+
+#include <boost/crc.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+void ForkId::streamRLP(RLPStream& _s) const
+{
+    _s.appendList(2) << FixedHash<4>(hash).asBytes() << next;
+}
+
+ForkId ForkId::fromRLP(RLP const& _r)
+{
+    if (!_r.isList() || _r.itemCount() != 2 || _r[0].size() != 4)
+        BOOST_THROW_EXCEPTION(BadRLP());
+    ForkId id;
+    id.hash = fromBigEndian<uint32_t>(_r[0].toBytesConstRef());
+    id.next = _r[1].toInt<uint64_t>(RLP::VeryStrict);
+    return id;
+}
+
+ostream& dev::eth::operator<<(ostream& _out, ForkId const& _id)
+{
+    ostringstream s;
+    s << hex << setfill('0') << setw(8) << _id.hash;
+    return _out << "0x" << s.str() << "/" << _id.next;
+}
+
+ForkIds::ForkIds(h256 const& _genesisHash, vector<uint64_t> _forks) : m_forks(move(_forks))
+{
+    sort(m_forks.begin(), m_forks.end());
+    m_forks.erase(unique(m_forks.begin(), m_forks.end()), m_forks.end());
+    m_forks.erase(remove(m_forks.begin(), m_forks.end(), 0), m_forks.end());
+
+    boost::crc_32_type crc;
+    crc.process_bytes(_genesisHash.data(), h256::size);
+    m_hashes.push_back(crc.checksum());
+    for (auto fork : m_forks)
+    {
+        bytes number(sizeof(fork));
+        toBigEndian(fork, number);
+        crc.process_bytes(number.data(), number.size());
+        m_hashes.push_back(crc.checksum());
+    }
+}
+
+namespace
+{
+vector<uint64_t> forkBlocks(ChainOperationParams const& _params)
+{
+    vector<uint64_t> forks;
+    for (u256 const& block :
+        {_params.homesteadForkBlock, _params.daoHardforkBlock, _params.EIP150ForkBlock,
+            _params.EIP158ForkBlock, _params.byzantiumForkBlock, _params.constantinopleForkBlock,
+            _params.constantinopleFixForkBlock, _params.istanbulForkBlock,
+            _params.berlinForkBlock})
+        if (block < c_infiniteBlockNumber)
+            forks.push_back(static_cast<uint64_t>(block));
+    return forks;
+}
+}  // namespace
+
+ForkIds::ForkIds(h256 const& _genesisHash, ChainOperationParams const& _params)
+  : ForkIds(_genesisHash, forkBlocks(_params))
+{}
+
+ForkId ForkIds::at(uint64_t _head) const
+{
+    size_t const passed = upper_bound(m_forks.begin(), m_forks.end(), _head) - m_forks.begin();
+    return {m_hashes[passed], passed < m_forks.size() ? m_forks[passed] : 0};
+}
+
+string ForkIds::check(ForkId const& _remote, uint64_t _head) const
+{
+    size_t const passed = upper_bound(m_forks.begin(), m_forks.end(), _head) - m_forks.begin();
+    stringstream error;
+    if (m_hashes[passed] == _remote.hash)
+    {
+        // Same forks passed; the peer must not expect a fork we have already gone past.
+        if (_remote.next != 0 && _head >= _remote.next)
+            error << "Fork id mismatch. Peer expects a fork at block " << _remote.next
+                  << ", which we passed without it.";
+        return error.str();
+    }
+    for (size_t i = 0; i < passed; ++i)
+        if (m_hashes[i] == _remote.hash)
+        {
+            // The peer is behind; it must at least know the fork it is going to pass next.
+            if (_remote.next != m_forks[i])
+                error << "Fork id mismatch. Peer " << _remote << " is missing the fork at block "
+                      << m_forks[i] << ".";
+            return error.str();
+        }
+    // We are behind the peer.
+    for (size_t i = passed + 1; i < m_hashes.size(); ++i)
+        if (m_hashes[i] == _remote.hash)
+            return {};
+
+    error << "Fork id mismatch. Host fork id: " << at(_head) << ", peer fork id: " << _remote;
+    return error.str();
+}
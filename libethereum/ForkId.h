@@ -0,0 +1,67 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#pragma once
+
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/RLP.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dev
+{
+namespace eth
+{
+struct ChainOperationParams;
+
+/// Identifies the forks a node has passed and the next one it knows of (EIP-2124). Sent in the
+/// Status message from eth/64 on.
+struct ForkId
+{
+    /// CRC32 of the genesis hash and the block numbers of the passed forks.
+    uint32_t hash = 0;
+    /// Block number of the next fork, 0 if none is known.
+    uint64_t next = 0;
+
+    bool operator==(ForkId const& _other) const
+    {
+        return hash == _other.hash && next == _other.next;
+    }
+    bool operator!=(ForkId const& _other) const { return !operator==(_other); }
+
+    void streamRLP(RLPStream& _s) const;
+    /// @throws RLPException if @a _r is not a fork id.
+    static ForkId fromRLP(RLP const& _r);
+};
+
+std::ostream& operator<<(std::ostream& _out, ForkId const& _id);
+
+/// The fork ids of one chain.
+class ForkIds
+{
+public:
+    /// @param _forks block numbers of the forks in any order; duplicates and forks at genesis are
+    /// skipped.
+    ForkIds(h256 const& _genesisHash, std::vector<uint64_t> _forks);
+    ForkIds(h256 const& _genesisHash, ChainOperationParams const& _params);
+
+    /// @returns the fork id of the chain with head number @a _head.
+    ForkId at(uint64_t _head) const;
+
+    /// Checks whether a peer sending @a _remote can be on the same chain as we are with head
+    /// number @a _head: either both have passed the same forks and we haven't passed the one it
+    /// expects next, or one of us is still syncing towards forks the other has passed.
+    /// @returns an empty string if so, the reason otherwise.
+    std::string check(ForkId const& _remote, uint64_t _head) const;
+
+private:
+    std::vector<uint64_t> m_forks;
+    /// m_hashes[i] is the fork hash after the first i forks.
+    std::vector<uint32_t> m_hashes;
+};
+
+}  // namespace eth
+}  // namespace dev
@@ -14,6 +14,7 @@
 #include "LogFilter.h"
 #include "Transaction.h"
 #include "BlockDetails.h"
+#include <boost/optional.hpp>
 
 namespace dev
 {
@@ -111,6 +112,11 @@ public:
 	
 	virtual LocalisedLogEntries logs(unsigned _watchId) const = 0;
 	virtual LocalisedLogEntries logs(LogFilter const& _filter) const = 0;
+	/// Same as above, one page at a time. Pages hold whole blocks: a block is left to the next page
+	/// if it would take the page over @a _limit entries (0 for no cap), unless it is the first one.
+	/// @a io_cursor is empty for the first page and is set to the block the next page starts at,
+	/// or emptied after the last page.
+	virtual LocalisedLogEntries logs(LogFilter const& _filter, unsigned _limit, boost::optional<unsigned>& io_cursor) const = 0;
 
 	/// Install, uninstall and query watches.
 	virtual unsigned installWatch(LogFilter const& _filter, Reaping _r = Reaping::Automatic) = 0;
@@ -52,6 +52,11 @@ public:
 	/// @returns bloom possibilities for all addresses and topics
 	std::vector<LogBloom> bloomPossibilities() const;
 
+	/// Addresses to match; empty matches every address.
+	AddressHash const& addresses() const { return m_addresses; }
+	/// Topics to match at position @a _index; empty matches any topic.
+	h256Hash const& topics(unsigned _index) const { return m_topics[_index]; }
+
 	bool matches(LogBloom _bloom) const;
 	bool matches(Block const& _b, unsigned _i) const;
 	LogEntries matches(TransactionReceipt const& _r) const;
@@ -0,0 +1,74 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "PooledTransactionFetcher.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+constexpr chrono::seconds::rep PooledTransactionFetcher::c_requestTimeout;
+
+h256s PooledTransactionFetcher::request(
+    p2p::NodeID const& _peer, h256s const& _announced, Clock::time_point _now)
+{
+    h256s ret;
+    for (auto const& hash : _announced)
+    {
+        auto it = m_requests.find(hash);
+        if (it == m_requests.end())
+        {
+            m_requests.emplace(hash, Request{_peer, _now, {}});
+            ret.push_back(hash);
+        }
+        else if (it->second.peer != _peer &&
+                 find(it->second.announcers.begin(), it->second.announcers.end(), _peer) ==
+                     it->second.announcers.end())
+            it->second.announcers.push_back(_peer);
+    }
+    return ret;
+}
+
+PooledTransactionFetcher::Retries PooledTransactionFetcher::peerGone(
+    p2p::NodeID const& _peer, Clock::time_point _now)
+{
+    Retries retries;
+    for (auto it = m_requests.begin(); it != m_requests.end();)
+    {
+        auto& announcers = it->second.announcers;
+        announcers.erase(remove(announcers.begin(), announcers.end(), _peer), announcers.end());
+        if (it->second.peer == _peer)
+            it = retry(it, _now, retries);
+        else
+            ++it;
+    }
+    return retries;
+}
+
+PooledTransactionFetcher::Retries PooledTransactionFetcher::expire(Clock::time_point _now)
+{
+    Retries retries;
+    for (auto it = m_requests.begin(); it != m_requests.end();)
+        if (_now - it->second.time >= chrono::seconds(c_requestTimeout))
+            it = retry(it, _now, retries);
+        else
+            ++it;
+    return retries;
+}
+
+unordered_map<h256, PooledTransactionFetcher::Request>::iterator PooledTransactionFetcher::retry(
+    unordered_map<h256, Request>::iterator _it, Clock::time_point _now, Retries& o_retries)
+{
+    Request& request = _it->second;
+    if (request.announcers.empty())
+        return m_requests.erase(_it);
+
+    request.peer = request.announcers.front();
+    request.announcers.pop_front();
+    request.time = _now;
+    o_retries[request.peer].push_back(_it->first);
+    return next(_it);
+}
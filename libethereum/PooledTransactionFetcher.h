@@ -0,0 +1,68 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#pragma once
+
+#include <libdevcore/FixedHash.h>
+#include <libp2p/Common.h>
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <unordered_map>
+
+namespace dev
+{
+namespace eth
+{
+/// Picks which of the transactions announced by hash to ask the announcing peer for, so that a
+/// transaction announced by many peers is asked from one of them at a time. The other peers
+/// announcing it are remembered in order; when the peer asked leaves or doesn't answer within
+/// c_requestTimeout, the transaction is asked from the next of them.
+/// Not thread-safe; lives on the network thread with EthereumCapability.
+class PooledTransactionFetcher
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    /// Hashes to ask from each peer.
+    using Retries = std::map<p2p::NodeID, h256s>;
+
+    static constexpr std::chrono::seconds::rep c_requestTimeout = 5;
+
+    /// @returns the hashes out of @a _announced that aren't being asked from any peer, now noted
+    /// as asked from @a _peer. @a _peer is kept as an announcer of the others.
+    h256s request(p2p::NodeID const& _peer, h256s const& _announced, Clock::time_point _now);
+
+    /// Notes that the transaction with hash @a _hash has arrived from any peer.
+    void delivered(h256 const& _hash) { m_requests.erase(_hash); }
+
+    /// Forgets @a _peer as an announcer and moves what was asked from it to the next announcers.
+    /// @returns the requests to send to them.
+    Retries peerGone(p2p::NodeID const& _peer, Clock::time_point _now);
+
+    /// Moves requests made longer than c_requestTimeout before @a _now to the next announcers;
+    /// those without one are forgotten. @returns the requests to send to them.
+    Retries expire(Clock::time_point _now);
+
+    size_t inFlight() const { return m_requests.size(); }
+
+private:
+    struct Request
+    {
+        p2p::NodeID peer;
+        Clock::time_point time;
+        /// Peers that announced the transaction too, not asked yet.
+        std::deque<p2p::NodeID> announcers;
+    };
+
+    /// Asks the next announcer of @a _hash, or forgets the request if there is none.
+    /// @returns the iterator past the request.
+    std::unordered_map<h256, Request>::iterator retry(
+        std::unordered_map<h256, Request>::iterator _it, Clock::time_point _now, Retries& o_retries);
+
+    std::unordered_map<h256, Request> m_requests;
+};
+
+}  // namespace eth
+}  // namespace dev
@@ -0,0 +1,299 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "SnapshotExporter.h"
+#include "BlockChain.h"
+
+#include <libdevcore/CommonIO.h>
+#include <libdevcore/OverlayDB.h>
+#include <libdevcore/RLP.h>
+#include <libdevcore/SHA3.h>
+#include <libdevcore/ThreadPool.h>
+#include <libdevcore/TrieDB.h>
+#include <libethcore/Exceptions.h>
+
+#include <snappy.h>
+
+namespace fs = boost::filesystem;
+
+namespace dev
+{
+namespace eth
+{
+namespace
+{
+/// Room left in a chunk for the parts of an account entry other than its code and storage.
+size_t const c_accountEntryOverhead = 128;
+
+/// Collects the RLP items of one chunk.
+struct ChunkBuilder
+{
+    bytes body;
+    size_t items = 0;
+
+    void append(bytesConstRef _item)
+    {
+        body.insert(body.end(), _item.begin(), _item.end());
+        ++items;
+    }
+
+    bytes take(bytesConstRef _prefix = {}, size_t _prefixItems = 0)
+    {
+        RLPStream s(_prefixItems + items);
+        if (_prefixItems)
+            s.appendRaw(_prefix, _prefixItems);
+        if (items)
+            s.appendRaw(body, items);
+        body.clear();
+        items = 0;
+        return s.out();
+    }
+};
+}  // namespace
+
+constexpr size_t SnapshotExporter::c_defaultChunkSize;
+constexpr unsigned SnapshotExporter::c_defaultBlockCount;
+
+SnapshotExporter::SnapshotExporter(fs::path const& _snapshotDir, size_t _chunkSize)
+  : m_snapshotDir(_snapshotDir), m_chunkSize(_chunkSize)
+{
+    fs::create_directories(m_snapshotDir);
+}
+
+SnapshotExporter::~SnapshotExporter()
+{
+    // Chunk writes refer to this object; errors were either reported already or don't matter.
+    UniqueGuard l(x_chunks);
+    m_chunkDone.wait(l, [this]() { return m_chunksInFlight == 0; });
+}
+
+void SnapshotExporter::exportSnapshot(
+    BlockChain const& _bc, OverlayDB const& _stateDb, h256 const& _blockHash, unsigned _blockCount)
+{
+    BlockHeader const header = _bc.info(_blockHash);
+    LOG(m_logger) << "Exporting snapshot for block " << header.number() << " block hash "
+                  << _blockHash;
+
+    h256s const stateChunks = exportStateChunks(_stateDb, header.stateRoot());
+    h256s const blockChunks = exportBlockChunks(_bc, _blockHash, _blockCount);
+    writeManifest(stateChunks, blockChunks, header.stateRoot(), header.number(), _blockHash);
+}
+
+h256s SnapshotExporter::exportStateChunks(OverlayDB const& _stateDb, h256 const& _stateRoot)
+{
+    // Only reads, but the tries want a mutable DB.
+    OverlayDB db = _stateDb;
+    GenericTrieDB<OverlayDB> const state(&db, _stateRoot);
+
+    std::deque<h256> hashes;
+    ChunkBuilder chunk;
+    size_t accounts = 0;
+    auto const flush = [&]() {
+        hashes.emplace_back();
+        writeChunk(chunk.take(), hashes.back());
+    };
+
+    // Code already written, which later accounts only refer to by hash.
+    h256Hash writtenCode;
+    for (auto it = state.begin(); it != state.end(); ++it)
+    {
+        auto const addressAndAccount = it.at();
+        h256 const addressHash(addressAndAccount.first);
+        RLP const account(addressAndAccount.second);
+        // The snapshot format has no room for the code version.
+        if (account.itemCount() != 4)
+            BOOST_THROW_EXCEPTION(InvalidStateChunkData() << errinfo_hash256(addressHash));
+
+        h256 const storageRoot = account[2].toHash<h256>(RLP::VeryStrict);
+        h256 const codeHash = account[3].toHash<h256>(RLP::VeryStrict);
+
+        // Code goes with the first part of the account, later parts refer to it by hash.
+        byte codeFlag = 0;
+        bytes code;
+        if (codeHash != EmptySHA3)
+        {
+            codeFlag = writtenCode.count(codeHash) ? 2 : 1;
+            if (codeFlag == 1)
+                code = asBytes(db.lookup(codeHash));
+        }
+
+        // An account whose storage doesn't fit into the chunk is split into parts; every part
+        // but the first starts a new chunk.
+        bytes storage;
+        size_t storageItems = 0;
+        auto const appendAccount = [&]() {
+            RLPStream s(2);
+            s << addressHash;
+            s.appendList(5) << account[0] << account[1] << codeFlag;
+            if (codeFlag == 1)
+                s << code;
+            else if (codeFlag == 2)
+                s << codeHash;
+            else
+                s << bytes();
+            s.appendList(storageItems);
+            if (storageItems)
+                s.appendRaw(storage, storageItems);
+            chunk.append(&s.out());
+
+            if (codeFlag == 1)
+            {
+                writtenCode.insert(codeHash);
+                codeFlag = 2;
+                code.clear();
+            }
+            storage.clear();
+            storageItems = 0;
+        };
+
+        GenericTrieDB<OverlayDB> const storageTrie(&db, storageRoot);
+        for (auto slot = storageTrie.begin(); slot != storageTrie.end(); ++slot)
+        {
+            auto const keyAndValue = slot.at();
+            RLPStream s(2);
+            s << h256(keyAndValue.first) << keyAndValue.second;
+
+            size_t const entrySize =
+                c_accountEntryOverhead + code.size() + storage.size() + s.out().size();
+            if (chunk.body.size() + entrySize > m_chunkSize && (storageItems || chunk.items))
+            {
+                if (storageItems)
+                    appendAccount();
+                flush();
+            }
+            storage += s.out();
+            ++storageItems;
+        }
+        if (chunk.items && chunk.body.size() + c_accountEntryOverhead + code.size() +
+                                   storage.size() > m_chunkSize)
+            flush();
+        appendAccount();
+        ++accounts;
+    }
+    if (chunk.items)
+        flush();
+
+    waitForChunks();
+    LOG(m_logger) << "Exported " << accounts << " accounts in " << hashes.size() << " chunks";
+    return h256s(hashes.begin(), hashes.end());
+}
+
+h256s SnapshotExporter::exportBlockChunks(
+    BlockChain const& _bc, h256 const& _blockHash, unsigned _blockCount)
+{
+    unsigned const number = _bc.number(_blockHash);
+    unsigned const count = number < 2 ? 0 : std::min(_blockCount, number - 1);
+
+    std::deque<h256> hashes;
+    // Blocks of the current chunk, newest first.
+    ChunkBuilder chunk;
+    std::vector<bytes> blocks;
+    size_t chunkSize = 0;
+    h256 hash = _blockHash;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        bytes const block = _bc.block(hash);
+        RLP const blockRlp(block);
+        BlockHeader const header(block);
+
+        // The seal fields are whatever the seal engine put after the basic header fields, as
+        // many as it uses. Items some engines add to the block after the uncles, like Qpos'
+        // signatures, follow them as one list.
+        RLP const headerRlp = blockRlp[0];
+        size_t const sealFields = headerRlp.itemCount() - BlockHeader::BasicFields;
+        size_t const extraItems = blockRlp.itemCount() - 3;
+        RLPStream abridged(10 + sealFields + (extraItems ? 1 : 0));
+        abridged << header.author() << header.stateRoot() << header.logBloom()
+                 << header.difficulty() << header.gasLimit() << header.gasUsed()
+                 << header.timestamp() << header.extraData();
+        abridged.appendRaw(blockRlp[1].data()).appendRaw(blockRlp[2].data());
+        for (size_t field = BlockHeader::BasicFields; field < headerRlp.itemCount(); ++field)
+            abridged.appendRaw(headerRlp[field].data());
+        if (extraItems)
+        {
+            abridged.appendList(extraItems);
+            for (size_t item = 3; item < blockRlp.itemCount(); ++item)
+                abridged.appendRaw(blockRlp[item].data());
+        }
+
+        RLPStream blockAndReceipts(2);
+        blockAndReceipts.appendRaw(abridged.out()).appendRaw(_bc.receipts(hash).rlp());
+        chunkSize += blockAndReceipts.out().size();
+        blocks.push_back(blockAndReceipts.out());
+
+        hash = header.parentHash();
+        if (chunkSize >= m_chunkSize || i + 1 == count)
+        {
+            // Starts with the block before the oldest one in the chunk and its total difficulty,
+            // followed by the blocks in ascending order.
+            RLPStream first;
+            first << _bc.number(hash) << hash << _bc.details(hash).totalDifficulty;
+            for (auto b = blocks.rbegin(); b != blocks.rend(); ++b)
+                chunk.append(&*b);
+            hashes.emplace_back();
+            writeChunk(chunk.take(&first.out(), 3), hashes.back());
+            blocks.clear();
+            chunkSize = 0;
+        }
+    }
+
+    waitForChunks();
+    LOG(m_logger) << "Exported " << count << " blocks in " << hashes.size() << " chunks";
+    return h256s(hashes.begin(), hashes.end());
+}
+
+void SnapshotExporter::writeManifest(h256s const& _stateChunks, h256s const& _blockChunks,
+    h256 const& _stateRoot, u256 const& _blockNumber, h256 const& _blockHash)
+{
+    // For Snapshot format see https://github.com/paritytech/parity/wiki/Warp-Sync-Snapshot-Format
+    RLPStream manifest(6);
+    manifest << 2 << _stateChunks << _blockChunks << _stateRoot << _blockNumber << _blockHash;
+    writeFile(m_snapshotDir / "MANIFEST", manifest.out());
+}
+
+void SnapshotExporter::writeChunk(bytes _chunk, h256& o_hash)
+{
+    {
+        // Allows for one chunk per pool thread being compressed and one waiting for each.
+        unsigned const maxInFlight = ThreadPool::shared().size() * 2;
+        UniqueGuard l(x_chunks);
+        m_chunkDone.wait(l, [&]() { return m_chunksInFlight < maxInFlight || m_chunkError; });
+        if (m_chunkError)
+            return;
+        ++m_chunksInFlight;
+    }
+
+    ThreadPool::shared().post([this, chunk = std::move(_chunk), &o_hash]() {
+        std::exception_ptr error;
+        try
+        {
+            std::string compressed;
+            snappy::Compress(reinterpret_cast<char const*>(chunk.data()), chunk.size(), &compressed);
+            h256 const hash = sha3(compressed);
+            writeFile(m_snapshotDir / toHex(hash), bytesConstRef(&compressed));
+            o_hash = hash;
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        Guard l(x_chunks);
+        if (error && !m_chunkError)
+            m_chunkError = error;
+        --m_chunksInFlight;
+        m_chunkDone.notify_all();
+    });
+}
+
+void SnapshotExporter::waitForChunks()
+{
+    UniqueGuard l(x_chunks);
+    m_chunkDone.wait(l, [this]() { return m_chunksInFlight == 0; });
+    if (m_chunkError)
+        std::rethrow_exception(std::exchange(m_chunkError, nullptr));
+}
+
+}  // namespace eth
+}  // namespace dev
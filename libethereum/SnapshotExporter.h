@@ -0,0 +1,84 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Class for exporting a snapshot to a directory on disk
+#pragma once
+
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Guards.h>
+#include <libdevcore/Log.h>
+
+#include <boost/filesystem/path.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+
+namespace dev
+{
+class OverlayDB;
+
+namespace eth
+{
+class BlockChain;
+
+/// Writes a snapshot in the format SnapshotImporter and SnapshotStorage read: snappy-compressed
+/// state and block chunks in files named after the hash of their contents, and a MANIFEST
+/// listing them. Tries are walked one node path at a time and chunks are compressed and written
+/// on the shared thread pool, with a bounded number of them in flight.
+class SnapshotExporter
+{
+public:
+    /// Chunks are cut once their uncompressed size would exceed this.
+    static constexpr size_t c_defaultChunkSize = 4 * 1024 * 1024;
+    /// Blocks before the snapshot block, itself included, that go into the snapshot by default.
+    static constexpr unsigned c_defaultBlockCount = 30000;
+
+    explicit SnapshotExporter(
+        boost::filesystem::path const& _snapshotDir, size_t _chunkSize = c_defaultChunkSize);
+    ~SnapshotExporter();
+
+    SnapshotExporter(SnapshotExporter const&) = delete;
+    SnapshotExporter& operator=(SnapshotExporter const&) = delete;
+
+    /// Writes the state after block @a _blockHash from @a _stateDb, the last @a _blockCount
+    /// blocks up to it and the manifest.
+    void exportSnapshot(BlockChain const& _bc, OverlayDB const& _stateDb, h256 const& _blockHash,
+        unsigned _blockCount = c_defaultBlockCount);
+
+    /// Writes the accounts of the state trie with root @a _stateRoot.
+    /// @returns the hashes of the chunks written, in import order.
+    h256s exportStateChunks(OverlayDB const& _stateDb, h256 const& _stateRoot);
+
+    /// Writes up to @a _blockCount blocks ending with @a _blockHash, and their receipts. The
+    /// genesis and the block after it are never included, as a chunk must start after a block
+    /// with a non-zero number.
+    /// @returns the hashes of the chunks written, newest blocks first.
+    h256s exportBlockChunks(BlockChain const& _bc, h256 const& _blockHash, unsigned _blockCount);
+
+    void writeManifest(h256s const& _stateChunks, h256s const& _blockChunks,
+        h256 const& _stateRoot, u256 const& _blockNumber, h256 const& _blockHash);
+
+private:
+    /// Hands @a _chunk to the pool to be compressed and written, and its hash to @a o_hash once
+    /// done. Blocks while too many chunks are in flight.
+    void writeChunk(bytes _chunk, h256& o_hash);
+    /// Waits for all chunks handed to writeChunk() and rethrows the first error of any of them.
+    void waitForChunks();
+
+    boost::filesystem::path const m_snapshotDir;
+    size_t const m_chunkSize;
+
+    Mutex x_chunks;
+    std::condition_variable m_chunkDone;
+    unsigned m_chunksInFlight = 0;
+    std::exception_ptr m_chunkError;
+
+    Logger m_logger{createLogger(VerbosityInfo, "snap")};
+};
+
+}  // namespace eth
+}  // namespace dev
@@ -7,16 +7,175 @@
 #include "SnapshotStorage.h"
 
 #include <libdevcore/FileSystem.h>
+#include <libdevcore/Guards.h>
 #include <libdevcore/RLP.h>
+#include <libdevcore/ThreadPool.h>
 #include <libdevcore/TrieHash.h>
-#include <libethashseal/Ethash.h>
 
 #include <snappy.h>
 
+#include <chrono>
+#include <condition_variable>
+
 namespace dev
 {
 namespace eth
 {
+namespace
+{
+struct DecodedAccount
+{
+    h256 addressHash;
+    u256 nonce;
+    u256 balance;
+    std::map<h256, bytes> storage;
+    byte codeFlag = 0;
+    /// Code of an account with code flag 1.
+    bytes code;
+    /// Hash of the code of an account with code flag 2.
+    h256 codeHash;
+};
+
+struct DecodedStateChunk
+{
+    std::vector<DecodedAccount> accounts;
+    /// Size of the uncompressed chunk.
+    size_t size = 0;
+};
+
+/// Decodes a state chunk, checking everything that doesn't depend on the chunks before it.
+DecodedStateChunk decodeStateChunk(std::string const& _chunk)
+{
+    DecodedStateChunk ret;
+    ret.size = _chunk.size();
+
+    RLP const accounts(_chunk);
+    ret.accounts.reserve(accounts.itemCount());
+    for (auto addressAndAccount: accounts)
+    {
+        if (addressAndAccount.itemCount() != 2)
+            BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+
+        DecodedAccount decoded;
+        decoded.addressHash = addressAndAccount[0].toHash<h256>(RLP::VeryStrict);
+        if (!decoded.addressHash)
+            BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+
+        RLP const account = addressAndAccount[1];
+        if (account.itemCount() != 5)
+            BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+
+        decoded.nonce = account[0].toInt<u256>(RLP::VeryStrict);
+        decoded.balance = account[1].toInt<u256>(RLP::VeryStrict);
+
+        RLP const storage = account[4];
+        for (auto hashAndValue: storage)
+        {
+            if (hashAndValue.itemCount() != 2)
+                BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+
+            h256 const keyHash = hashAndValue[0].toHash<h256>(RLP::VeryStrict);
+            if (!keyHash || decoded.storage.find(keyHash) != decoded.storage.end())
+                BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+
+            bytes value = hashAndValue[1].toBytes(RLP::VeryStrict);
+            if (value.empty())
+                BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+
+            decoded.storage.emplace(keyHash, std::move(value));
+        }
+
+        decoded.codeFlag = account[2].toInt<byte>(RLP::VeryStrict);
+        switch (decoded.codeFlag)
+        {
+        case 0:
+            break;
+        case 1:
+            decoded.code = account[3].toBytes(RLP::VeryStrict);
+            break;
+        case 2:
+            decoded.codeHash = account[3].toHash<h256>(RLP::VeryStrict);
+            if (!decoded.codeHash)
+                BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+            break;
+        default:
+            BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+        }
+
+        ret.accounts.push_back(std::move(decoded));
+    }
+    return ret;
+}
+
+/// State chunks read, decompressed and decoded on the thread pool, handed out in order.
+class DecodedStateChunks
+{
+public:
+    explicit DecodedStateChunks(size_t _count) : m_slots(_count) {}
+
+    ~DecodedStateChunks()
+    {
+        // Decoding still running refers to this object.
+        UniqueGuard l(x_slots);
+        m_done.wait(l, [this]() { return m_running == 0; });
+    }
+
+    /// Starts decoding chunk @a _index, whose hash is @a _chunkHash.
+    void decode(SnapshotStorageFace const& _snapshotStorage, h256 const& _chunkHash, size_t _index)
+    {
+        DEV_GUARDED(x_slots)
+            ++m_running;
+
+        ThreadPool::shared().post([this, &_snapshotStorage, _chunkHash, _index]() {
+            Slot slot;
+            try
+            {
+                slot.chunk = decodeStateChunk(_snapshotStorage.readChunk(_chunkHash));
+            }
+            catch (...)
+            {
+                slot.error = std::current_exception();
+            }
+            slot.ready = true;
+
+            Guard l(x_slots);
+            m_slots[_index] = std::move(slot);
+            --m_running;
+            m_done.notify_all();
+        });
+    }
+
+    /// Waits for chunk @a _index to be decoded and hands it out, or rethrows what decoding
+    /// threw.
+    DecodedStateChunk take(size_t _index)
+    {
+        Slot slot;
+        {
+            UniqueGuard l(x_slots);
+            m_done.wait(l, [&]() { return m_slots[_index].ready; });
+            slot = std::move(m_slots[_index]);
+        }
+        if (slot.error)
+            std::rethrow_exception(slot.error);
+        return std::move(slot.chunk);
+    }
+
+private:
+    struct Slot
+    {
+        bool ready = false;
+        DecodedStateChunk chunk;
+        std::exception_ptr error;
+    };
+
+    Mutex x_slots;
+    std::condition_variable m_done;
+    std::vector<Slot> m_slots;
+    size_t m_running = 0;
+};
+}  // namespace
+
+constexpr unsigned SnapshotImporter::c_chunksPerCommit;
 
 void SnapshotImporter::import(SnapshotStorageFace const& _snapshotStorage, h256 const& /*_genesisHash*/)
 {
@@ -45,89 +204,78 @@ void SnapshotImporter::import(SnapshotStorageFace const& _snapshotStorage, h256
 void SnapshotImporter::importStateChunks(SnapshotStorageFace const& _snapshotStorage, h256s const& _stateChunkHashes, h256 const& _stateRoot)
 {
     size_t const stateChunkCount = _stateChunkHashes.size();
+    // Chunks read ahead of the one being imported: enough to keep every pool thread busy.
+    size_t const maxChunksAhead = ThreadPool::shared().size() * 2;
+    DecodedStateChunks decoded(stateChunkCount);
 
+    size_t chunksRequested = 0;
     size_t chunksImported = 0;
     size_t accountsImported = 0;
+    size_t bytesImported = 0;
+    auto const started = std::chrono::steady_clock::now();
+    auto batchStarted = started;
+    size_t batchAccounts = 0;
+    size_t batchBytes = 0;
 
-    for (auto const& stateChunkHash: _stateChunkHashes)
+    for (; chunksImported < stateChunkCount; ++chunksImported)
     {
-        std::string const chunkUncompressed = _snapshotStorage.readChunk(stateChunkHash);
+        for (; chunksRequested < stateChunkCount && chunksRequested <= chunksImported + maxChunksAhead; ++chunksRequested)
+            decoded.decode(_snapshotStorage, _stateChunkHashes[chunksRequested], chunksRequested);
 
-        RLP const accounts(chunkUncompressed);
-        size_t const accountCount = accounts.itemCount();
-        for (size_t accountIndex = 0; accountIndex < accountCount; ++accountIndex)
+        DecodedStateChunk const chunk = decoded.take(chunksImported);
+        for (size_t accountIndex = 0; accountIndex < chunk.accounts.size(); ++accountIndex)
         {
-            RLP const addressAndAccount = accounts[accountIndex];
-            if (addressAndAccount.itemCount() != 2)
-                BOOST_THROW_EXCEPTION(InvalidStateChunkData());
-
-            h256 const addressHash = addressAndAccount[0].toHash<h256>(RLP::VeryStrict);
-            if (!addressHash)
-                BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+            DecodedAccount const& account = chunk.accounts[accountIndex];
 
             // splitted parts of account can be only first in chunk
-            if (accountIndex > 0 && m_stateImporter.isAccountImported(addressHash))
+            if (accountIndex > 0 && m_stateImporter.isAccountImported(account.addressHash))
                 BOOST_THROW_EXCEPTION(AccountAlreadyImported());
 
-            RLP const account = addressAndAccount[1];
-            if (account.itemCount() != 5)
-                BOOST_THROW_EXCEPTION(InvalidStateChunkData());
-
-            u256 const nonce = account[0].toInt<u256>(RLP::VeryStrict);
-            u256 const balance = account[1].toInt<u256>(RLP::VeryStrict);
-
-            RLP const storage = account[4];
-            std::map<h256, bytes> storageMap;
-            for (auto hashAndValue: storage)
-            {
-                if (hashAndValue.itemCount() != 2)
-                    BOOST_THROW_EXCEPTION(InvalidStateChunkData());
-
-                h256 const keyHash = hashAndValue[0].toHash<h256>(RLP::VeryStrict);
-                if (!keyHash || storageMap.find(keyHash) != storageMap.end())
-                    BOOST_THROW_EXCEPTION(InvalidStateChunkData());
-
-                bytes value = hashAndValue[1].toBytes(RLP::VeryStrict);
-                if (value.empty())
-                    BOOST_THROW_EXCEPTION(InvalidStateChunkData());
-
-                storageMap.emplace(keyHash, std::move(value));
-            }
-
-            byte const codeFlag = account[2].toInt<byte>(RLP::VeryStrict);
             h256 codeHash;
-            switch (codeFlag)
+            switch (account.codeFlag)
             {
             case 0:
                 codeHash = EmptySHA3;
                 break;
             case 1:
-                codeHash = m_stateImporter.importCode(account[3].toBytesConstRef(RLP::VeryStrict));
+                codeHash = m_stateImporter.importCode(&account.code);
                 break;
             case 2:
-                codeHash = account[3].toHash<h256>(RLP::VeryStrict);
-                if (!codeHash || m_stateImporter.lookupCode(codeHash).empty())
+                codeHash = account.codeHash;
+                if (m_stateImporter.lookupCode(codeHash).empty())
                     BOOST_THROW_EXCEPTION(InvalidStateChunkData());
                 break;
-            default:
-                BOOST_THROW_EXCEPTION(InvalidStateChunkData());
             }
 
-            m_stateImporter.importAccount(addressHash, nonce, balance, storageMap, codeHash);
+            m_stateImporter.importAccount(account.addressHash, account.nonce, account.balance, account.storage, codeHash);
+        }
+        accountsImported += chunk.accounts.size();
+        bytesImported += chunk.size;
+        batchAccounts += chunk.accounts.size();
+        batchBytes += chunk.size;
+
+        // Several chunks go into each write, which is still bounded by the chunks' size.
+        bool const lastChunk = chunksImported + 1 == stateChunkCount;
+        if ((chunksImported + 1) % c_chunksPerCommit == 0 || lastChunk)
+        {
+            m_stateImporter.commitStateDatabase();
+
+            auto const now = std::chrono::steady_clock::now();
+            double const seconds = std::max(std::chrono::duration<double>(now - batchStarted).count(), 1e-3);
+            LOG(m_logger) << "Imported chunk " << chunksImported + 1 << " of " << stateChunkCount
+                          << ". Total account records imported: " << accountsImported << " ("
+                          << static_cast<size_t>(batchAccounts / seconds) << " accounts/s, "
+                          << static_cast<size_t>(batchBytes / seconds / 1024) << " KiB/s)";
+            batchStarted = now;
+            batchAccounts = 0;
+            batchBytes = 0;
         }
-        accountsImported += accountCount;
-
-        m_stateImporter.commitStateDatabase();
-
-        ++chunksImported;
-        LOG(m_logger) << "Imported chunk " << chunksImported << " (" << accounts.itemCount()
-                      << " account records) Total account records imported: " << accountsImported;
-        LOG(m_logger) << stateChunkCount - chunksImported << " chunks left to import";
     }
 
     // check root
-    LOG(m_logger) << "Chunks imported: " << chunksImported;
-    LOG(m_logger) << "Account records imported: " << accountsImported;
+    double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    LOG(m_logger) << "Chunks imported: " << chunksImported << " in " << seconds << " s";
+    LOG(m_logger) << "Account records imported: " << accountsImported << " (" << bytesImported / 1024 << " KiB of chunk data)";
     LOG(m_logger) << "Reconstructed state root: " << m_stateImporter.stateRoot();
     LOG(m_logger) << "Manifest state root:      " << _stateRoot;
     if (m_stateImporter.stateRoot() != _stateRoot)
@@ -167,6 +315,8 @@ void SnapshotImporter::importBlockChunks(SnapshotStorageFace const& _snapshotSto
                 BOOST_THROW_EXCEPTION(InvalidBlockChunkData());
 
             RLP abridgedBlock = blockAndReceipts[0];
+            if (abridgedBlock.itemCount() < 10)
+                BOOST_THROW_EXCEPTION(InvalidBlockChunkData());
 
             BlockHeader header;
             header.setParentHash(parentHash);
@@ -193,11 +343,21 @@ void SnapshotImporter::importBlockChunks(SnapshotStorageFace const& _snapshotSto
             header.setTimestamp(abridgedBlock[6].toPositiveInt64(RLP::VeryStrict));
             header.setExtraData(abridgedBlock[7].toBytes(RLP::VeryStrict));
 
-            Ethash::setMixHash(header, abridgedBlock[10].toHash<h256>(RLP::VeryStrict));
-            Ethash::setNonce(header, abridgedBlock[11].toHash<Nonce>(RLP::VeryStrict));
+            // The rest are the seal fields of the chain's seal engine, e.g. Ethash's mix hash
+            // and nonce, and then possibly a list of the block's items after the uncles.
+            size_t sealEnd = abridgedBlock.itemCount();
+            RLP extraItems;
+            if (sealEnd > 10 && abridgedBlock[sealEnd - 1].isList())
+                extraItems = abridgedBlock[--sealEnd];
+            for (size_t field = 10; field < sealEnd; ++field)
+            {
+                if (!abridgedBlock[field].isData())
+                    BOOST_THROW_EXCEPTION(InvalidBlockChunkData());
+                header.setSeal(field - 10, abridgedBlock[field].toBytes());
+            }
 
             totalDifficulty += difficulty;
-            m_blockChainImporter.importBlock(header, transactions, uncles, receipts, totalDifficulty);
+            m_blockChainImporter.importBlock(header, transactions, uncles, extraItems, receipts, totalDifficulty);
 
             parentHash = header.hash();
         }
@@ -22,9 +22,15 @@ class BlockChainImporterFace;
 class SnapshotStorageFace;
 class StateImporterFace;
 
+/// Imports a snapshot in the Parity warp format. State chunks are read, decompressed and decoded
+/// on the shared thread pool, a bounded number ahead of the one being imported, while accounts go
+/// into the state trie in chunk order on the calling thread.
 class SnapshotImporter
 {
 public:
+    /// State chunks imported between writes of the state database.
+    static constexpr unsigned c_chunksPerCommit = 8;
+
     SnapshotImporter(StateImporterFace& _stateImporter, BlockChainImporterFace& _bcImporter): m_stateImporter(_stateImporter), m_blockChainImporter(_bcImporter) {}
 
     void import(SnapshotStorageFace const& _snapshotStorage, h256 const& _genesisHash);
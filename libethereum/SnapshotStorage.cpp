@@ -4,7 +4,9 @@
 
 #include "SnapshotStorage.h"
 #include <libdevcore/CommonIO.h>
+#include <libdevcore/RLP.h>
 #include <libdevcore/SHA3.h>
+#include <libethcore/Exceptions.h>
 
 #include <snappy.h>
 
@@ -87,6 +89,19 @@ std::unique_ptr<SnapshotStorageFace> createSnapshotStorage(fs::path const& _snap
 	return std::unique_ptr<SnapshotStorageFace>(new SnapshotStorage(_snapshotDirPath));
 }
 
+void verifySnapshot(SnapshotStorageFace const& _storage)
+{
+    bytes const manifestBytes = _storage.readManifest();
+    RLP const manifest(manifestBytes);
+    if (!manifest.isList() || manifest.itemCount() != 6 ||
+        manifest[0].toInt<u256>(RLP::VeryStrict) != 2)
+        BOOST_THROW_EXCEPTION(InvalidSnapshotManifest());
+
+    for (unsigned list : {1, 2})
+        for (auto const& chunkHash : manifest[list].toVector<h256>(RLP::VeryStrict))
+            _storage.readChunk(chunkHash);
+}
+
 fs::path importedSnapshotPath(fs::path const& _dataDir, h256 const& _genesisHash)
 {
     return _dataDir / toHex(_genesisHash.ref().cropped(0, 4)) / "snapshot";
@@ -43,6 +43,10 @@ public:
 std::unique_ptr<SnapshotStorageFace> createSnapshotStorage(
     boost::filesystem::path const& _snapshotDirPath);
 
+/// Reads the manifest of @a _storage and every chunk it lists, checking their hashes.
+/// @throws if the manifest is invalid or a chunk is missing or corrupt.
+void verifySnapshot(SnapshotStorageFace const& _storage);
+
 boost::filesystem::path importedSnapshotPath(
     boost::filesystem::path const& _dataDir, h256 const& _genesisHash);
 }
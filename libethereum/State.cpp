@@ -10,6 +10,7 @@
 #include "TransactionQueue.h"
 #include <libdevcore/Assertions.h>
 #include <libdevcore/DBFactory.h>
+#include <libdevcore/ThreadPool.h>
 #include <libdevcore/TrieHash.h>
 #include <libevm/VMFactory.h>
 #include <boost/filesystem.hpp>
@@ -66,7 +67,7 @@ OverlayDB State::openDB(fs::path const& _basePath, h256 const& _genesisHash, Wit
     {
         clog(VerbosityTrace, "statedb") << "Opening state database: " << statePath;
         std::unique_ptr<db::DatabaseFace> db = db::DBFactory::create(statePath);
-        return OverlayDB(std::move(db));
+        return OverlayDB(std::move(db), db::stateCacheSize());
     }
     catch (boost::exception const& ex)
     {
@@ -661,11 +662,11 @@ std::pair<ExecutionResult, TransactionReceipt> State::execute(EnvInfo const& _en
     return make_pair(res, receipt);
 }
 
-void State::executeBlockTransactions(Block const& _block, unsigned _txCount,
+void State::executeBlockTransactions(Block const& _block, unsigned _txFrom, unsigned _txCount,
     LastBlockHashesFace const& _lastHashes, SealEngineFace const& _sealEngine)
 {
-    u256 gasUsed = 0;
-    for (unsigned i = 0; i < _txCount; ++i)
+    u256 gasUsed = _txFrom ? _block.receipt(_txFrom - 1).cumulativeGasUsed() : 0;
+    for (unsigned i = _txFrom; i < _txCount; ++i)
     {
         EnvInfo envInfo(_block.info(), _lastHashes, gasUsed, _sealEngine.chainParams().chainID);
 
@@ -780,15 +781,132 @@ State& dev::eth::createIntermediateState(State& o_s, Block const& _block, unsign
         o_s.setRoot(rootHash);
     else
     {
-        o_s.setRoot(_block.stateRootBeforeTx(0));
-        o_s.executeBlockTransactions(_block, _txIndex, _bc.lastBlockHashes(), *_bc.sealEngine());
+        // Replay from the nearest checkpoint, if the block has any.
+        unsigned const from =
+            _bc.stateCheckpoints().nearest(_block.info().hash(), _txIndex, o_s);
+        if (!from)
+            o_s.setRoot(_block.stateRootBeforeTx(0));
+        o_s.executeBlockTransactions(
+            _block, from, _txIndex, _bc.lastBlockHashes(), *_bc.sealEngine());
     }
     return o_s;
 }
 
+namespace
+{
+/// Below this many changed storage tries the hand-off to the pool costs more than it saves.
+size_t const c_minParallelStorageCommits = 4;
+
+/// Node store for building one storage trie while other threads build theirs. Reads fall
+/// through to the shared state DB, which isn't touched; changes stay here until mergeInto().
+template <class DB>
+class StagedStorageDB : public StateCacheDB
+{
+public:
+    explicit StagedStorageDB(DB const& _base) : m_base(_base) {}
+
+    std::string lookup(h256 const& _h) const
+    {
+        std::string ret = StateCacheDB::lookup(_h);
+        return ret.empty() ? m_base.lookup(_h) : ret;
+    }
+    bool exists(h256 const& _h) const { return StateCacheDB::exists(_h) || m_base.exists(_h); }
+    void kill(h256 const& _h)
+    {
+        // Nodes of the base DB are released once merged, like everything else.
+        if (!StateCacheDB::kill(_h))
+            m_baseKills.push_back(_h);
+    }
+    bytes lookupAux(h256 const& _h) const
+    {
+        bytes ret = StateCacheDB::lookupAux(_h);
+        return ret.empty() ? m_base.lookupAux(_h) : ret;
+    }
+
+    /// Applies the staged changes to @a _db, leaving it with the same reference counts as if
+    /// the trie had been built there directly.
+    void mergeInto(DB& _db) const
+    {
+        for (auto const& i: m_main)
+            for (unsigned n = 0; n < i.second.second; ++n)
+                _db.insert(i.first, &i.second.first);
+        for (auto const& i: m_aux)
+            if (i.second.second)
+                _db.insertAux(i.first, &i.second.first);
+        for (auto const& h: m_baseKills)
+            _db.kill(h);
+    }
+
+private:
+    DB const& m_base;
+    h256s m_baseKills;
+};
+
+/// Applies the storage changes of @a _account to its storage trie in @a _db.
+/// @returns the new storage root.
+template <class DB>
+h256 commitStorage(Account const& _account, DB* _db)
+{
+    SecureTrieDB<h256, DB> storageDB(_db, _account.baseRoot());
+    for (auto const& j: _account.storageOverlay())
+        if (j.second)
+            storageDB.insert(j.first, rlp(j.second));
+        else
+            storageDB.remove(j.first);
+    assert(storageDB.root());
+    return storageDB.root();
+}
+
+/// Builds the changed storage tries of the dirty accounts in @a _cache in parallel, each into
+/// its own StagedStorageDB, and merges them into @a _db in iteration order of @a _cache.
+/// @returns the new storage roots, or nothing if there are too few tries to be worth it.
+template <class DB>
+std::unordered_map<Address, h256> commitStorageInParallel(AccountMap const& _cache, DB& _db)
+{
+    std::vector<AccountMap::const_iterator> changed;
+    for (auto it = _cache.begin(); it != _cache.end(); ++it)
+        if (it->second.isDirty() && it->second.isAlive() && !it->second.storageOverlay().empty())
+            changed.push_back(it);
+    if (changed.size() < c_minParallelStorageCommits)
+        return {};
+
+    std::vector<std::unique_ptr<StagedStorageDB<DB>>> staged(changed.size());
+    h256s roots(changed.size());
+    Mutex x_error;
+    std::exception_ptr error;
+    ThreadPool::shared().parallelFor(changed.size(), [&](size_t _i) {
+        try
+        {
+            staged[_i].reset(new StagedStorageDB<DB>(_db));
+            roots[_i] = commitStorage(changed[_i]->second, staged[_i].get());
+            return true;
+        }
+        catch (...)
+        {
+            Guard l(x_error);
+            error = std::current_exception();
+            return false;
+        }
+    });
+    if (error)
+        std::rethrow_exception(error);
+
+    std::unordered_map<Address, h256> ret;
+    for (size_t i = 0; i < changed.size(); ++i)
+    {
+        staged[i]->mergeInto(_db);
+        ret[changed[i]->first] = roots[i];
+    }
+    return ret;
+}
+}  // namespace
+
 template <class DB>
 AddressHash dev::eth::commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state)
 {
+    // Storage tries are independent of each other until their roots go into the account trie.
+    auto const storageRoots = commitStorageInParallel(_cache, *_state.db());
+
     AddressHash ret;
     for (auto const& i: _cache)
         if (i.second.isDirty())
@@ -811,14 +929,9 @@ AddressHash dev::eth::commit(AccountMap const& _cache, SecureTrieDB<Address, DB>
                 }
                 else
                 {
-                    SecureTrieDB<h256, DB> storageDB(_state.db(), i.second.baseRoot());
-                    for (auto const& j: i.second.storageOverlay())
-                        if (j.second)
-                            storageDB.insert(j.first, rlp(j.second));
-                        else
-                            storageDB.remove(j.first);
-                    assert(storageDB.root());
-                    s.append(storageDB.root());
+                    auto const root = storageRoots.find(i.first);
+                    s.append(root != storageRoots.end() ? root->second :
+                                                          commitStorage(i.second, _state.db()));
                 }
 
                 if (i.second.hasNewCode())
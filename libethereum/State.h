@@ -191,9 +191,9 @@ public:
     /// This will change the state accordingly.
     std::pair<ExecutionResult, TransactionReceipt> execute(EnvInfo const& _envInfo, SealEngineFace const& _sealEngine, Transaction const& _t, Permanence _p = Permanence::Committed, OnOpFunc const& _onOp = OnOpFunc());
 
-    /// Execute @a _txCount transactions of a given block.
-    /// This will change the state accordingly.
-    void executeBlockTransactions(Block const& _block, unsigned _txCount, LastBlockHashesFace const& _lastHashes, SealEngineFace const& _sealEngine);
+    /// Execute the transactions of a given block from index @a _txFrom up to @a _txCount,
+    /// starting from the state after the first @a _txFrom. This will change the state accordingly.
+    void executeBlockTransactions(Block const& _block, unsigned _txFrom, unsigned _txCount, LastBlockHashesFace const& _lastHashes, SealEngineFace const& _sealEngine);
 
     /// Check if the address is in use.
     bool addressInUse(Address const& _address) const;
@@ -0,0 +1,63 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "StateCheckpoints.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+constexpr size_t StateCheckpoints::c_maxBlocks;
+
+void StateCheckpoints::setInterval(unsigned _interval)
+{
+    m_interval = _interval;
+    if (!_interval)
+        clear();
+}
+
+void StateCheckpoints::record(h256 const& _block, unsigned _txCount, State const& _s)
+{
+    unsigned const interval = m_interval;
+    if (!interval || !_txCount || _txCount % interval)
+        return;
+
+    Guard l(x_blocks);
+    auto it = find_if(m_blocks.begin(), m_blocks.end(),
+        [&](pair<h256, map<unsigned, State>> const& _b) { return _b.first == _block; });
+    if (it == m_blocks.end())
+    {
+        m_blocks.emplace_front(_block, map<unsigned, State>());
+        if (m_blocks.size() > c_maxBlocks)
+            m_blocks.pop_back();
+    }
+    else
+        m_blocks.splice(m_blocks.begin(), m_blocks, it);
+    // A block enacted again (on import and for a query, say) yields the same states.
+    m_blocks.front().second.emplace(_txCount, _s);
+}
+
+unsigned StateCheckpoints::nearest(h256 const& _block, unsigned _txCount, State& o_s) const
+{
+    Guard l(x_blocks);
+    for (auto const& b : m_blocks)
+        if (b.first == _block)
+        {
+            auto it = b.second.upper_bound(_txCount);
+            if (it == b.second.begin())
+                return 0;
+            --it;
+            o_s = it->second;
+            return it->first;
+        }
+    return 0;
+}
+
+void StateCheckpoints::clear()
+{
+    Guard l(x_blocks);
+    m_blocks.clear();
+}
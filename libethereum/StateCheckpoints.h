@@ -0,0 +1,54 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#pragma once
+
+#include "State.h"
+
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Guards.h>
+
+#include <atomic>
+#include <list>
+#include <map>
+
+namespace dev
+{
+namespace eth
+{
+/// States part way through recently enacted blocks, kept every few transactions, so that the
+/// state before transaction N of a block can be rebuilt by replaying from the nearest
+/// checkpoint instead of from the start of the block. Thread-safe; off until given an interval.
+class StateCheckpoints
+{
+public:
+    /// Blocks whose checkpoints are kept. Each checkpoint holds the block's trie nodes written
+    /// up to that point, so this bounds the memory used.
+    static constexpr size_t c_maxBlocks = 8;
+
+    /// Keeps a checkpoint every @a _interval transactions; 0 turns checkpoints off and drops
+    /// the ones kept so far.
+    void setInterval(unsigned _interval);
+    unsigned interval() const noexcept { return m_interval; }
+
+    /// Called after transaction @a _txCount - 1 of block @a _block has been executed on @a _s.
+    void record(h256 const& _block, unsigned _txCount, State const& _s);
+
+    /// Sets @a o_s to the latest checkpoint of block @a _block taken after at most @a _txCount
+    /// transactions. @returns the number of transactions it was taken after, or 0 if there is
+    /// none, in which case @a o_s is left alone.
+    unsigned nearest(h256 const& _block, unsigned _txCount, State& o_s) const;
+
+    void clear();
+
+private:
+    std::atomic<unsigned> m_interval{0};
+
+    mutable Mutex x_blocks;
+    /// Checkpoints by number of transactions executed, for each block; most recent block first.
+    std::list<std::pair<h256, std::map<unsigned, State>>> m_blocks;
+};
+
+}  // namespace eth
+}  // namespace dev
@@ -3,6 +3,7 @@
 // Licensed under the GNU General Public License, Version 3.
 
 #include <libdevcore/vector_ref.h>
+#include <libdevcore/ThreadPool.h>
 #include <libdevcore/Log.h>
 #include <libdevcore/CommonIO.h>
 #include <libdevcrypto/Common.h>
@@ -83,3 +84,19 @@ Transaction::Transaction(bytesConstRef _rlpData, CheckTransaction _checkSig):
 	TransactionBase(_rlpData, _checkSig)
 {
 }
+
+void dev::eth::recoverSenders(Transactions const& _txs)
+{
+	// Below this the hand-off to the pool costs more than the recoveries it spreads.
+	static size_t const c_minParallel = 4;
+	if (_txs.size() < c_minParallel)
+	{
+		for (auto const& t: _txs)
+			t.safeSender();
+		return;
+	}
+	ThreadPool::shared().parallelFor(_txs.size(), [&](size_t _i) {
+		_txs[_i].safeSender();
+		return true;
+	});
+}
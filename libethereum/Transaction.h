@@ -105,6 +105,11 @@ public:
 /// Nice name for vector of Transaction.
 using Transactions = std::vector<Transaction>;
 
+/// Recovers the senders of @a _txs on the shared thread pool, so that later calls to sender()
+/// return the cached address. Transactions with an invalid signature are left as they are and
+/// throw from sender() as usual.
+void recoverSenders(Transactions const& _txs);
+
 class LocalisedTransaction: public Transaction
 {
 public:
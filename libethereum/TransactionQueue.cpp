@@ -17,6 +17,43 @@ constexpr size_t c_maxVerificationQueueSize = 8192;
 constexpr size_t c_maxDroppedTransactionCount = 1024;
 }  // namespace
 
+bool TransactionQueue::KnownHashes::contains(h256 const& _h) const
+{
+    Stripe const& s = stripe(_h);
+    Guard l(s.mutex);
+    return s.hashes.count(_h);
+}
+
+void TransactionQueue::KnownHashes::insert(h256 const& _h)
+{
+    Stripe& s = stripe(_h);
+    Guard l(s.mutex);
+    s.hashes.insert(_h);
+}
+
+void TransactionQueue::KnownHashes::erase(h256 const& _h)
+{
+    Stripe& s = stripe(_h);
+    Guard l(s.mutex);
+    s.hashes.erase(_h);
+}
+
+void TransactionQueue::KnownHashes::clear()
+{
+    for (auto& s : m_stripes)
+        DEV_GUARDED(s.mutex)
+            s.hashes.clear();
+}
+
+h256Hash TransactionQueue::KnownHashes::all() const
+{
+    h256Hash ret;
+    for (auto const& s : m_stripes)
+        DEV_GUARDED(s.mutex)
+            ret.insert(s.hashes.begin(), s.hashes.end());
+    return ret;
+}
+
 TransactionQueue::TransactionQueue(unsigned _limit, unsigned _futureLimit)
   : m_dropped{c_maxDroppedTransactionCount},
     m_current{PriorityCompare{*this}},
@@ -55,7 +92,7 @@ ImportResult TransactionQueue::import(bytesConstRef _transactionRLP, IfDropped _
 
 ImportResult TransactionQueue::check_WITH_LOCK(h256 const& _h, IfDropped _ik)
 {
-    if (m_known.count(_h))
+    if (m_known.contains(_h))
         return ImportResult::AlreadyKnown;
 
     if (m_dropped.touch(_h) && _ik == IfDropped::Ignore)
@@ -70,21 +107,19 @@ ImportResult TransactionQueue::import(Transaction const& _transaction, IfDropped
         return ImportResult::ZeroSignature;
     // Check if we already know this transaction.
     h256 h = _transaction.sha3(WithSignature);
+    if (m_known.contains(h))
+        return ImportResult::AlreadyKnown;
 
-    ImportResult ret;
-    {
-        UpgradableGuard l(m_lock);
-        auto ir = check_WITH_LOCK(h, _ik);
-        if (ir != ImportResult::Success)
-            return ir;
+    // Perform EC recovery outside of the lock, so that verifier threads do it in parallel
+    _transaction.safeSender();
 
-        {
-            _transaction.safeSender();  // Perform EC recovery outside of the write lock
-            UpgradeGuard ul(l);
-            ret = manageImport_WITH_LOCK(h, _transaction);
-        }
-    }
-    return ret;
+    WriteGuard l(m_lock);
+    // Checked again, as another thread could have imported the transaction meanwhile
+    auto ir = check_WITH_LOCK(h, _ik);
+    if (ir != ImportResult::Success)
+        return ir;
+
+    return manageImport_WITH_LOCK(h, _transaction);
 }
 
 Transactions TransactionQueue::topTransactions(unsigned _limit, h256Hash const& _avoid) const
@@ -98,9 +133,22 @@ Transactions TransactionQueue::topTransactions(unsigned _limit, h256Hash const&
 }
 
 h256Hash TransactionQueue::knownTransactions() const
+{
+    return m_known.all();
+}
+
+bool TransactionQueue::isKnown(h256 const& _txHash) const
+{
+    return m_known.contains(_txHash);
+}
+
+Transaction TransactionQueue::transaction(h256 const& _txHash) const
 {
     ReadGuard l(m_lock);
-    return m_known;
+    auto const it = m_currentByHash.find(_txHash);
+    if (it == m_currentByHash.end())
+        return Transaction();
+    return it->second->transaction;
 }
 
 ImportResult TransactionQueue::manageImport_WITH_LOCK(h256 const& _h, Transaction const& _transaction)
@@ -312,7 +360,7 @@ void TransactionQueue::drop(h256 const& _txHash)
 {
     UpgradableGuard l(m_lock);
 
-    if (!m_known.count(_txHash))
+    if (!m_known.contains(_txHash))
         return;
 
     UpgradeGuard ul(l);
@@ -324,7 +372,7 @@ void TransactionQueue::dropGood(Transaction const& _t)
 {
     WriteGuard l(m_lock);
     makeCurrent_WITH_LOCK(_t);
-    if (!m_known.count(_t.sha3()))
+    if (!m_known.contains(_t.sha3()))
         return;
     remove_WITH_LOCK(_t.sha3());
 }
@@ -10,6 +10,7 @@
 #include <libdevcore/Log.h>
 #include <libdevcore/LruCache.h>
 #include <libethcore/Common.h>
+#include <array>
 #include <condition_variable>
 #include <deque>
 #include <functional>
@@ -48,6 +49,8 @@ public:
     ImportResult import(bytes const& _tx, IfDropped _ik = IfDropped::Ignore) { return import(&_tx, _ik); }
 
     /// Verify and add transaction to the queue synchronously.
+    /// Safe to call from several threads, but not with the same Transaction object: its hash and
+    /// sender are cached on first use without synchronization, so each thread needs its own copy.
     /// @param _tx Trasnaction data.
     /// @param _ik Set to Retry to force re-addinga transaction that was previously dropped.
     /// @returns Import result code.
@@ -71,6 +74,13 @@ public:
     /// @returns A hash set of all transactions in the queue
     h256Hash knownTransactions() const;
 
+    /// @returns true if the transaction with hash @a _txHash is in the queue.
+    bool isKnown(h256 const& _txHash) const;
+
+    /// Get a pending transaction by its hash
+    /// @returns The transaction, or a null one if it is not among the current transactions
+    Transaction transaction(h256 const& _txHash) const;
+
     /// Get max nonce for an account
     /// @returns Max transaction nonce for account in the queue
     u256 maxNonce(Address const& _a) const;
@@ -159,6 +169,32 @@ private:
     // Use a set with dynamic comparator for minmax priority queue. The comparator takes into account min account nonce. Updating it does not affect the order.
     using PriorityQueue = std::multiset<VerifiedTransaction, PriorityCompare>;
 
+    /// Set of transaction hashes split into stripes with a lock each, so that it can be read
+    /// without taking m_lock.
+    class KnownHashes
+    {
+    public:
+        bool contains(h256 const& _h) const;
+        void insert(h256 const& _h);
+        void erase(h256 const& _h);
+        void clear();
+        h256Hash all() const;
+
+    private:
+        static constexpr size_t c_stripeCount = 16;
+
+        struct Stripe
+        {
+            mutable Mutex mutex;
+            h256Hash hashes;
+        };
+
+        Stripe& stripe(h256 const& _h) { return m_stripes[_h[0] % c_stripeCount]; }
+        Stripe const& stripe(h256 const& _h) const { return m_stripes[_h[0] % c_stripeCount]; }
+
+        std::array<Stripe, c_stripeCount> m_stripes;
+    };
+
     ImportResult import(bytesConstRef _tx, IfDropped _ik = IfDropped::Ignore);
     ImportResult check_WITH_LOCK(h256 const& _h, IfDropped _ik);
     ImportResult manageImport_WITH_LOCK(h256 const& _h, Transaction const& _transaction);
@@ -170,7 +206,9 @@ private:
     void verifierBody();
 
     mutable SharedMutex m_lock;  ///< General lock.
-    h256Hash m_known;            ///< Headers of transactions in both sets.
+    /// Hashes of transactions in both sets. Changed only with m_lock held for writing, but read
+    /// without it, so that duplicates and lookups don't wait for imports.
+    KnownHashes m_known;
 
     std::unordered_map<h256, std::function<void(ImportResult)>> m_callbacks;	///< Called once.
 
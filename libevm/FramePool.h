@@ -0,0 +1,72 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace dev
+{
+namespace eth
+{
+/// Empties a memory or return data buffer of a VM instance going back to its FramePool.
+/// Buffers are cleared rather than zeroed: memory is zero-filled again by resize() only up to
+/// the size the next frame actually uses. Buffers grown past 1 MiB are freed instead.
+inline void recycleBuffer(std::vector<uint8_t>& _buffer) noexcept
+{
+    static size_t const c_maxRetainedBuffer = 1024 * 1024;
+    if (_buffer.capacity() > c_maxRetainedBuffer)
+        std::vector<uint8_t>().swap(_buffer);
+    else
+        _buffer.clear();
+}
+
+/// Per-thread free list of VM instances. Every call frame takes an instance on entry and hands
+/// it back when it returns, so a chain of nested calls reuses the stacks and memory buffers left
+/// by earlier frames at the same depth instead of allocating and zeroing fresh ones.
+/// @a T must provide recycle(), which resets the instance to its freshly constructed state
+/// while keeping its buffers.
+template <class T>
+class FramePool
+{
+public:
+    /// Instances kept per thread. Common call chains are much shallower; the frames of a rare
+    /// deeper one are freed when they return rather than pinned for the thread's lifetime.
+    static constexpr size_t c_maxPooled = 32;
+
+    static std::unique_ptr<T> acquire()
+    {
+        auto& pool = freeList();
+        if (pool.empty())
+            return std::unique_ptr<T>(new T);
+        std::unique_ptr<T> ret = std::move(pool.back());
+        pool.pop_back();
+        return ret;
+    }
+
+    static void release(std::unique_ptr<T> _vm) noexcept
+    {
+        auto& pool = freeList();
+        if (pool.size() >= c_maxPooled)
+            return;
+        _vm->recycle();
+        // Never reallocates: the capacity is reserved up front.
+        pool.push_back(std::move(_vm));
+    }
+
+private:
+    static std::vector<std::unique_ptr<T>>& freeList()
+    {
+        thread_local std::vector<std::unique_ptr<T>> s_pool = [] {
+            std::vector<std::unique_ptr<T>> pool;
+            pool.reserve(c_maxPooled);
+            return pool;
+        }();
+        return s_pool;
+    }
+};
+
+}  // namespace eth
+}  // namespace dev
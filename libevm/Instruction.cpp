@@ -200,6 +200,8 @@ static const std::map<Instruction,  InstructionInfo> c_instructionInfo =
     { Instruction::SELFDESTRUCT, { "SELFDESTRUCT",        1,    0,  Tier::Special } },
  
     // these are generated by the interpreter - should never be in user code
+    { Instruction::SWAP1POP,     { "SWAP1POP",            2,    1, Tier::Special } },
+    { Instruction::POP2,         { "POP2",                2,    0, Tier::Special } },
     { Instruction::PUSHC,        { "PUSHC",               0,    1, Tier::VeryLow } },
     { Instruction::JUMPC,        { "JUMPC",               1,    0, Tier::Mid } },
     { Instruction::JUMPCI,       { "JUMPCI",              2,    0, Tier::High } },
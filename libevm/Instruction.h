@@ -157,10 +157,12 @@ enum class Instruction : uint8_t
     LOG4,         ///< Makes a log entry; 4 topics.
 
     // these are generated by the interpreter - should never be in user code
-    PUSHC = 0xac,  ///< push value from constant pool
-    JUMPC,         ///< alter the program counter - pre-verified
-    JUMPCI,        ///< conditionally alter the program counter - pre-verified
-    UNDEFINED,     ///< Replaces PUSHC/JUMPC/JUMPCI in the original code
+    SWAP1POP = 0xaa,  ///< SWAP1 followed by POP
+    POP2,             ///< POP followed by POP
+    PUSHC,            ///< push value from constant pool
+    JUMPC,            ///< alter the program counter - pre-verified
+    JUMPCI,           ///< conditionally alter the program counter - pre-verified
+    UNDEFINED,        ///< Replaces the above instructions in the original code
 
     JUMPTO = 0xb0,  ///< alter the program counter to a jumpdest
     JUMPIF,         ///< conditionally alter the program counter
@@ -3,24 +3,66 @@
 // Licensed under the GNU General Public License, Version 3.
 
 #include "LegacyVM.h"
+#include "FramePool.h"
+
+#include <intx/intx.hpp>
 
 using namespace std;
 using namespace dev;
 using namespace dev::eth;
 
-uint64_t LegacyVM::memNeed(u256 const& _offset, u256 const& _size)
+namespace
+{
+static_assert(sizeof(boost::multiprecision::limb_type) == sizeof(uint64_t),
+    "u256 is expected to be stored in 64-bit limbs");
+
+// Both types hold four 64-bit words, least significant first; boost leaves out leading zero
+// limbs. The stack stays in u256 because ExtVMFace takes it, but the instructions boost can only
+// do through wider or signed temporaries run on intx's fixed-width routines instead.
+intx::uint256 toIntx(u256 const& _u)
 {
-    return toInt63(_size ? u512(_offset) + _size : u512(0));
+    auto const& backend = _u.backend();
+    uint64_t words[4] = {};
+    std::copy(backend.limbs(), backend.limbs() + backend.size(), words);
+    intx::uint256 ret;
+    ret.lo.lo = words[0];
+    ret.lo.hi = words[1];
+    ret.hi.lo = words[2];
+    ret.hi.hi = words[3];
+    return ret;
 }
 
-template <class S> S divWorkaround(S const& _a, S const& _b)
+u256 fromIntx(intx::uint256 const& _x)
 {
-    return (S)(s512(_a) / s512(_b));
+    u256 ret;
+    auto& backend = ret.backend();
+    backend.resize(4, 4);
+    auto* limbs = backend.limbs();
+    limbs[0] = _x.lo.lo;
+    limbs[1] = _x.lo.hi;
+    limbs[2] = _x.hi.lo;
+    limbs[3] = _x.hi.hi;
+    backend.normalize();
+    return ret;
 }
 
-template <class S> S modWorkaround(S const& _a, S const& _b)
+// Two's complement comparison without converting to s256.
+bool signedLess(u256 const& _a, u256 const& _b)
+{
+    static u256 const c_signBit = u256(1) << 255;
+    return (_a ^ c_signBit) < (_b ^ c_signBit);
+}
+}  // namespace
+
+uint64_t LegacyVM::memNeed(u256 const& _offset, u256 const& _size)
 {
-    return (S)(s512(_a) % s512(_b));
+    if (!_size)
+        return 0;
+    // Anything above 63 bits runs out of gas in toInt63() anyway.
+    static u256 const c_max = 0x7FFFFFFFFFFFFFFF;
+    if (_offset > c_max || _size > c_max)
+        throwOutOfGas();
+    return toInt63(uint64_t(_offset) + uint64_t(_size));
 }
 
 
@@ -233,6 +275,35 @@ owning_bytes_ref LegacyVM::exec(u256& _io_gas, ExtVMFace& _ext, OnOpFunc const&
     return std::move(m_output);
 }
 
+void LegacyVM::recycle() noexcept
+{
+    recycleBuffer(m_mem);
+    recycleBuffer(m_returnData);
+    m_code.clear();
+    m_pool.clear();
+    m_jumpDests.clear();
+    m_beginSubs.clear();
+#if EIP_615
+    m_frameSize.clear();
+    m_RP = m_return - 1;
+#endif
+    m_output = owning_bytes_ref();
+
+    m_io_gas_p = nullptr;
+    m_io_gas = 0;
+    m_ext = nullptr;
+    m_onOp = nullptr;
+    m_bounce = nullptr;
+    m_onFail = nullptr;
+    m_nSteps = 0;
+    m_schedule = nullptr;
+    m_PC = 0;
+    m_SP = m_SPP = m_stackEnd;
+    m_runGas = 0;
+    m_newMemSize = 0;
+    m_copyMemSize = 0;
+}
+
 //
 // main interpreter loop and switch
 //
@@ -464,13 +535,12 @@ void LegacyVM::interpretCases()
 
         CASE(EXP)
         {
-            u256 expon = m_SP[1];
-            m_runGas = toInt63(m_schedule->expGas + m_schedule->expByteGas * (32 - (h256(expon).firstBitSet() / 8)));
+            intx::uint256 const expon = toIntx(m_SP[1]);
+            m_runGas = toInt63(m_schedule->expGas + m_schedule->expByteGas * intx::count_significant_words<uint8_t>(expon));
             ON_OP();
             updateIOGas();
 
-            u256 base = m_SP[0];
-            m_SPP[0] = exp256(base, expon);
+            m_SPP[0] = fromIntx(intx::exp(toIntx(m_SP[0]), expon));
         }
         NEXT
 
@@ -494,7 +564,7 @@ void LegacyVM::interpretCases()
             updateIOGas();
 
             //pops two items and pushes their product mod 2^256.
-            m_SPP[0] = m_SP[0] * m_SP[1];
+            m_SPP[0] = fromIntx(toIntx(m_SP[0]) * toIntx(m_SP[1]));
         }
         NEXT
 
@@ -512,7 +582,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? divWorkaround(m_SP[0], m_SP[1]) : 0;
+            m_SPP[0] = m_SP[1] ? fromIntx(toIntx(m_SP[0]) / toIntx(m_SP[1])) : 0;
         }
         NEXT
 
@@ -521,7 +591,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? s2u(divWorkaround(u2s(m_SP[0]), u2s(m_SP[1]))) : 0;
+            m_SPP[0] = m_SP[1] ? fromIntx(intx::sdivrem(toIntx(m_SP[0]), toIntx(m_SP[1])).quot) : 0;
             --m_SP;
         }
         NEXT
@@ -531,7 +601,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? modWorkaround(m_SP[0], m_SP[1]) : 0;
+            m_SPP[0] = m_SP[1] ? fromIntx(toIntx(m_SP[0]) % toIntx(m_SP[1])) : 0;
         }
         NEXT
 
@@ -540,7 +610,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[1] ? s2u(modWorkaround(u2s(m_SP[0]), u2s(m_SP[1]))) : 0;
+            m_SPP[0] = m_SP[1] ? fromIntx(intx::sdivrem(toIntx(m_SP[0]), toIntx(m_SP[1])).rem) : 0;
         }
         NEXT
 
@@ -576,7 +646,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = u2s(m_SP[0]) < u2s(m_SP[1]) ? 1 : 0;
+            m_SPP[0] = signedLess(m_SP[0], m_SP[1]) ? 1 : 0;
         }
         NEXT
 
@@ -585,7 +655,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = u2s(m_SP[0]) > u2s(m_SP[1]) ? 1 : 0;
+            m_SPP[0] = signedLess(m_SP[1], m_SP[0]) ? 1 : 0;
         }
         NEXT
 
@@ -711,7 +781,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[2] ? u256((u512(m_SP[0]) + u512(m_SP[1])) % m_SP[2]) : 0;
+            m_SPP[0] = m_SP[2] ? fromIntx(intx::addmod(toIntx(m_SP[0]), toIntx(m_SP[1]), toIntx(m_SP[2]))) : 0;
         }
         NEXT
 
@@ -720,7 +790,7 @@ void LegacyVM::interpretCases()
             ON_OP();
             updateIOGas();
 
-            m_SPP[0] = m_SP[2] ? u256((u512(m_SP[0]) * u512(m_SP[1])) % m_SP[2]) : 0;
+            m_SPP[0] = m_SP[2] ? fromIntx(intx::mulmod(toIntx(m_SP[0]), toIntx(m_SP[1]), toIntx(m_SP[2]))) : 0;
         }
         NEXT
 
@@ -18,6 +18,9 @@ class LegacyVM: public VMFace
 public:
     virtual owning_bytes_ref exec(u256& _io_gas, ExtVMFace& _ext, OnOpFunc const& _onOp) override final;
 
+    /// Resets the VM for the next frame, keeping its buffers unless they grew unusually large.
+    void recycle() noexcept;
+
 #if EIP_615
     // invalid code will throw an exeption
     void validate(ExtVMFace& _ext);
@@ -40,7 +43,6 @@ private:
 
     static std::array<InstructionMetric, 256> c_metrics;
     static void initMetrics();
-    static u256 exp256(u256 _base, u256 _exponent);
     void copyCode(int);
     typedef void (LegacyVM::*MemFnPtr)();
     MemFnPtr m_bounce = 0;
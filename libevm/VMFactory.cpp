@@ -4,6 +4,7 @@
 
 #include "VMFactory.h"
 #include "EVMC.h"
+#include "FramePool.h"
 #include "LegacyVM.h"
 
 #include <libaleth-interpreter/interpreter.h>
@@ -170,6 +171,9 @@ VMPtr VMFactory::create(VMKind _kind)
 {
     static const auto default_delete = [](VMFace * _vm) noexcept { delete _vm; };
     static const auto null_delete = [](VMFace*) noexcept {};
+    static const auto pool_release = [](VMFace* _vm) noexcept {
+        FramePool<LegacyVM>::release(std::unique_ptr<LegacyVM>(static_cast<LegacyVM*>(_vm)));
+    };
 
     switch (_kind)
     {
@@ -181,7 +185,7 @@ VMPtr VMFactory::create(VMKind _kind)
         return {g_evmcDll.get(), null_delete};
     case VMKind::Legacy:
     default:
-        return {new LegacyVM, default_delete};
+        return {FramePool<LegacyVM>::acquire().release(), pool_release};
     }
 }
 }  // namespace eth
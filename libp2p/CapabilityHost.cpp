@@ -59,11 +59,12 @@ public:
         return _s.appendRaw(bytes(1, _id + *offset)).appendList(_args);
     }
 
-    void sealAndSend(NodeID const& _nodeID, RLPStream& _s) override
+    void sealAndSend(NodeID const& _nodeID, RLPStream& _s,
+        PacketPriority _priority = PacketPriority::Normal) override
     {
         auto session = m_host.peerSession(_nodeID);
         if (session)
-            session->sealAndSend(_s);
+            session->sealAndSend(_s, _priority);
     }
 
     void addNote(NodeID const& _nodeID, std::string const& _k, std::string const& _v) override
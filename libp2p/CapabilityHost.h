@@ -48,8 +48,10 @@ public:
         RLPStream& _s, unsigned _id, unsigned _args = 0) = 0;
 
     /// Constructs an authenticated RLPx packet with the prepared message and sends it to the peer.
+    /// Urgent messages overtake the normal ones still queued for the peer.
     /// Has no effect if the peer is not connected.
-    virtual void sealAndSend(NodeID const& _nodeID, RLPStream& _s) = 0;
+    virtual void sealAndSend(NodeID const& _nodeID, RLPStream& _s,
+        PacketPriority _priority = PacketPriority::Normal) = 0;
 
     /// Associate arbritrary key/value metadata with the peer.
     /// This saved data will be returned from peerSessionInfo().
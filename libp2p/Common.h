@@ -89,6 +89,14 @@ enum P2pPacketType
 
 char const* p2pPacketTypeToString(P2pPacketType _packetType);
 
+/// Urgent packets are written ahead of the normal ones already queued for the peer. Meant for
+/// small latency-sensitive messages such as pings and new block announcements.
+enum class PacketPriority
+{
+    Normal,
+    Urgent
+};
+
 enum DisconnectReason
 {
     DisconnectRequested = 0,
@@ -161,9 +161,12 @@ void Host::stop()
 
 void Host::startCapabilities()
 {
+    // A capability registered under several versions does its background work once.
+    set<CapabilityFace const*> scheduled;
     for (auto const& itCap : m_capabilities)
     {
-        scheduleCapabilityWorkLoop(*itCap.second.capability, itCap.second.backgroundWorkTimer);
+        if (scheduled.insert(itCap.second.capability.get()).second)
+            scheduleCapabilityWorkLoop(*itCap.second.capability, itCap.second.backgroundWorkTimer);
     }
 }
 
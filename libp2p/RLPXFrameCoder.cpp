@@ -163,20 +163,24 @@ void RLPXFrameCoder::writeFrame(uint16_t _protocolType, uint16_t _seqId, uint32_
 void RLPXFrameCoder::writeFrame(RLPStream const& _header, bytesConstRef _payload, bytes& o_bytes)
 {
 	// TODO: SECURITY check header values && header <= 16 bytes
-	bytes headerWithMac(h256::size);
-	bytesConstRef(&_header.out()).copyTo(bytesRef(&headerWithMac));
-	m_impl->frameEnc.ProcessData(headerWithMac.data(), headerWithMac.data(), 16);
-	updateEgressMACWithHeader(bytesConstRef(&headerWithMac).cropped(0, 16));
-	egressDigest().ref().copyTo(bytesRef(&headerWithMac).cropped(h128::size,h128::size));
-
+	// o_bytes may be a reused buffer: every byte of it is written, and its capacity is kept.
 	auto padding = (16 - (_payload.size() % 16)) % 16;
-	o_bytes.swap(headerWithMac);
 	o_bytes.resize(32 + _payload.size() + padding + h128::size);
+	bytesRef headerRef(o_bytes.data(), h128::size);
+	std::fill(headerRef.begin(), headerRef.end(), 0);
+	bytesConstRef(&_header.out()).copyTo(headerRef);
+	m_impl->frameEnc.ProcessData(headerRef.data(), headerRef.data(), h128::size);
+	updateEgressMACWithHeader(headerRef);
+	egressDigest().ref().copyTo(bytesRef(o_bytes.data() + h128::size, h128::size));
+
 	bytesRef packetRef(o_bytes.data() + 32, _payload.size());
 	m_impl->frameEnc.ProcessData(packetRef.data(), _payload.data(), _payload.size());
 	bytesRef paddingRef(o_bytes.data() + 32 + _payload.size(), padding);
 	if (padding)
+	{
+		std::fill(paddingRef.begin(), paddingRef.end(), 0);
 		m_impl->frameEnc.ProcessData(paddingRef.data(), paddingRef.data(), padding);
+	}
 	bytesRef packetWithPaddingRef(o_bytes.data() + 32, _payload.size() + padding);
 	updateEgressMACWithFrame(packetWithPaddingRef);
 	bytesRef macRef(o_bytes.data() + 32 + _payload.size() + padding, h128::size);
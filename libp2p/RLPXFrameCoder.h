@@ -80,6 +80,7 @@ public:
         bytesConstRef _payload, bytes& o_bytes);
 
     /// Legacy. Encrypt _packet as ill-defined legacy RLPx frame.
+    /// @a o_bytes must not overlap @a _packet; its capacity is reused.
     void writeSingleFramePacket(bytesConstRef _packet, bytes& o_bytes);
 
     /// Authenticate and decrypt header in-place.
@@ -15,6 +15,17 @@ using namespace std;
 using namespace dev;
 using namespace dev::p2p;
 
+namespace
+{
+/// A write stops taking more frames once it holds this many bytes, so an urgent packet waits for
+/// at most one write of about this size (or of a single larger packet) to finish.
+size_t const c_maxWriteBytes = 64 * 1024;
+/// Buffers kept per session for framing later packets.
+size_t const c_maxSpareBuffers = 32;
+/// Larger buffers aren't kept, so a burst of big packets doesn't pin memory.
+size_t const c_maxSpareBufferCapacity = 256 * 1024;
+}  // namespace
+
 Session::Session(Host* _h, unique_ptr<RLPXFrameCoder>&& _io, std::shared_ptr<RLPXSocket> const& _s,
     std::shared_ptr<Peer> const& _n, PeerSessionInfo _info)
   : m_server(_h),
@@ -157,7 +168,7 @@ bool Session::interpretP2pPacket(P2pPacketType _t, RLP const& _r)
     {
         LOG(m_capLoggerDetail) << "Pong to";
         RLPStream s;
-        sealAndSend(prep(s, PongPacket));
+        sealAndSend(prep(s, PongPacket), PacketPriority::Urgent);
         break;
     }
     case PongPacket:
@@ -179,7 +190,7 @@ void Session::ping()
 {
     clog(VerbosityTrace, "p2pcap") << "Ping to " << m_logSuffix;
     RLPStream s;
-    sealAndSend(prep(s, PingPacket));
+    sealAndSend(prep(s, PingPacket), PacketPriority::Urgent);
     m_ping = std::chrono::steady_clock::now();
 }
 
@@ -188,11 +199,11 @@ RLPStream& Session::prep(RLPStream& _s, P2pPacketType _id, unsigned _args)
     return _s.append((unsigned)_id).appendList(_args);
 }
 
-void Session::sealAndSend(RLPStream& _s)
+void Session::sealAndSend(RLPStream& _s, PacketPriority _priority)
 {
     bytes b;
     _s.swapOut(b);
-    send(move(b));
+    send(move(b), _priority);
 }
 
 bool Session::checkPacket(bytesConstRef _msg)
@@ -204,7 +215,7 @@ bool Session::checkPacket(bytesConstRef _msg)
     return true;
 }
 
-void Session::send(bytes&& _msg)
+void Session::send(bytes&& _msg, PacketPriority _priority)
 {
     if (m_dropped)
         return;
@@ -221,24 +232,57 @@ void Session::send(bytes&& _msg)
     bool doWrite = false;
     DEV_GUARDED(x_framing)
     {
-        m_writeQueue.push_back(std::move(_msg));
-        doWrite = (m_writeQueue.size() == 1);
+        if (_priority == PacketPriority::Urgent)
+            m_urgentQueue.push_back(std::move(_msg));
+        else
+            m_writeQueue.push_back(std::move(_msg));
+        doWrite = !m_writePending;
+        m_writePending = true;
     }
 
     if (doWrite)
         write();
 }
 
+bytes Session::takeBuffer()
+{
+    if (m_spareBuffers.empty())
+        return bytes();
+    bytes b = move(m_spareBuffers.back());
+    m_spareBuffers.pop_back();
+    return b;
+}
+
+void Session::recycleBuffer(bytes&& _b)
+{
+    if (m_spareBuffers.size() < c_maxSpareBuffers && _b.capacity() <= c_maxSpareBufferCapacity)
+        m_spareBuffers.push_back(move(_b));
+}
+
 void Session::write()
 {
-    bytes const* out = nullptr;
+    vector<ba::const_buffer> buffers;
     DEV_GUARDED(x_framing)
     {
-        m_io->writeSingleFramePacket(&m_writeQueue[0], m_writeQueue[0]);
-        out = &m_writeQueue[0];
+        // Frames are encrypted in the order they go out, so framing happens here rather than
+        // when packets are queued.
+        size_t size = 0;
+        while (size < c_maxWriteBytes && (!m_urgentQueue.empty() || !m_writeQueue.empty()))
+        {
+            auto& queue = m_urgentQueue.empty() ? m_writeQueue : m_urgentQueue;
+            bytes frame = takeBuffer();
+            m_io->writeSingleFramePacket(&queue.front(), frame);
+            recycleBuffer(move(queue.front()));
+            queue.pop_front();
+            size += frame.size();
+            m_writing.push_back(move(frame));
+        }
+        buffers.reserve(m_writing.size());
+        for (auto const& frame : m_writing)
+            buffers.push_back(ba::buffer(frame));
     }
     auto self(shared_from_this());
-    ba::async_write(m_socket->ref(), ba::buffer(*out),
+    ba::async_write(m_socket->ref(), buffers,
         [this, self](boost::system::error_code ec, std::size_t /*length*/) {
             // must check queue, as write callback can occur following dropped()
             if (ec)
@@ -250,9 +294,14 @@ void Session::write()
 
             DEV_GUARDED(x_framing)
             {
-                m_writeQueue.pop_front();
-                if (m_writeQueue.empty())
+                for (auto& frame : m_writing)
+                    recycleBuffer(move(frame));
+                m_writing.clear();
+                if (m_urgentQueue.empty() && m_writeQueue.empty())
+                {
+                    m_writePending = false;
                     return;
+                }
             }
             write();
         });
@@ -298,7 +347,7 @@ void Session::disconnect(DisconnectReason _reason)
 
     RLPStream s;
     prep(s, DisconnectPacket, 1) << (int)_reason;
-    sealAndSend(s);
+    sealAndSend(s, PacketPriority::Urgent);
 
     auto self(shared_from_this());
     // The empty handler will keep the Session alive for the supplied amount of time, after
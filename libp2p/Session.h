@@ -41,7 +41,7 @@ public:
 
     virtual NodeID id() const = 0;
 
-    virtual void sealAndSend(RLPStream& _s) = 0;
+    virtual void sealAndSend(RLPStream& _s, PacketPriority _priority = PacketPriority::Normal) = 0;
 
     virtual int rating() const = 0;
     virtual void addRating(int _r) = 0;
@@ -88,7 +88,7 @@ public:
 
     NodeID id() const override;
 
-    void sealAndSend(RLPStream& _s) override;
+    void sealAndSend(RLPStream& _s, PacketPriority _priority = PacketPriority::Normal) override;
 
     int rating() const override;
     void addRating(int _r) override;
@@ -117,7 +117,7 @@ public:
 private:
     static RLPStream& prep(RLPStream& _s, P2pPacketType _t, unsigned _args = 0);
 
-    void send(bytes&& _msg);
+    void send(bytes&& _msg, PacketPriority _priority);
 
     /// Drop the connection for the reason @a _r.
     void drop(DisconnectReason _r);
@@ -128,9 +128,16 @@ private:
     /// Check error code after reading and drop peer if error code.
     bool checkRead(std::size_t _expected, boost::system::error_code _ec, std::size_t _length);
 
-    /// Perform a single round of the write operation. This could end up calling itself asynchronously.
+    /// Frames queued packets, urgent ones first, and writes them out with a single gathered
+    /// write. Calls itself asynchronously until the queues are empty.
     void write();
 
+    /// @returns a buffer from m_spareBuffers, or a new one. Called with x_framing held.
+    bytes takeBuffer();
+    /// Keeps @a _b in m_spareBuffers unless there are enough or it is too big. Called with
+    /// x_framing held.
+    void recycleBuffer(bytes&& _b);
+
     /// Deliver RLPX packet to Session or PeerCapability for interpretation.
     bool readPacket(uint16_t _capId, unsigned _t, RLP const& _r);
 
@@ -154,8 +161,12 @@ private:
 
     std::unique_ptr<RLPXFrameCoder> m_io;	///< Transport over which packets are sent.
     std::shared_ptr<RLPXSocket> m_socket;		///< Socket of peer's connection.
-    Mutex x_framing;						///< Mutex for the write queue.
-    std::deque<bytes> m_writeQueue;			///< The write queue.
+    Mutex x_framing;						///< Mutex for the write queues.
+    std::deque<bytes> m_writeQueue;			///< Packets waiting to be written.
+    std::deque<bytes> m_urgentQueue;		///< Urgent packets, written ahead of m_writeQueue.
+    std::vector<bytes> m_writing;			///< Frames of the write in flight.
+    std::vector<bytes> m_spareBuffers;		///< Buffers of finished writes, kept for reuse.
+    bool m_writePending = false;			///< True from queueing a packet until the queues are drained.
     std::vector<byte> m_data;			    ///< Buffer for ingress packet data.
     bytes m_incoming;						///< Read buffer for ingress bytes.
 
@@ -24,6 +24,10 @@ enum QposPacketType
 	qposHeart,
 	qposBroadBlock,
 	QposTestPacket,
+	qposBlockVoteCompact,
+	qposGetBlockTxs,
+	qposBlockTxs,
+	qposBroadBlockCompact,
 
 	qposPacketCount
 };
@@ -0,0 +1,53 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "MinerSetCache.h"
+
+#include <libdevcore/RLP.h>
+#include <libdevcore/SHA3.h>
+#include <libethereum/State.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+h256 dev::eth::nodeContractStateKey(State const& _state, Address const& _node)
+{
+	RLPStream s(2);
+	s << _state.codeHash(_node) << _state.storageRoot(_node);
+	return sha3(s.out());
+}
+
+bool dev::eth::minerQuorumSigned(set<p2p::NodeID> const& _miners, vector<pair<p2p::NodeID, Signature>> const& _signs, h256 const& _hash)
+{
+	vector<pair<p2p::NodeID, Signature>> candidates;
+	for (auto const& sign : _signs)
+		if (_miners.count(sign.first))
+			candidates.push_back(sign);
+
+	size_t const quorum = (_miners.size() + 1) / 2;
+	return verifyBatch(candidates, _hash, quorum) >= quorum;
+}
+
+set<p2p::NodeID> MinerSetCache::get(h256 const& _key, Reader const& _read)
+{
+	DEV_GUARDED(x_cache)
+	{
+		if (m_cache.touch(_key))
+		{
+			++m_hits;
+			return m_cache.cbegin()->second;
+		}
+	}
+
+	// Read outside of the lock, as it runs a call on the node contract.
+	++m_misses;
+	set<p2p::NodeID> ret;
+	if (_read(ret))
+	{
+		DEV_GUARDED(x_cache)
+			m_cache.insert(_key, ret);
+	}
+	return ret;
+}
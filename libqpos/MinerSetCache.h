@@ -0,0 +1,56 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#pragma once
+
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Guards.h>
+#include <libdevcore/LruCache.h>
+#include <libdevcrypto/Common.h>
+#include <libp2p/Common.h>
+
+#include <atomic>
+#include <functional>
+#include <set>
+#include <vector>
+
+namespace dev
+{
+namespace eth
+{
+class State;
+
+/// @returns a key of the state of the node contract at @a _node in @a _state. The miner set read
+/// from the contract can only differ between two states if their keys differ.
+h256 nodeContractStateKey(State const& _state, Address const& _node);
+
+/// @returns true if at least (size + 1) / 2 of @a _miners have a valid signature of @a _hash in
+/// @a _signs. Signatures of other nodes are ignored and a miner signing twice counts once.
+bool minerQuorumSigned(std::set<p2p::NodeID> const& _miners, std::vector<std::pair<p2p::NodeID, Signature>> const& _signs, h256 const& _hash);
+
+/// Miner sets read from the node contract, keyed by nodeContractStateKey(). As keys are derived
+/// from the contract's own state, a block importing a change of the contract gets a new key and
+/// an entry never has to be invalidated.
+class MinerSetCache
+{
+public:
+	/// Reads the miner set into the argument. @returns false if the set must not be cached,
+	/// e.g. because it was not read from the state the key was derived from.
+	using Reader = std::function<bool(std::set<p2p::NodeID>&)>;
+
+	/// @returns the miner set cached for @a _key, or the one read by @a _read on a miss.
+	std::set<p2p::NodeID> get(h256 const& _key, Reader const& _read);
+
+	uint64_t hits() const { return m_hits; }
+	uint64_t misses() const { return m_misses; }
+
+private:
+	Mutex x_cache;
+	LruCache<h256, std::set<p2p::NodeID>> m_cache{256};
+	std::atomic<uint64_t> m_hits = {0};
+	std::atomic<uint64_t> m_misses = {0};
+};
+
+}
+}
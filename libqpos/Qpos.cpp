@@ -5,17 +5,11 @@
 #include "Common.h"
 #include "Qpos.h"
 
-#include <sys/syscall.h>  
 #include <json/json.h>
+#include <libdevcore/TrieHash.h>
 
-#define gettidv1() syscall(__NR_gettid)  
-#define gettidv2() syscall(SYS_gettid) 
-
-#define QPOS_SIGNAL SIGUSR1
-#define QPOS_SIGNAL_REPORT SIGUSR2
-
-#define QPOS_VOTE_TIMEOUT (10*TIME_PER_SECOND)
-#define QPOS_HEART_TIMEOUT (2*TIME_PER_SECOND)
+#define QPOS_VOTE_TIMEOUT std::chrono::seconds(10*TIME_PER_SECOND)
+#define QPOS_HEART_TIMEOUT std::chrono::seconds(2*TIME_PER_SECOND)
 
 using namespace dev;
 using namespace dev::eth;
@@ -23,13 +17,14 @@ using namespace dev::eth;
 using namespace boost::asio;
 using namespace ba::ip;
 
+using QposClock = std::chrono::steady_clock;
+
 void Qpos::tick()
 {
-	voteTick();
 	if(!m_isLeader)
 		return;
 	
-	int64_t now = utcTime();
+	auto now = QposClock::now();
 	if(qposInitial == m_consensusState){
 		bool have;
 		bytes blockBytes;
@@ -38,7 +33,7 @@ void Qpos::tick()
 		if(have && !blockBytes.empty())
 			generateSealBegin(blockBytes);
 	}else{
-		if(now > m_consensusTimeOut){
+		if(now >= m_consensusTimeOut){
 			cdebug << "m_idUnVoted.size()=" << m_idUnVoted.size() << ",m_idVoted.size()=" << m_idVoted.size() << ",nodeCount()=" << nodeCount();
 
 			resetConfig();
@@ -83,6 +78,18 @@ bool Qpos::interpret(const NodeID &_nodeid, unsigned _id, RLP const& _r)
 			case qposBroadBlock:
 				onBroadBlock(_nodeid, _r);
 				break;
+			case qposBlockVoteCompact:
+				onBlockVoteCompact(_nodeid, _r);
+				break;
+			case qposGetBlockTxs:
+				onGetBlockTxs(_nodeid, _r);
+				break;
+			case qposBlockTxs:
+				onBlockTxs(_nodeid, _r);
+				break;
+			case qposBroadBlockCompact:
+				onBroadBlockCompact(_nodeid, _r);
+				break;
 			default:
 				break;
 		}
@@ -99,7 +106,7 @@ void Qpos::reportBlock(unsigned _blockNumber, bool _force)
 		m_blockReport = _blockNumber;
 
 		cdebug << "_blockNumber=" << _blockNumber << ",m_blockNumber=" << m_blockNumber << ",_force=" << _force;
-		kill(m_hostTid, QPOS_SIGNAL_REPORT);
+		post(*m_ioContext, [this]() { reportBlockSelf(); });
 	}
 
 	cdebug << "_blockNumber=" << _blockNumber << ",m_blockNumber=" << m_blockNumber << ",_force=" << _force;
@@ -111,7 +118,9 @@ void Qpos::reportBlockSelf()
 
 	cdebug << "blockNumber=" << blockNumber << ",m_blockNumber=" << m_blockNumber;
 
-	m_blockNumber = blockNumber;
+	// A pipelined leader has already moved on to the last block it committed.
+	if(!m_pipelined || (int64_t)blockNumber > m_blockNumber)
+		m_blockNumber = blockNumber;
 	m_blockNumberRecv = blockNumber;
 
 	set<QposNode> miners;
@@ -132,56 +141,81 @@ void Qpos::reportBlockSelf()
 		m_isLeader = false;
 	}
 
+	// A proposal built on top of the reported block stays valid once that block is imported.
+	if(!m_blockBytes.empty() && BlockHeader(m_blockBytes).number() > (int64_t)blockNumber){
+		cdebug << "keep proposal number=" << BlockHeader(m_blockBytes).number() << ",blockNumber=" << blockNumber;
+		return;
+	}
+
 	resetConfig();
 }
 
+void Qpos::rollbackPipeline(unsigned _head)
+{
+	m_blockReport = _head;
+	post(*m_ioContext, [this, _head]() {
+		cdebug << "_head=" << _head << ",m_blockNumber=" << m_blockNumber;
+		m_blockNumber = _head;
+		m_blockNumberRecv = _head;
+		resetConfig();
+	});
+}
+
 void Qpos::resetConfig()
 {
 	m_blockBytes = bytes();
 	//m_currentView = 0;
-	m_consensusTimeOut = 0;
+	m_consensusTimeOut = QposClock::time_point();
+	if(m_consensusTimer)
+		m_consensusTimer->cancel();
 	m_idVoted.clear();
 	m_idUnVoted.clear();
 	m_last_consensus_time = utcTime();
 	m_consensusState = qposInitial;
+	++m_proposalRound;
 
 	cdebug << "m_consensusState=" << m_consensusState << ",nodeCount()=" << nodeCount();
 	cdebug << ",id()=" << id() << ",m_currentView=" << (unsigned)m_currentView << ",m_miners.size()=" << m_miners.size() << ",m_isLeader=" << m_isLeader;
+
+	if(m_onReady)
+		m_onReady();
 }
 
-void Qpos::signalHandler(const boost::system::error_code& err, int signal)
+void Qpos::scheduleVoteTick(QposClock::duration _after)
 {
-	cdebug << "_host.onTick err = " << err << ",signal = " << signal << ",m_hostTid=" << m_hostTid;
+	m_voteTimeOut = QposClock::now() + _after;
+	m_voteTimer->expires_at(m_voteTimeOut);
+	m_voteTimer->async_wait([this](boost::system::error_code const& _e) {
+		if(_e != boost::asio::error::operation_aborted)
+			voteTick();
+	});
+}
 
-	if(QPOS_SIGNAL == signal){
-		tick();
-	}else if(QPOS_SIGNAL_REPORT == signal){
-		reportBlockSelf();
-	}
-	m_sigset->async_wait(boost::bind(&Qpos::signalHandler, this, _1, _2));
+void Qpos::scheduleConsensusTimeout()
+{
+	m_consensusTimeOut = QposClock::now() + m_consensusTimeInterval;
+	m_consensusTimer->expires_at(m_consensusTimeOut);
+	m_consensusTimer->async_wait([this](boost::system::error_code const& _e) {
+		if(_e != boost::asio::error::operation_aborted)
+			tick();
+	});
 }
 
 void Qpos::initEnv(class Client *_c, p2p::Host *_host, std::shared_ptr<EthereumCapability> _capability, BlockChain* _bc, bool _importAnyNode)
 {
 	m_importAnyNode = _importAnyNode;
-	m_sigset = new signal_set(_host->ioContext(), QPOS_SIGNAL, QPOS_SIGNAL_REPORT);
-	m_sigset->async_wait(boost::bind(&Qpos::signalHandler, this, _1, _2));
+	m_pipelined = _c->chainParams().qposPipeline;
+	m_compactProposals = _c->chainParams().qposCompactProposals;
+	m_ioContext = &_host->ioContext();
+	m_consensusTimer.reset(new steady_timer(*m_ioContext));
+	m_voteTimer.reset(new steady_timer(*m_ioContext));
 
 	//DumpStack();
 	
 	srand(utcTime());
 	QposSealEngine::initEnv(_c, _host, _capability, _bc, _importAnyNode);
 
-	_host->onTick(1000, [=](const boost::system::error_code& _e) {
-		(void)_e;
-		this->tick();
-	});
-
-	_host->onInit([=]() {
-		m_hostTid = gettidv1();
-
-		cdebug << "_host.onTick  m_hostTid =" << m_hostTid;
-	});
+	post(*m_ioContext, [this]() { voteTick(); });
 
 	_c->setFilter([=](p2p::NodeID _nodeid, unsigned _id, RLP const&) -> bool{
 		if(m_importAnyNode || m_miners.empty())
@@ -239,31 +273,79 @@ void Qpos::broadBlock(bytes const& _bolck)
 {
 	assert(m_isLeader);
 	if(_bolck.size()){
+		set<NodeID> voters;
+		if(m_compactProposals){
+			// Miners that voted for the proposal already hold its body and only need the signatures.
+			RLP r(_bolck);
+			RLPStream compact;
+			compact << qposBroadBlockCompact;
+			compact << BlockHeader(_bolck).hash(WithoutSeal);
+			compact.appendRaw(r[3].data());
+
+			for(auto const& it : m_idVoted){
+				if(it.first != id())
+					voters.insert(it.first);
+			}
+			multicast(voters, compact);
+		}
+
 		RLPStream msg;
 		msg << qposBroadBlock;
 		msg << _bolck;
 
-		broadcast(msg);
+		broadcast(msg, voters);
 	}
 
 	m_consensusState = qposFinished;
 	m_onSealGenerated(_bolck, true);
-	cdebug << "_bolck.size()=" << _bolck.size() << ",m_isLeader=" << m_isLeader;
+	cdebug << "_bolck.size()=" << _bolck.size() << ",m_isLeader=" << m_isLeader << ",m_pipelined=" << m_pipelined;
+
+	if(m_pipelined && _bolck.size()){
+		// The client builds the next block on the state of this one while it is being imported.
+		m_blockNumber = BlockHeader(_bolck).number();
+		resetConfig();
+	}
 }
 
 void Qpos::onBroadBlock(const NodeID &_id, RLP const& _r)
 {
 	(void)_id;
 	
-	bytes blockBytes = _r[0][1].toBytes();
-	BlockHeader header(blockBytes);
+	importBroadBlock(_r[0][1].toBytes());
+}
+
+void Qpos::onBroadBlockCompact(const NodeID &_id, RLP const& _r)
+{
+	h256 hash = _r[0][1].toHash<h256>();
+	if(m_blockBytes.empty() || BlockHeader(m_blockBytes).hash(WithoutSeal) != hash){
+		// The block still reaches us through the regular block propagation.
+		cdebug << "unknown proposal hash=" << hash << ",_id=" << _id;
+		return;
+	}
+
+	RLP r(m_blockBytes);
+	RLPStream rs;
+	rs.appendList(4);
+	rs.appendRaw(r[0].data()); // header
+	rs.appendRaw(r[1].data()); // tx
+	rs.appendRaw(r[2].data()); // uncles
+	rs.appendRaw(_r[0][2].data()); // qpos info
+
+	bytes blockBytes;
+	rs.swapOut(blockBytes);
+	importBroadBlock(blockBytes);
+}
+
+void Qpos::importBroadBlock(bytes const& _blockBytes)
+{
+	BlockHeader header(_blockBytes);
 	int64_t number = header.number();
-	cdebug << "blockBytes.size()=" << blockBytes.size() << ",number=" << number << ",m_blockNumber=" << m_blockNumber;
+	cdebug << "blockBytes.size()=" << _blockBytes.size() << ",number=" << number << ",m_blockNumber=" << m_blockNumber;
 	if(number > m_blockNumber){
 		m_blockNumber = number;
 	}
 
-	m_onSealGenerated(blockBytes, false);
+	m_onSealGenerated(_blockBytes, false);
 }
 
 void Qpos::voteBlockEnd()
@@ -359,28 +441,136 @@ void Qpos::onBlockVote(const NodeID &_id, RLP const& _r)
 	int64_t currentView = _r[0][1].toInt();
 	Signature mySign = h520(_r[0][2].toBytes());
 	bytes blockBytes = _r[0][3].toBytes();
-	BlockHeader header(blockBytes);
+
+	//verifyblock = verifyBlock(blockBytes);
+	voteOnBlock(_id, currentView, mySign, blockBytes, true);
+}
+
+void Qpos::onBlockVoteCompact(const NodeID &_id, RLP const& _r)
+{
+	QposCompactProposal proposal;
+	proposal.leader = _id;
+	proposal.view = _r[0][1].toInt();
+	proposal.sign = h520(_r[0][2].toBytes());
+	proposal.header = _r[0][3].data().toBytes();
+	proposal.uncles = _r[0][4].data().toBytes();
+	proposal.hash = BlockHeader(proposal.header, HeaderData).hash(WithoutSeal);
+	h256s txHashes = _r[0][5].toVector<h256>();
+
+	std::vector<unsigned> missing;
+	proposal.txs.resize(txHashes.size());
+	for(unsigned i = 0; i < txHashes.size(); ++i){
+		Transaction t = client()->queuedTransaction(txHashes[i]);
+		if(t)
+			proposal.txs[i] = t.rlp();
+		else
+			missing.push_back(i);
+	}
+
+	m_compactProposal = std::move(proposal);
+	m_hasCompactProposal = true;
+
+	cdebug << "hash=" << m_compactProposal.hash << ",txs=" << txHashes.size() << ",missing=" << missing.size() << ",_id=" << _id;
+	if(missing.empty()){
+		completeCompactProposal();
+		return;
+	}
+
+	RLPStream msg;
+	msg << qposGetBlockTxs;
+	msg << m_compactProposal.hash;
+	msg << missing;
+	send(_id, msg);
+}
+
+void Qpos::onGetBlockTxs(const NodeID &_id, RLP const& _r)
+{
+	h256 hash = _r[0][1].toHash<h256>();
+	std::vector<unsigned> indices = _r[0][2].toVector<unsigned>();
+	if(m_blockBytes.empty() || BlockHeader(m_blockBytes).hash(WithoutSeal) != hash){
+		cdebug << "unknown proposal hash=" << hash << ",_id=" << _id;
+		return;
+	}
+
+	RLP txs = RLP(m_blockBytes)[1];
+	RLPStream msg;
+	msg << qposBlockTxs;
+	msg << hash;
+	msg << indices;
+	msg.appendList(indices.size());
+	for(auto i : indices){
+		if(i >= txs.itemCount())
+			return;
+		msg.appendRaw(txs[i].data());
+	}
+
+	send(_id, msg);
+}
+
+void Qpos::onBlockTxs(const NodeID &_id, RLP const& _r)
+{
+	h256 hash = _r[0][1].toHash<h256>();
+	if(!m_hasCompactProposal || m_compactProposal.leader != _id || m_compactProposal.hash != hash)
+		return;
+
+	std::vector<unsigned> indices = _r[0][2].toVector<unsigned>();
+	RLP txs = _r[0][3];
+	if(indices.size() != txs.itemCount())
+		return;
+
+	for(unsigned i = 0; i < indices.size(); ++i){
+		if(indices[i] < m_compactProposal.txs.size())
+			m_compactProposal.txs[indices[i]] = txs[i].data().toBytes();
+	}
+
+	for(auto const& tx : m_compactProposal.txs){
+		if(tx.empty())
+			return;
+	}
+
+	completeCompactProposal();
+}
+
+void Qpos::completeCompactProposal()
+{
+	m_hasCompactProposal = false;
+
+	// The transactions root binds the body we rebuilt to the header the leader signed.
+	BlockHeader header(m_compactProposal.header, HeaderData);
+	bool verifyblock = orderedTrieRoot(m_compactProposal.txs) == header.transactionsRoot();
+
+	RLPStream rs;
+	rs.appendList(3);
+	rs.appendRaw(m_compactProposal.header);
+	rs.appendList(m_compactProposal.txs.size());
+	for(auto const& tx : m_compactProposal.txs)
+		rs.appendRaw(tx);
+	rs.appendRaw(m_compactProposal.uncles);
+
+	voteOnBlock(m_compactProposal.leader, m_compactProposal.view, m_compactProposal.sign, rs.out(), verifyblock);
+}
+
+void Qpos::voteOnBlock(const NodeID &_id, int64_t _currentView, Signature const& _sign, bytes const& _blockBytes, bool _verifyBlock)
+{
+	BlockHeader header(_blockBytes);
 	int64_t blockNumber = header.number();
 	bool vote = false;
-	int64_t now = utcTime();
 
-	bool verify = msgVerify(_id, blockBytes, mySign);
-	bool verifyblock = true;
-	//verifyblock = verifyBlock(blockBytes);
+	bool verify = msgVerify(_id, _blockBytes, _sign);
 
-	cdebug << "verify =" << verify << ",verifyblock=" << verifyblock << ",nodeCount()=" << nodeCount() << ",currentView=" << currentView << ",m_currentView=" << m_currentView << ",blockNumber=" << blockNumber << ",m_blockNumber=" << m_blockNumber;
-	if(verify && verifyblock && m_blockNumber + 1 == blockNumber && currentView == m_currentView){
+	cdebug << "verify =" << verify << ",verifyblock=" << _verifyBlock << ",nodeCount()=" << nodeCount() << ",currentView=" << _currentView << ",m_currentView=" << m_currentView << ",blockNumber=" << blockNumber << ",m_blockNumber=" << m_blockNumber;
+	if(verify && _verifyBlock && m_blockNumber + 1 == blockNumber && _currentView == m_currentView){
 		vote = true;
 		m_idVoted.clear();
 		m_idUnVoted.clear();
-		m_consensusTimeOut = utcTime() + m_consensusTimeInterval;
-		m_blockBytes = blockBytes;
-		m_idVoted[_id] = mySign;
+		scheduleConsensusTimeout();
+		m_blockBytes = _blockBytes;
+		m_idVoted[_id] = _sign;
 		cdebug << "m_currentView =" << m_currentView << ",m_blockBytes.size()=" << m_blockBytes.size();
 	}
 	
-	h256 hash =  sha3(blockBytes);
-	mySign = sign(header.hash(WithoutSeal));
+	h256 hash =  sha3(_blockBytes);
+	Signature mySign = sign(header.hash(WithoutSeal));
 
 	if(vote)
 		m_idVoted[id()] = mySign;
@@ -392,20 +582,20 @@ void Qpos::onBlockVote(const NodeID &_id, RLP const& _r)
 	data << mySign; 
 	data << _id; 
 
-	m_voteTimeOut = now + QPOS_VOTE_TIMEOUT;
+	scheduleVoteTick(QPOS_VOTE_TIMEOUT);
 
 	send(_id, data);
-	cdebug << "hash=" << hash << ",mySign=" << mySign << ",blockBytes.size()=" << blockBytes.size() << ",vote=" << vote << ",_id=" << _id;
+	cdebug << "hash=" << hash << ",mySign=" << mySign << ",blockBytes.size()=" << _blockBytes.size() << ",vote=" << vote << ",_id=" << _id;
 }
 
 void Qpos::voteTick()
 {
-	int64_t now = utcTime();
-	if(m_voteTimeOut > now)
+	// A handler queued before the deadline was pushed back still fires.
+	if(m_voteTimeOut > QposClock::now())
 		return;
 
 	if(m_isLeader){
-		m_voteTimeOut = now + QPOS_HEART_TIMEOUT;
+		scheduleVoteTick(QPOS_HEART_TIMEOUT);
 
 		RLPStream msg;
 		msg << qposHeart;
@@ -413,7 +603,7 @@ void Qpos::voteTick()
 
 		multicast(m_miners, msg);
 	}else{
-		m_voteTimeOut = now + QPOS_VOTE_TIMEOUT;
+		scheduleVoteTick(QPOS_VOTE_TIMEOUT);
 		
 		RLPStream msg;
 		msg << qposVote;
@@ -436,7 +626,7 @@ void Qpos::onHeart(const NodeID &_id, RLP const& _r)
 	}
 
 	m_currentView = currentView;
-	m_voteTimeOut = utcTime() + QPOS_VOTE_TIMEOUT;
+	scheduleVoteTick(QPOS_VOTE_TIMEOUT);
 	cdebug << "currentView=" << currentView << ",m_isLeader=" << (bool)m_isLeader << ",m_currentView=" << m_currentView;
 }
 
@@ -450,7 +640,7 @@ void Qpos::onVote(const NodeID &_id, RLP const& _r)
 		m_blockNumberRecv = blockNumberRecv;
 	if(currentView > m_currentView && m_blockNumberRecv >= m_blockNumber){
 		m_currentView = currentView;
-		m_voteTimeOut = utcTime() + QPOS_VOTE_TIMEOUT + rand()%QPOS_HEART_TIMEOUT;
+		scheduleVoteTick(QPOS_VOTE_TIMEOUT + std::chrono::milliseconds(rand()%std::chrono::duration_cast<std::chrono::milliseconds>(QPOS_HEART_TIMEOUT).count()));
 	}
 	
 	RLPStream data;
@@ -481,7 +671,7 @@ void Qpos::voteBlockBegin()
 	Signature mySign = sign(header.hash(WithoutSeal));
 	m_idVoted[id()] = mySign;
 
-	m_consensusTimeOut = utcTime() + m_consensusTimeInterval;
+	scheduleConsensusTimeout();
 	m_consensusState = qposWaitingVote;
 	
 	if(1 >= m_miners.size()){
@@ -490,12 +680,27 @@ void Qpos::voteBlockBegin()
 	}
 	
 	RLPStream msg;
-	msg << qposBlockVote;
-	msg << m_currentView;
-	msg << mySign;
-	msg << m_blockBytes; 
+	if(m_compactProposals){
+		// Followers rebuild the body from their own transaction queue and only fetch what they miss.
+		RLP block(m_blockBytes);
+		h256s txHashes;
+		for(auto const& tx : block[1])
+			txHashes.push_back(sha3(tx.data()));
+
+		msg << qposBlockVoteCompact;
+		msg << m_currentView;
+		msg << mySign;
+		msg.appendRaw(block[0].data()); // header
+		msg.appendRaw(block[2].data()); // uncles
+		msg << txHashes;
+	}else{
+		msg << qposBlockVote;
+		msg << m_currentView;
+		msg << mySign;
+		msg << m_blockBytes; 
+	}
 
-	m_voteTimeOut = utcTime() + QPOS_HEART_TIMEOUT;
+	scheduleVoteTick(QPOS_HEART_TIMEOUT);
 	multicast(m_miners, msg);
 	cdebug << ",header.hash(WithoutSeal)=" << header.hash(WithoutSeal) << ",mySign=" << mySign << ",m_blockBytes.size()=" << m_blockBytes.size() << ",m_miners.size()=" << m_miners.size();
 }
@@ -521,7 +726,7 @@ void Qpos::generateSeal(bytes const& _block)
 	//return;
 	
 	m_blocks.push(_block);
-	kill(m_hostTid, QPOS_SIGNAL);
+	post(*m_ioContext, [this]() { tick(); });
 }
 
 bool Qpos::shouldSeal(Interface * _client)
@@ -569,24 +774,12 @@ bool Qpos::checkBlockSign(BlockHeader const& _header, bytesConstRef _block) cons
 		return false;
 
 	const std::vector<std::pair<p2p::NodeID, Signature>> &sign_list = b[3][1].toVector<std::pair<p2p::NodeID, Signature>>();
-
-	set<p2p::NodeID> signs;
-	for (auto item : sign_list) {
-		cdebug << "item.first=" << item.first << ",miner_list=" << miner_list;
-		if (!miner_list.count(item.first) || !dev::verify(item.first, item.second, _header.hash(WithoutSeal))) {
-			cdebug << "checkBlockSign failed, verify false, blk=" << _header.number() << ",hash=" << _header.hash(WithoutSeal);
-			continue;
-		}
-		
-		cdebug << "checkBlockSign signs.size()=" << signs.size() << ",miner_list.size()=" << miner_list.size();
-		signs.insert(item.first);
-		if(signs.size() >= (miner_list.size()+1)/2){
-			cdebug << "checkBlockSign succeed signs.size()=" << signs.size() << ",miner_list.size()=" << miner_list.size();
-			return true;
-		}
+	if(minerQuorumSigned(miner_list, sign_list, _header.hash(WithoutSeal))){
+		cdebug << "checkBlockSign succeed sign_list.size()=" << sign_list.size() << ",miner_list.size()=" << miner_list.size() << ",timecost=" << t.elapsed() / 1000 << "ms";
+		return true;
 	}
 
-	cdebug << "checkBlockSign failed, blk=" << _header.number() << ",hash=" << _header.hash(WithoutSeal) << ",timecost=" << t.elapsed() / 1000 << "ms";
+	cdebug << "checkBlockSign failed, blk=" << _header.number() << ",hash=" << _header.hash(WithoutSeal) << ",timecost=" << t.elapsed() / 1000 << "ms" << ",minerCacheHits=" << minerCacheHits() << ",minerCacheMisses=" << minerCacheMisses();
 	return false;
 }
 
@@ -2,6 +2,8 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 #include <set>
@@ -34,6 +36,19 @@ enum qposState
 	qposFinished
 };
 
+/// Block proposal announced by header and transaction hashes, waiting for the
+/// transactions that are not in the local queue.
+struct QposCompactProposal
+{
+	NodeID leader;
+	int64_t view = 0;
+	Signature sign;
+	h256 hash;
+	bytes header;
+	bytes uncles;
+	std::vector<bytes> txs;	///< Empty entries are still missing.
+};
+
 class Qpos:public QposSealEngine
 {
 public:
@@ -47,17 +62,29 @@ public:
 
 	//void generateSeal(BlockHeader const& _bi, bytes const& _block_data) override;
 	void onSealGenerated(std::function<void(bytes const& _block, bool _isOurs)> const& _f)  { m_onSealGenerated = _f;}
+	/// Called on the host io_context whenever the engine is ready for a new proposal.
+	void onReady(std::function<void()> const& _f) { m_onReady = _f; }
 
 	void reportBlock(unsigned _blockNumber, bool _force = false);
 	h512s getMinerNodeList();
 	int64_t lastConsensusTime() const { /*Guard l(m_mutex);*/ return m_last_consensus_time;};
 
 	bool checkBlockSign(BlockHeader const& _header, bytesConstRef _block) const override;
+
+	/// Pipelined mode: the leader proposes the next block as soon as the previous one has a
+	/// quorum instead of waiting for it to be imported.
+	bool pipelined() const { return m_pipelined; }
+	/// Bumped every time the consensus state goes back to qposInitial.
+	uint64_t proposalRound() const { return m_proposalRound; }
+	/// Forgets the blocks committed on top of @a _head, which failed to import.
+	void rollbackPipeline(unsigned _head);
 protected:
 	virtual void tick();
 	void reportBlockSelf();
 	
 	void resetConfig();
+	void scheduleVoteTick(std::chrono::steady_clock::duration _after);
+	void scheduleConsensusTimeout();
 
 	void onBlockVoteAck(const NodeID &_id, RLP const& _r);
 	void onBlockVote(const NodeID &_id, RLP const& _r);
@@ -68,17 +95,24 @@ protected:
 	bytes authBytes();
 	void broadBlock(bytes const& _bolck);
 	void onBroadBlock(const NodeID &_id, RLP const& _r);
+	void onBlockVoteCompact(const NodeID &_id, RLP const& _r);
+	void onGetBlockTxs(const NodeID &_id, RLP const& _r);
+	void onBlockTxs(const NodeID &_id, RLP const& _r);
+	void onBroadBlockCompact(const NodeID &_id, RLP const& _r);
+	void completeCompactProposal();
+	void voteOnBlock(const NodeID &_id, int64_t _currentView, Signature const& _sign, bytes const& _blockBytes, bool _verifyBlock);
+	void importBroadBlock(bytes const& _blockBytes);
 	void voteBlockEnd();
 	void voteBlockBegin();
 	bool msgVerify(const NodeID &_nodeID, bytes const&  _msg, h520 const&  _msgSign);
 	void addNodes(const std::string &_nodes);
 	int64_t nodeCount() const;
-	void signalHandler(const boost::system::error_code& err, int signal);
 	
 private:
-	unsigned m_consensusTimeInterval = (20*TIME_PER_SECOND);
+	std::chrono::steady_clock::duration m_consensusTimeInterval = std::chrono::seconds(20*TIME_PER_SECOND);
 
 	std::function<void(bytes const& _block, bool _isOurs)> m_onSealGenerated;
+	std::function<void()> m_onReady;
 
 	std::atomic<int64_t> m_blockReport = {0};
 	int64_t m_blockNumber = 0;
@@ -87,7 +121,7 @@ private:
 	
 	bytes m_blockBytes;
 	int64_t m_currentView = 0;
-	int64_t m_consensusTimeOut = -1;
+	std::chrono::steady_clock::time_point m_consensusTimeOut;
 	set<NodeID> m_idUnVoted;
 	map<NodeID, Signature> m_idVoted;
 	//unsigned m_consensusState = qposInitial;
@@ -97,13 +131,24 @@ private:
 
 	concurrent_queue<bytes> m_blocks;
 
-	std::atomic<pid_t> m_hostTid = {0};
-	boost::asio::signal_set *m_sigset;
+	/// All consensus state is only touched by handlers running on the host io_context.
+	boost::asio::io_context* m_ioContext = nullptr;
+	std::unique_ptr<boost::asio::steady_timer> m_consensusTimer;
+	std::unique_ptr<boost::asio::steady_timer> m_voteTimer;
 
-	int64_t m_voteTimeOut = 0;
+	std::chrono::steady_clock::time_point m_voteTimeOut;
 	set<NodeID> m_voted;
 	std::atomic<bool> m_isLeader = { false };
 	bool m_importAnyNode = false;
+
+	/// Propose blocks by transaction hashes and commit them to the voters without the body.
+	/// Off unless the chain enables it, as older miners drop the compact packets.
+	bool m_compactProposals = false;
+	QposCompactProposal m_compactProposal;
+	bool m_hasCompactProposal = false;
+
+	bool m_pipelined = false;
+	std::atomic<uint64_t> m_proposalRound = {0};
 };
 
 
@@ -26,6 +26,35 @@ using namespace dev;
 using namespace dev::eth;
 using namespace p2p;
 
+namespace
+{
+
+/// Recent block hashes for a block whose parent is sealed but not imported yet.
+class PendingParentHashes: public LastBlockHashesFace
+{
+public:
+	PendingParentHashes(LastBlockHashesFace const& _chain, BlockHeader const& _parent): m_chain(_chain), m_parent(_parent) {}
+
+	h256s precedingHashes(h256 const& _mostRecentHash) const override
+	{
+		if(_mostRecentHash != m_parent.hash())
+			return m_chain.precedingHashes(_mostRecentHash);
+
+		h256s ret = m_chain.precedingHashes(m_parent.parentHash());
+		ret.insert(ret.begin(), _mostRecentHash);
+		ret.resize(256);
+		return ret;
+	}
+
+	void clear() override {}
+
+private:
+	LastBlockHashesFace const& m_chain;
+	BlockHeader m_parent;
+};
+
+}
+
 QposClient& dev::eth::asQposClient(Interface& _c)
 {
 	if (dynamic_cast<Qpos*>(_c.sealEngine()))
@@ -105,6 +134,10 @@ void QposClient::init(ChainParams const&, p2p::Host *_host) {
 		}
 	});
 
+	raft()->onReady([ = ]() {
+		m_signalled.notify_all();
+	});
+
 	raft()->initEnv(this, _host, m_host.lock(), &m_bc, m_importAnyNode);
 	ctrace << "Init QposClient success 11";
 
@@ -187,6 +220,13 @@ bool QposClient::submitSealed(bytes const& _block, bool _isOurs)
 		m_needStateReset = true;
 		return true;
 	}
+
+	if(_isOurs && raft()->pipelined()){
+		h256 hash = BlockHeader(_block).hash(WithoutSeal);
+		DEV_GUARDED(x_pipeline)
+			if(m_pipelineCandidate && m_pipelineCandidate->info().hash(WithoutSeal) == hash)
+				m_pipelineParent = std::move(m_pipelineCandidate);
+	}
 	
 	// OPTIMISE: very inefficient to not utilise the existing OverlayDB in m_postSeal that contains all trie changes.
 	return m_bq.import(&_block, _isOurs) == ImportResult::Success;
@@ -201,8 +241,81 @@ bool QposClient::wouldSeal() const
 	return !empty && Client::wouldSeal();
 }
 
+PipelineParent dev::eth::pipelineParentOutcome(QueueStatus _status, bool _imported, bool _superseded)
+{
+	if(_imported)
+		return PipelineParent::Imported;
+	if(_superseded || _status == QueueStatus::Bad || _status == QueueStatus::Unknown)
+		return PipelineParent::Failed;
+	return PipelineParent::Pending;
+}
+
+bool QposClient::rejigPipelined()
+{
+	uint64_t round = 0;
+	Block block(Block::Null);
+	DEV_GUARDED(x_pipeline)
+	{
+		if(!m_pipelineParent)
+			return false;
+
+		BlockHeader const& parent = m_pipelineParent->info();
+		QueueStatus const status = m_bq.blockStatus(parent.hash());
+		bool const imported = bc().isKnown(parent.hash());
+		bool const superseded = !imported && bc().number() >= static_cast<unsigned>(parent.number());
+		PipelineParent const outcome = pipelineParentOutcome(status, imported, superseded);
+		if(outcome == PipelineParent::Imported){
+			m_pipelineParent.reset();
+			return false;
+		}
+
+		if(outcome == PipelineParent::Failed){
+			// Everything built on the parent is void; start over from the head.
+			cwarn << "Pipelined parent failed to import, number=" << parent.number() << ",hash=" << parent.hash() << ",status=" << status << ",superseded=" << superseded;
+			m_pipelineParent.reset();
+			m_pipelineCandidate.reset();
+			raft()->rollbackPipeline(bc().number());
+			m_needStateReset = true;
+			return true;
+		}
+
+		// Propose once per round; a failed vote starts a new one.
+		round = raft()->proposalRound();
+		if(!Client::wouldSeal() || round == m_pipelineRound || !sealEngine()->shouldSeal(this))
+			return true;
+
+		block = *m_pipelineParent;
+	}
+
+	PendingParentHashes lastHashes(bc().lastBlockHashes(), block.info());
+	block.startChild();
+	block.sync(bc(), lastHashes, m_tq, *m_gp);
+	if(block.empty())
+		return true;
+
+	block.commitToSeal(bc(), m_extraData);
+	std::unique_ptr<Block> candidate(new Block(block));
+
+	RLPStream h;
+	block.info().streamRLP(h);
+	block.sealBlock(h.out());
+
+	DEV_GUARDED(x_pipeline)
+	{
+		m_pipelineCandidate = std::move(candidate);
+		m_pipelineRound = round;
+	}
+
+	ctrace << "Generating pipelined seal on" << block.info().hash() << "#" << block.info().number();
+	raft()->generateSeal(block.blockData());
+	return true;
+}
+
 void QposClient::rejigSealing()
 {
+	if (raft()->pipelined() && rejigPipelined())
+		return;
+
 	bytes blockBytes;
 	if (wouldSeal())
 	{
@@ -230,6 +343,9 @@ void QposClient::rejigSealing()
 
 				m_working.commitToSeal(bc(), m_extraData);
 				m_sealingInfo = m_working.info();
+				if (raft()->pipelined())
+					DEV_GUARDED(x_pipeline)
+						m_pipelineCandidate.reset(new Block(m_working));
 
 				RLPStream h;
 				m_sealingInfo.streamRLP(h);
@@ -30,6 +30,20 @@ DEV_SIMPLE_EXCEPTION(NotQposSealEngine);
 DEV_SIMPLE_EXCEPTION(ChainParamsNotQpos);
 DEV_SIMPLE_EXCEPTION(InitQposFailed);
 
+/// What became of the block the pipelined proposals are built on.
+enum class PipelineParent
+{
+	Pending,	///< Still queued for import.
+	Imported,	///< In the chain.
+	Failed		///< Bad, dropped from the queue, or another block took its place.
+};
+
+/// @param _status the parent's status in the block queue, read before the chain is looked at, so
+/// that a parent imported in between is not taken for a dropped one.
+/// @param _imported whether the parent is in the chain.
+/// @param _superseded whether the chain reached the parent's number without it.
+PipelineParent pipelineParentOutcome(QueueStatus _status, bool _imported, bool _superseded);
+
 class QposClient: public Client
 {
 public:
@@ -59,10 +73,20 @@ protected:
 	void rejigSealing() override;
 	void reportBlocks(h256s const& _blocks) override;
 	bool submitSealed(bytes const& _block, bool _isOurs);
+	/// Proposes the next block on top of our last block that reached a quorum but is not
+	/// imported yet. @returns false if there is no such block and sealing continues from the head.
+	bool rejigPipelined();
 
 	BlockHeader  m_last_commited_block;
 	bool m_noEmptyBlock = true;
 	bool m_importAnyNode;
+
+	/// Pipelined sealing: our last proposal committed to seal, and our last block that reached
+	/// a quorum, on whose post state the next proposal is built until it is in the chain.
+	Mutex x_pipeline;
+	std::unique_ptr<Block> m_pipelineCandidate;
+	std::unique_ptr<Block> m_pipelineParent;
+	uint64_t m_pipelineRound = 0;
 };
 
 QposClient& asQposClient(Interface& _c);
@@ -58,6 +58,14 @@ char const* QposHost::packetTypeToString(unsigned _packetType) const
         return "qposBroadBlock";
     case QposTestPacket:
         return "QposTestPacket";
+    case qposBlockVoteCompact:
+        return "qposBlockVoteCompact";
+    case qposGetBlockTxs:
+        return "qposGetBlockTxs";
+    case qposBlockTxs:
+        return "qposBlockTxs";
+    case qposBroadBlockCompact:
+        return "qposBroadBlockCompact";
     default:
         return "UnknownQposPacket";
     }
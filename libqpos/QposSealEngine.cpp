@@ -103,20 +103,29 @@ void QposSealEngine::populateFromParent(BlockHeader& _bi, BlockHeader const& _pa
 void QposSealEngine::send(NodeID const& _id, RLPStream& _msg)
 {
 	if (auto h = m_host.lock())
-		h->capabilityHost().sealAndSend(_id, _msg);
+		h->capabilityHost().sealAndSend(_id, _msg, PacketPriority::Urgent);
 }
 
 void QposSealEngine::multicast(const set<NodeID> &_id, RLPStream& _msg)
 {
+	// Sending consumes the stream, so every peer gets its own copy.
 	for (auto it : _id){
-		send(it, _msg);
+		RLPStream msg(_msg);
+		send(it, msg);
 	}
 }
 
 void QposSealEngine::broadcast(RLPStream& _msg)
+{	
+	broadcast(_msg, set<NodeID>());
+}
+
+void QposSealEngine::broadcast(RLPStream& _msg, set<NodeID> const& _except)
 {	
 	if (auto h = m_host.lock()){
-		h->capabilityHost().foreachPeer("eth", [=](NodeID const& _peerID) {
+		h->capabilityHost().foreachPeer("eth", [&](NodeID const& _peerID) {
+			if(_except.count(_peerID))
+				return true;
 			RLPStream msg(_msg);
 			send(_peerID, msg);
 			return true;
@@ -274,10 +283,36 @@ bool QposSealEngine::getMinerList()
 
 bool QposSealEngine::getMinerList(set<NodeID> &_miner_list, BlockNumber _blk_no) const 
 {
-	string out = m_client->getNodes("", _blk_no);
-	_miner_list = strToNode(out);
-	cdebug << "_blk_no=" << _blk_no << ",out=" << out;
+	// The pending state may hold not yet mined changes of the node contract.
+	if(_blk_no == PendingBlock || !m_bc || (_blk_no != LatestBlock && static_cast<unsigned>(_blk_no) > m_bc->number())){
+		_miner_list = strToNode(m_client->getNodes("", _blk_no));
+		return true;
+	}
 
+	// The block is resolved once, so that the key and the set come from the same state even if
+	// the head moves meanwhile.
+	h256 const hash = _blk_no == LatestBlock ? m_bc->currentHash() : m_bc->numberHash(static_cast<unsigned>(_blk_no));
+	h256 key;
+	unsigned number = 0;
+	try{
+		BlockHeader const header = m_bc->info(hash);
+		number = static_cast<unsigned>(header.number());
+		State state(m_client->chainParams().accountStartNonce, m_client->stateDB());
+		state.setRoot(header.stateRoot());
+		key = nodeContractStateKey(state, jsToAddress(nodeAddress()));
+	}catch(...){
+		cdebug << "no state for the node contract at _blk_no=" << _blk_no;
+		_miner_list = strToNode(m_client->getNodes("", _blk_no));
+		return true;
+	}
+
+	_miner_list = m_minerCache.get(key, [&](set<NodeID>& o_miners) {
+		string out = m_client->getNodes("", number);
+		o_miners = strToNode(out);
+		cdebug << "_blk_no=" << _blk_no << ",out=" << out << ",hits=" << m_minerCache.hits() << ",misses=" << m_minerCache.misses();
+		// A reorg may have replaced the block between resolving it and reading the set.
+		return m_bc->numberHash(number) == hash;
+	});
 	return true;
 }
 
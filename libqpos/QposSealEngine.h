@@ -34,6 +34,7 @@
 #include <libethereum/BlockChain.h>
 #include <libethcore/KeyManager.h>
 
+#include "MinerSetCache.h"
 #include "QposHost.h"
 #include "QposPeer.h"
 
@@ -95,6 +96,10 @@ public:
 	virtual void generateSeal(bytes const&) {};
 	void generateSeal(BlockHeader const& _bi) override { (void)_bi; };
 	void addPeers(std::set<QposNode>& _nodes);
+
+	/// Hit/miss counters of the miner set cache used by getMinerList().
+	uint64_t minerCacheHits() const { return m_minerCache.hits(); }
+	uint64_t minerCacheMisses() const { return m_minerCache.misses(); }
 protected:
 	virtual void tick();
 	bool getMinerList();
@@ -108,11 +113,13 @@ protected:
 	void send(NodeID const& _id, RLPStream& _msg);
 	void multicast(const set<NodeID> &_id, RLPStream& _msg);
 	void broadcast(RLPStream& _msg);
+	void broadcast(RLPStream& _msg, set<NodeID> const& _except);
 	void multicast(const h512s &_miner_list, RLPStream& _msg);
 
 	bool verifyBlock(const bytes& _block, ImportRequirements::value _ir = ImportRequirements::OutOfOrderChecks) const;
 
 	NodeID id() const{ return m_pair.pub();};
+	Client* client() const { return m_client; }
 
 	std::vector<p2p::NodeSpec> exNodes() { return m_exNodes;}
 private:
@@ -135,6 +142,9 @@ private:
 	std::set<QposNode> m_nodes;
 	std::string m_nodes_str;
 	bool m_nodes_changed = true;
+
+	/// Miner sets already read from the node contract, keyed by the contract's state.
+	mutable MinerSetCache m_minerCache;
 };
 
 }
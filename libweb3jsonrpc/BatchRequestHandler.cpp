@@ -0,0 +1,89 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "BatchRequestHandler.h"
+
+#include <jsonrpccpp/common/errors.h>
+#include <json/json.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+using namespace dev;
+using namespace dev::rpc;
+
+string dev::rpc::internalErrorResponse(Json::Value const& _call, char const* _what)
+{
+    Json::Value response;
+    response["jsonrpc"] = "2.0";
+    response["id"] = _call.isObject() ? _call.get("id", Json::nullValue) : Json::nullValue;
+    response["error"]["code"] = jsonrpc::Errors::ERROR_RPC_INTERNAL_ERROR;
+    response["error"]["message"] = _what;
+    return Json::FastWriter().write(response);
+}
+
+constexpr unsigned BatchRequestHandler::c_defaultThreads;
+
+BatchRequestHandler::BatchRequestHandler(
+    jsonrpc::IClientConnectionHandler& _handler, unsigned _threads)
+  : m_handler(_handler)
+{
+    setThreads(_threads);
+}
+
+void BatchRequestHandler::setThreads(unsigned _threads)
+{
+    m_threads = max(_threads, 1u);
+    // The calling thread takes part in every batch, so the pool needs one thread less.
+    m_pool.reset(_threads > 1 ? new ThreadPool(_threads - 1) : nullptr);
+}
+
+void BatchRequestHandler::HandleRequest(string const& _request, string& o_response)
+{
+    Json::Value batch;
+    if (!m_pool || !Json::Reader().parse(_request, batch, false) || !batch.isArray() ||
+        batch.size() < 2)
+    {
+        m_handler.HandleRequest(_request, o_response);
+        return;
+    }
+
+    vector<string> responses(batch.size());
+    m_pool->parallelFor(batch.size(), [&](size_t _i) {
+        Json::Value const& call = batch[Json::ArrayIndex(_i)];
+        try
+        {
+            m_handler.HandleRequest(Json::FastWriter().write(call), responses[_i]);
+        }
+        catch (std::exception const& _e)
+        {
+            responses[_i] = internalErrorResponse(call, _e.what());
+        }
+        catch (...)
+        {
+            responses[_i] = internalErrorResponse(call, "Unknown error");
+        }
+        return true;
+    }, m_threads);
+
+    // Splice the responses together as they are instead of parsing and writing them again.
+    // Notifications have no response, and a batch of only notifications gets none either.
+    size_t size = 2;
+    for (auto const& r : responses)
+        size += r.size() + 1;
+    o_response.clear();
+    o_response.reserve(size);
+    for (auto& r : responses)
+    {
+        while (!r.empty() && (r.back() == '\n' || r.back() == '\r'))
+            r.pop_back();
+        if (r.empty())
+            continue;
+        o_response += o_response.empty() ? '[' : ',';
+        o_response += r;
+    }
+    if (!o_response.empty())
+        o_response += "]\n";
+}
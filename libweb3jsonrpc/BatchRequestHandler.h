@@ -0,0 +1,47 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#pragma once
+
+#include <libdevcore/ThreadPool.h>
+
+#include <json/value.h>
+#include <jsonrpccpp/server/iclientconnectionhandler.h>
+
+#include <memory>
+#include <string>
+
+namespace dev
+{
+namespace rpc
+{
+/// @returns the JSON-RPC internal error response to @a _call, for calls that threw @a _what.
+std::string internalErrorResponse(Json::Value const& _call, char const* _what);
+
+/// Sits between the server connectors and the JSON-RPC protocol handler and runs the calls of a
+/// batch request in parallel. Anything but a non-empty batch goes to the protocol handler as is.
+class BatchRequestHandler : public jsonrpc::IClientConnectionHandler
+{
+public:
+    static constexpr unsigned c_defaultThreads = 4;
+
+    explicit BatchRequestHandler(
+        jsonrpc::IClientConnectionHandler& _handler, unsigned _threads = c_defaultThreads);
+
+    void HandleRequest(std::string const& _request, std::string& o_response) override;
+
+    /// Number of calls of one batch run at the same time, counting the thread that handles the
+    /// request; 0 and 1 run them one after another. Must not be changed while requests are being
+    /// handled.
+    void setThreads(unsigned _threads);
+    unsigned threads() const noexcept { return m_threads; }
+
+private:
+    jsonrpc::IClientConnectionHandler& m_handler;
+    unsigned m_threads = 1;
+    std::unique_ptr<ThreadPool> m_pool;
+};
+
+}  // namespace rpc
+}  // namespace dev
@@ -50,15 +50,15 @@ State Debug::stateAt(std::string const& _blockHashOrNumber, int _txIndex) const
     if (_txIndex < 0)
         throw jsonrpc::JsonRpcException("Negative index");
 
-    Block block = m_eth.block(blockHash(_blockHashOrNumber));
-    auto const txCount = block.pending().size();
+    auto const block = m_eth.stateView(blockHash(_blockHashOrNumber));
+    auto const txCount = block->pending().size();
 
     State state(State::Null);
     if (static_cast<size_t>(_txIndex) < txCount)
-        createIntermediateState(state, block, _txIndex, m_eth.blockChain());
+        createIntermediateState(state, *block, _txIndex, m_eth.blockChain());
     else if (static_cast<size_t>(_txIndex) == txCount)
         // the final state of block (after applying rewards)
-        state = block.state();
+        state = block->state();
     else
         throw jsonrpc::JsonRpcException("Transaction index " + toString(_txIndex) + " out of range (" + toString(txCount) + ") for block " + _blockHashOrNumber);
 
@@ -74,7 +74,9 @@ Json::Value Debug::traceTransaction(Executive& _e, Transaction const& _t, Json::
     if (!_e.execute())
         _e.go(st.onOp());
     _e.finalize();
-    return st.jsonValue();
+    Json::Value ret;
+    st.swapJsonValue(ret);
+    return ret;
 }
 
 Json::Value Debug::traceBlock(Block const& _block, Json::Value const& _json)
@@ -94,7 +96,8 @@ Json::Value Debug::traceBlock(Block const& _block, Json::Value const& _json)
 
         eth::ExecutionResult er;
         e.setResultRecipient(er);
-        traces.append(traceTransaction(e, t, _json));
+        Json::Value trace = traceTransaction(e, t, _json);
+        traces[k].swap(trace);
     }
     return traces;
 }
@@ -105,15 +108,15 @@ Json::Value Debug::debug_traceTransaction(string const& _txHash, Json::Value con
     try
     {
         LocalisedTransaction t = m_eth.localisedTransaction(h256(_txHash));
-        Block block = m_eth.block(t.blockHash());
+        auto const block = m_eth.stateView(t.blockHash());
         State s(State::Null);
         eth::ExecutionResult er;
-        Executive e(s, block, t.transactionIndex(), m_eth.blockChain());
+        Executive e(s, *block, t.transactionIndex(), m_eth.blockChain());
         e.setResultRecipient(er);
         Json::Value trace = traceTransaction(e, t, _json);
         ret["gas"] = toJS(t.gas());
         ret["return"] = toHexPrefixed(er.output);
-        ret["structLogs"] = trace;
+        ret["structLogs"].swap(trace);
     }
     catch(Exception const& _e)
     {
@@ -132,16 +135,16 @@ Json::Value Debug::debug_traceBlock(string const& _blockRLP, Json::Value const&
 Json::Value Debug::debug_traceBlockByHash(string const& _blockHash, Json::Value const& _json)
 {
     Json::Value ret;
-    Block block = m_eth.block(h256(_blockHash));
-    ret["structLogs"] = traceBlock(block, _json);
+    Json::Value traces = traceBlock(*m_eth.stateView(h256(_blockHash)), _json);
+    ret["structLogs"].swap(traces);
     return ret;
 }
 
 Json::Value Debug::debug_traceBlockByNumber(int _blockNumber, Json::Value const& _json)
 {
     Json::Value ret;
-    Block block = m_eth.block(blockHash(std::to_string(_blockNumber)));
-    ret["structLogs"] = traceBlock(block, _json);
+    Json::Value traces = traceBlock(*m_eth.stateView(blockHash(std::to_string(_blockNumber))), _json);
+    ret["structLogs"].swap(traces);
     return ret;
 }
 
@@ -247,7 +250,7 @@ Json::Value Debug::debug_traceCall(Json::Value const& _call, std::string const&
         Json::Value trace = traceTransaction(e, transaction, _options);
         ret["gas"] = toJS(transaction.gas());
         ret["return"] = toHexPrefixed(er.output);
-        ret["structLogs"] = trace;
+        ret["structLogs"].swap(trace);
     }
     catch(Exception const& _e)
     {
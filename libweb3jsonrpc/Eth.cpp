@@ -21,6 +21,12 @@ using namespace eth;
 using namespace shh;
 using namespace dev::rpc;
 
+namespace
+{
+/// Upper bound of the "limit" of eth_getLogsPaged.
+unsigned const c_maxLogsPage = 10000;
+}
+
 Eth::Eth(eth::Interface& _eth, eth::AccountHolder& _ethAccounts):
 	m_eth(_eth),
 	m_ethAccounts(_ethAccounts)
@@ -601,6 +607,29 @@ Json::Value Eth::eth_getLogsEx(Json::Value const& _json)
 	}
 }
 
+Json::Value Eth::eth_getLogsPaged(Json::Value const& _json)
+{
+	try
+	{
+		unsigned limit = c_maxLogsPage;
+		if (!_json["limit"].empty())
+			limit = max(1u, min<unsigned>(limit, jsToInt(_json["limit"].asString())));
+		boost::optional<unsigned> cursor;
+		if (!_json["cursor"].empty())
+			cursor = jsToInt(_json["cursor"].asString());
+
+		Json::Value ret(Json::objectValue);
+		ret["logs"] = toJson(client()->logs(toLogFilter(_json, *client()), limit, cursor));
+		// Pass "cursor" back with the same filter to get the next page; null after the last one.
+		ret["cursor"] = cursor ? Json::Value(toJS(*cursor)) : Json::Value();
+		return ret;
+	}
+	catch (...)
+	{
+		BOOST_THROW_EXCEPTION(JsonRpcException(Errors::ERROR_RPC_INVALID_PARAMS));
+	}
+}
+
 Json::Value Eth::eth_getWork()
 {
 	try
@@ -93,6 +93,7 @@ public:
 	virtual Json::Value eth_getFilterLogsEx(std::string const& _filterId) override;
 	virtual Json::Value eth_getLogs(Json::Value const& _json) override;
 	virtual Json::Value eth_getLogsEx(Json::Value const& _json) override;
+	virtual Json::Value eth_getLogsPaged(Json::Value const& _json) override;
 	virtual Json::Value eth_getWork() override;
 	virtual bool eth_submitWork(std::string const& _nonce, std::string const&, std::string const& _mixHash) override;
 	virtual bool eth_submitHashrate(std::string const& _hashes, std::string const& _id) override;
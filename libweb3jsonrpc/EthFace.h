@@ -53,6 +53,7 @@ namespace dev {
                     this->bindAndAddMethod(jsonrpc::Procedure("eth_getFilterLogsEx", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_ARRAY, "param1",jsonrpc::JSON_STRING, NULL), &dev::rpc::EthFace::eth_getFilterLogsExI);
                     this->bindAndAddMethod(jsonrpc::Procedure("eth_getLogs", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_ARRAY, "param1",jsonrpc::JSON_OBJECT, NULL), &dev::rpc::EthFace::eth_getLogsI);
                     this->bindAndAddMethod(jsonrpc::Procedure("eth_getLogsEx", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_ARRAY, "param1",jsonrpc::JSON_OBJECT, NULL), &dev::rpc::EthFace::eth_getLogsExI);
+                    this->bindAndAddMethod(jsonrpc::Procedure("eth_getLogsPaged", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT, "param1",jsonrpc::JSON_OBJECT, NULL), &dev::rpc::EthFace::eth_getLogsPagedI);
                     this->bindAndAddMethod(jsonrpc::Procedure("eth_getWork", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_ARRAY,  NULL), &dev::rpc::EthFace::eth_getWorkI);
                     this->bindAndAddMethod(jsonrpc::Procedure("eth_submitWork", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_BOOLEAN, "param1",jsonrpc::JSON_STRING,"param2",jsonrpc::JSON_STRING,"param3",jsonrpc::JSON_STRING, NULL), &dev::rpc::EthFace::eth_submitWorkI);
                     this->bindAndAddMethod(jsonrpc::Procedure("eth_submitHashrate", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_BOOLEAN, "param1",jsonrpc::JSON_STRING,"param2",jsonrpc::JSON_STRING, NULL), &dev::rpc::EthFace::eth_submitHashrateI);
@@ -239,6 +240,10 @@ namespace dev {
                 {
                     response = this->eth_getLogsEx(request[0u]);
                 }
+                inline virtual void eth_getLogsPagedI(const Json::Value &request, Json::Value &response)
+                {
+                    response = this->eth_getLogsPaged(request[0u]);
+                }
                 inline virtual void eth_getWorkI(const Json::Value &request, Json::Value &response)
                 {
                     (void)request;
@@ -349,6 +354,7 @@ namespace dev {
                 virtual Json::Value eth_getFilterLogsEx(const std::string& param1) = 0;
                 virtual Json::Value eth_getLogs(const Json::Value& param1) = 0;
                 virtual Json::Value eth_getLogsEx(const Json::Value& param1) = 0;
+                virtual Json::Value eth_getLogsPaged(const Json::Value& param1) = 0;
                 virtual Json::Value eth_getWork() = 0;
                 virtual bool eth_submitWork(const std::string& param1, const std::string& param2, const std::string& param3) = 0;
                 virtual bool eth_submitHashrate(const std::string& param1, const std::string& param2) = 0;
@@ -61,10 +61,7 @@ template <class S> bool IpcServerBase<S>::SendResponse(string const& _response,
         if (bytesWritten == 0)
             errorOccured = true;
         else if (bytesWritten < toSend.size())
-        {
-            int len = toSend.size() - bytesWritten;
-            toSend = toSend.substr(bytesWritten + sizeof(char), len);
-        }
+            toSend.erase(0, bytesWritten);
         else
             fullyWritten = true;
     } while (!fullyWritten && !errorOccured);
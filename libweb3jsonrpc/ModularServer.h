@@ -4,10 +4,12 @@
 
 #pragma once
 
-#include <map>
+#include "BatchRequestHandler.h"
+
 #include <memory>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include <jsonrpccpp/common/exception.h>
@@ -53,7 +55,8 @@ class ModularServer: public jsonrpc::IProcedureInvokationHandler
 {
 public:
     ModularServer()
-    : m_handler(jsonrpc::RequestHandlerFactory::createProtocolHandler(jsonrpc::JSONRPC_SERVER_V2, *this))
+    : m_handler(jsonrpc::RequestHandlerFactory::createProtocolHandler(jsonrpc::JSONRPC_SERVER_V2, *this)),
+      m_batchHandler(*m_handler)
     {
         m_handler->AddProcedure(jsonrpc::Procedure("rpc_modules", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT, NULL));
         m_implementedModules = Json::objectValue;
@@ -90,11 +93,15 @@ public:
         (void)_input;
     }
 
+    /// Sets how many calls of a batch request are run in parallel. Call before StartListening().
+    void setBatchThreads(unsigned _threads) { m_batchHandler.setThreads(_threads); }
+    unsigned batchThreads() const noexcept { return m_batchHandler.threads(); }
+
     /// server takes ownership of the connector
     unsigned addConnector(jsonrpc::AbstractServerConnector* _connector)
     {
         m_connectors.emplace_back(_connector);
-        _connector->SetHandler(m_handler.get());
+        _connector->SetHandler(&m_batchHandler);
         return m_connectors.size() - 1;
     }
 
@@ -106,6 +113,7 @@ public:
 protected:
     std::vector<std::unique_ptr<jsonrpc::AbstractServerConnector>> m_connectors;
     std::unique_ptr<jsonrpc::IProtocolHandler> m_handler;
+    dev::rpc::BatchRequestHandler m_batchHandler;
     /// Mapping for implemented modules, to be filled by subclasses during construction.
     Json::Value m_implementedModules;
 };
@@ -178,6 +186,6 @@ public:
 
 private:
     std::unique_ptr<I> m_interface;
-    std::map<std::string, MethodPointer> m_methods;
-    std::map<std::string, NotificationPointer> m_notifications;
+    std::unordered_map<std::string, MethodPointer> m_methods;
+    std::unordered_map<std::string, NotificationPointer> m_notifications;
 };
@@ -5,129 +5,423 @@
 #if !defined(_WIN32)
 
 #include "UnixSocketServer.h"
-#include <sys/socket.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <libdevcore/Guards.h>
+#include "BatchRequestHandler.h"
+
 #include <libdevcore/FileSystem.h>
+#include <libdevcore/Log.h>
+
+#include <json/json.h>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
 
-// "Mac OS X does not support the flag MSG_NOSIGNAL but we have an equivalent."
-// See http://lists.apple.com/archives/macnetworkprog/2002/Dec/msg00091.html
-#if defined(__APPLE__)
-	#if !defined(MSG_NOSIGNAL)
-		#define MSG_NOSIGNAL SO_NOSIGPIPE
-	#endif
-#endif
+#include <sys/un.h>
+
+#include <array>
+#include <deque>
+#include <map>
+#include <unordered_set>
 
 using namespace std;
-using namespace jsonrpc;
 using namespace dev;
 namespace fs = boost::filesystem;
+using local = boost::asio::local::stream_protocol;
 
 namespace
 {
 size_t const c_socketPathMaxLength = sizeof(sockaddr_un::sun_path) / sizeof(sockaddr_un::sun_path[0]);
+size_t const c_readChunk = 64 * 1024;
 
 fs::path getIpcPathOrDataDir()
 {
-	// On Unix use datadir as default IPC path.
-	fs::path path = getIpcPath();
-	if (path.empty())
-		return getDataDir();
-	return path;
-}
+    // On Unix use datadir as default IPC path.
+    fs::path path = getIpcPath();
+    if (path.empty())
+        return getDataDir();
+    return path;
 }
 
-UnixDomainSocketServer::UnixDomainSocketServer(string const& _appId):
-	IpcServerBase((getIpcPathOrDataDir() / fs::path(_appId + ".ipc")).string().substr(0, c_socketPathMaxLength))
+/// Where SendResponse() stores the response to one request.
+struct RequestContext
+{
+    string response;
+};
+}  // namespace
+
+constexpr unsigned UnixDomainSocketServer::c_defaultThreads;
+constexpr unsigned UnixDomainSocketServer::c_defaultWriteThreads;
+constexpr size_t UnixDomainSocketServer::c_maxRequestSize;
+
+/// One client. Reads are split into JSON requests as they arrive, which are started in order as
+/// far as writes allow; responses are queued and written in request order. Only ever touched on
+/// the I/O thread.
+class UnixDomainSocketServer::Connection : public enable_shared_from_this<Connection>
+{
+public:
+    Connection(UnixDomainSocketServer& _server, local::socket _socket)
+      : m_server(_server), m_socket(move(_socket))
+    {}
+
+    void read()
+    {
+        auto self = shared_from_this();
+        m_socket.async_read_some(boost::asio::buffer(m_buffer),
+            [this, self](boost::system::error_code const& _ec, size_t _bytes) {
+                if (_ec)
+                {
+                    close();
+                    return;
+                }
+                m_pending.append(m_buffer.data(), _bytes);
+                if (!splitRequests())
+                {
+                    clog(VerbosityWarning, "rpc") << "Malformed JSON-RPC request, closing connection";
+                    close();
+                    return;
+                }
+                if (m_pending.size() > c_maxRequestSize)
+                {
+                    clog(VerbosityWarning, "rpc")
+                        << "JSON-RPC request longer than " << c_maxRequestSize
+                        << " bytes, closing connection";
+                    close();
+                    return;
+                }
+                read();
+            });
+    }
+
+    /// Takes the response to the request numbered @a _seq and writes out all responses that
+    /// are next in line.
+    void complete(uint64_t _seq, string _response)
+    {
+        // A write runs alone, so whatever finishes while one runs is that write.
+        --m_executing;
+        m_writeExecuting = false;
+        schedule();
+
+        m_done[_seq] = move(_response);
+        for (auto it = m_done.begin(); it != m_done.end() && it->first == m_nextToWrite;
+             it = m_done.erase(it), ++m_nextToWrite)
+            // Notifications have an empty response.
+            if (!it->second.empty())
+                m_writeQueue.push_back(move(it->second));
+        if (!m_writing)
+            write();
+    }
+
+    void close()
+    {
+        boost::system::error_code ec;
+        m_socket.shutdown(local::socket::shutdown_both, ec);
+        m_socket.close(ec);
+        m_server.m_connections.erase(shared_from_this());
+    }
+
+private:
+    struct Queued
+    {
+        uint64_t seq;
+        string request;
+        bool readOnly;
+    };
+
+    /// Cuts every complete top-level JSON value off the front of m_pending. The scan state
+    /// carries over to the next read, so each byte is looked at once.
+    /// @returns false if a bracket closes nothing, after which the stream can't be framed.
+    bool splitRequests()
+    {
+        while (m_scanned < m_pending.size())
+        {
+            char const c = m_pending[m_scanned++];
+            if (m_inString)
+            {
+                if (m_escape)
+                    m_escape = false;
+                else if (c == '\\')
+                    m_escape = true;
+                else if (c == '"')
+                    m_inString = false;
+            }
+            else if (c == '"')
+                m_inString = true;
+            else if (c == '{' || c == '[')
+                ++m_depth;
+            else if (c == '}' || c == ']')
+            {
+                if (m_depth == 0)
+                    return false;
+                if (--m_depth == 0)
+                {
+                    string request = m_pending.substr(0, m_scanned);
+                    m_pending.erase(0, m_scanned);
+                    m_scanned = 0;
+                    clog(VerbosityTrace, "rpc") << request;
+                    bool const readOnly = m_server.isReadOnlyRequest(request);
+                    m_queued.push_back({m_nextSeq++, move(request), readOnly});
+                    schedule();
+                }
+            }
+        }
+        return true;
+    }
+
+    /// Starts the queued requests that may run now: read-only ones while no write is running,
+    /// a write once nothing before it is running any more.
+    void schedule()
+    {
+        if (!m_socket.is_open())
+        {
+            m_queued.clear();
+            return;
+        }
+        while (!m_queued.empty() && !m_writeExecuting)
+        {
+            Queued& next = m_queued.front();
+            if (!next.readOnly)
+            {
+                if (m_executing)
+                    return;
+                m_writeExecuting = true;
+            }
+            ++m_executing;
+            m_server.dispatch(shared_from_this(), next.seq, move(next.request), next.readOnly);
+            m_queued.pop_front();
+        }
+    }
+
+    void write()
+    {
+        if (m_writeQueue.empty() || !m_socket.is_open())
+        {
+            m_writing = false;
+            return;
+        }
+        m_writing = true;
+        auto self = shared_from_this();
+        boost::asio::async_write(m_socket, boost::asio::buffer(m_writeQueue.front()),
+            [this, self](boost::system::error_code const& _ec, size_t) {
+                if (_ec)
+                {
+                    m_writeQueue.clear();
+                    m_writing = false;
+                    close();
+                    return;
+                }
+                m_writeQueue.pop_front();
+                write();
+            });
+    }
+
+    UnixDomainSocketServer& m_server;
+    local::socket m_socket;
+
+    array<char, c_readChunk> m_buffer;
+    string m_pending;
+    size_t m_scanned = 0;
+    int m_depth = 0;
+    bool m_inString = false;
+    bool m_escape = false;
+
+    uint64_t m_nextSeq = 0;
+    /// Requests waiting for an earlier write, or for earlier requests if they write themselves.
+    deque<Queued> m_queued;
+    unsigned m_executing = 0;
+    bool m_writeExecuting = false;
+
+    uint64_t m_nextToWrite = 0;
+    map<uint64_t, string> m_done;
+    deque<string> m_writeQueue;
+    bool m_writing = false;
+};
+
+UnixDomainSocketServer::UnixDomainSocketServer(
+    string const& _appId, unsigned _threads, unsigned _writeThreads)
+  : m_path((getIpcPathOrDataDir() / fs::path(_appId + ".ipc"))
+               .string()
+               .substr(0, c_socketPathMaxLength)),
+    m_threads(max(_threads, 1u)),
+    m_writeThreads(max(_writeThreads, 1u))
 {
+    clog(VerbosityInfo, "rpc") << "JSON-RPC socket path: " << m_path;
 }
 
 UnixDomainSocketServer::~UnixDomainSocketServer()
 {
-	StopListening();
+    StopListening();
 }
 
 bool UnixDomainSocketServer::StartListening()
 {
-	if (!m_running)
-	{
-		if (access(m_path.c_str(), F_OK) != -1)
-			unlink(m_path.c_str());
-
-		if (access(m_path.c_str(), F_OK) != -1)
-			return false;
-
-		m_socket = socket(PF_UNIX, SOCK_STREAM, 0);
-		memset(&(m_address), 0, sizeof(sockaddr_un));
-		m_address.sun_family = AF_UNIX;
-#ifdef __APPLE__
-		m_address.sun_len = m_path.size() + 1;
-#endif
-		strncpy(m_address.sun_path, m_path.c_str(), c_socketPathMaxLength);
-		::bind(m_socket, reinterpret_cast<sockaddr*>(&m_address), sizeof(sockaddr_un));
-		fs::permissions(m_path, fs::owner_read | fs::owner_write);
-		listen(m_socket, 128);
-	}
-	return IpcServerBase::StartListening();
+    if (m_running)
+        return false;
+
+    boost::system::error_code ec;
+    fs::remove(m_path, ec);
+    m_acceptor.open(local(), ec);
+    if (!ec)
+        m_acceptor.bind(local::endpoint(m_path), ec);
+    if (!ec)
+        m_acceptor.listen(128, ec);
+    if (ec)
+    {
+        clog(VerbosityError, "rpc") << "Can't listen on " << m_path << ": " << ec.message();
+        m_acceptor.close(ec);
+        return false;
+    }
+    fs::permissions(m_path, fs::owner_read | fs::owner_write, ec);
+
+    m_readPool.reset(new ThreadPool(m_threads));
+    m_writePool.reset(new ThreadPool(m_writeThreads));
+    m_running = true;
+    m_io.restart();
+    accept();
+    m_ioThread = thread([this]() { m_io.run(); });
+    return true;
 }
 
 bool UnixDomainSocketServer::StopListening()
 {
-	shutdown(m_socket, SHUT_RDWR);
-	close(m_socket);
-	m_socket = -1;
-	if (IpcServerBase::StopListening())
-	{
-		unlink(m_path.c_str());
-		return true;
-	}
-	return false;
+    if (!m_running.exchange(false))
+        return false;
+
+    m_io.stop();
+    m_ioThread.join();
+
+    // The I/O thread is gone, so the sockets can be closed from here.
+    boost::system::error_code ec;
+    m_acceptor.close(ec);
+    for (auto const& connection : decltype(m_connections)(m_connections))
+        connection->close();
+
+    // Waits for the requests still being executed; their responses have nowhere to go.
+    m_readPool.reset();
+    m_writePool.reset();
+
+    fs::remove(m_path, ec);
+    return true;
 }
 
-void UnixDomainSocketServer::Listen()
+bool UnixDomainSocketServer::SendResponse(string const& _response, void* _addInfo)
 {
-	socklen_t addressLen = sizeof(m_address);
-	while (m_running)
-	{
-		int connection = accept(m_socket, (sockaddr*) &(m_address), &addressLen);
-		if (connection > 0)
-		{
-			DEV_GUARDED(x_sockets)
-				m_sockets.insert(connection);
-
-			// Handle the request in a new detached thread.
-			std::thread{[this, connection]
-			{
-				GenerateResponse(connection);
-				CloseConnection(connection);
-			}}.detach();
-		}
-	}
+    static_cast<RequestContext*>(_addInfo)->response = _response;
+    return true;
 }
 
-void UnixDomainSocketServer::CloseConnection(int _socket)
+void UnixDomainSocketServer::accept()
 {
-	shutdown(_socket, SHUT_RDWR);
-	close(_socket);
+    m_acceptor.async_accept([this](boost::system::error_code const& _ec, local::socket _socket) {
+        if (_ec)
+        {
+            if (_ec != boost::asio::error::operation_aborted && m_running)
+                accept();
+            return;
+        }
+        auto connection = make_shared<Connection>(*this, move(_socket));
+        m_connections.insert(connection);
+        connection->read();
+        accept();
+    });
 }
 
+void UnixDomainSocketServer::dispatch(
+    shared_ptr<Connection> const& _connection, uint64_t _seq, string _request, bool _readOnly)
+{
+    ThreadPool& pool = _readOnly ? *m_readPool : *m_writePool;
+    pool.post([this, _connection, _seq, request = move(_request)]() {
+        RequestContext context;
+        try
+        {
+            OnRequest(request, &context);
+        }
+        catch (std::exception const& _e)
+        {
+            Json::Value call;
+            Json::Reader().parse(request, call, false);
+            context.response = rpc::internalErrorResponse(call, _e.what());
+        }
+        catch (...)
+        {
+            Json::Value call;
+            Json::Reader().parse(request, call, false);
+            context.response = rpc::internalErrorResponse(call, "Unknown error");
+        }
+        boost::asio::post(m_io, [_connection, _seq, response = move(context.response)]() mutable {
+            _connection->complete(_seq, move(response));
+        });
+    });
+}
 
-size_t UnixDomainSocketServer::Write(int _connection, string const& _data)
+bool UnixDomainSocketServer::isReadOnlyRequest(string const& _request) const
 {
-	ssize_t r = send(_connection, _data.data(), _data.size(), MSG_NOSIGNAL);
-	if (r < 0)
-		return 0;
-	return static_cast<size_t>(r);
+    Json::Value request;
+    if (!Json::Reader().parse(_request, request, false))
+        return false;
+    if (request.isObject())
+        return request["method"].isString() && isReadOnly(request["method"].asString());
+    if (!request.isArray() || request.empty())
+        return false;
+    for (auto const& call : request)
+        if (!call.isObject() || !call["method"].isString() || !isReadOnly(call["method"].asString()))
+            return false;
+    return true;
 }
 
-size_t UnixDomainSocketServer::Read(int _connection, void* _data, size_t _size)
+bool UnixDomainSocketServer::isReadOnly(string const& _method)
 {
-	ssize_t r = read(_connection, _data, _size);
-	if (r < 0)
-		return 0;
-	return static_cast<size_t>(r);
+    static unordered_set<string> const c_readOnly{
+        "rpc_modules",
+        "web3_clientVersion",
+        "web3_sha3",
+        "net_version",
+        "net_peerCount",
+        "net_listening",
+        "eth_protocolVersion",
+        "eth_hashrate",
+        "eth_coinbase",
+        "eth_mining",
+        "eth_gasPrice",
+        "eth_accounts",
+        "eth_blockNumber",
+        "eth_getBalance",
+        "eth_getStorageAt",
+        "eth_getStorageRoot",
+        "eth_getTransactionCount",
+        "eth_pendingTransactions",
+        "eth_getBlockTransactionCountByHash",
+        "eth_getBlockTransactionCountByNumber",
+        "eth_getUncleCountByBlockHash",
+        "eth_getUncleCountByBlockNumber",
+        "eth_getCode",
+        "eth_call",
+        "eth_getBlockByHash",
+        "eth_getBlockByNumber",
+        "eth_getTransactionByHash",
+        "eth_getTransactionByBlockHashAndIndex",
+        "eth_getTransactionByBlockNumberAndIndex",
+        "eth_getTransactionReceipt",
+        "eth_getUncleByBlockHashAndIndex",
+        "eth_getUncleByBlockNumberAndIndex",
+        "eth_getFilterLogs",
+        "eth_getFilterLogsEx",
+        "eth_getLogs",
+        "eth_getLogsEx",
+        "eth_getLogsPaged",
+        "eth_syncing",
+        "eth_estimateGas",
+        "eth_chainId",
+        "personal_listAccounts",
+        "debug_accountRange",
+        "debug_traceTransaction",
+        "debug_storageRangeAt",
+        "debug_preimage",
+        "debug_traceBlockByNumber",
+        "debug_traceBlockByHash",
+        "debug_traceCall",
+    };
+    return c_readOnly.count(_method) != 0;
 }
 
 #endif
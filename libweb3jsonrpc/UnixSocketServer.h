@@ -3,29 +3,71 @@
 // Licensed under the GNU General Public License, Version 3.
 #pragma once
 
-#include "IpcServerBase.h"
+#include <libdevcore/ThreadPool.h>
+
+#include <jsonrpccpp/server/abstractserverconnector.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
 
-#include <sys/un.h>
 #include <atomic>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
 
 namespace dev
 {
-class UnixDomainSocketServer : public IpcServerBase<int>
+/// JSON-RPC connector on a Unix domain socket. All socket I/O runs asynchronously on one thread,
+/// and requests are executed on pools shared by all connections: read-only methods on one pool,
+/// everything else on another. Each connection is served first in, first out: read-only requests
+/// run concurrently as long as no earlier request of the connection that writes is still running,
+/// and a writing request runs once everything before it is done. A client may pipeline requests
+/// on one connection and gets the responses back in the order it sent the requests.
+class UnixDomainSocketServer : public jsonrpc::AbstractServerConnector
 {
 public:
-    explicit UnixDomainSocketServer(std::string const& _appId);
+    static constexpr unsigned c_defaultThreads = 4;
+    static constexpr unsigned c_defaultWriteThreads = 1;
+    /// Connections sending an incomplete request longer than this are closed.
+    static constexpr size_t c_maxRequestSize = 16 * 1024 * 1024;
+
+    /// @param _threads size of the pool running read-only requests.
+    /// @param _writeThreads size of the pool running all other requests; with 1 they run one at a
+    /// time across all connections.
+    explicit UnixDomainSocketServer(std::string const& _appId, unsigned _threads = c_defaultThreads,
+        unsigned _writeThreads = c_defaultWriteThreads);
     ~UnixDomainSocketServer() override;
+
     bool StartListening() override;
     bool StopListening() override;
+    bool SendResponse(std::string const& _response, void* _addInfo = nullptr) override;
+
+    /// @returns true if @a _method only reads, so that it may run alongside other requests.
+    static bool isReadOnly(std::string const& _method);
+
+private:
+    class Connection;
+
+    void accept();
+    /// Runs @a _request on one of the pools and hands the response to @a _connection.
+    void dispatch(std::shared_ptr<Connection> const& _connection, uint64_t _seq,
+        std::string _request, bool _readOnly);
+    bool isReadOnlyRequest(std::string const& _request) const;
+
+    std::string m_path;
+    unsigned const m_threads;
+    unsigned const m_writeThreads;
+    std::atomic<bool> m_running{false};
 
-protected:
-    void Listen() override;
-    void CloseConnection(int _socket) override;
-    size_t Write(int _connection, std::string const& _data) override;
-    size_t Read(int _connection, void* _data, size_t _size) override;
+    boost::asio::io_context m_io;
+    boost::asio::local::stream_protocol::acceptor m_acceptor{m_io};
+    /// Open connections, only touched on the I/O thread while it runs.
+    std::set<std::shared_ptr<Connection>> m_connections;
+    std::thread m_ioThread;
 
-    sockaddr_un m_address;
-    std::atomic<int> m_socket{0};
+    std::unique_ptr<ThreadPool> m_readPool;
+    std::unique_ptr<ThreadPool> m_writePool;
 };
 
 }  // namespace dev
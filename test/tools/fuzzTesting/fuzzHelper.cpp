@@ -12,8 +12,10 @@
 
 using namespace dev;
 using namespace std;
-const static std::array<eth::Instruction, 47> invalidOpcodes {{
+const static std::array<eth::Instruction, 49> invalidOpcodes {{
 	eth::Instruction::INVALID,
+	eth::Instruction::SWAP1POP,
+	eth::Instruction::POP2,
 	eth::Instruction::PUSHC,
 	eth::Instruction::JUMPC,
 	eth::Instruction::JUMPCI,
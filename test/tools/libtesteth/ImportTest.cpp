@@ -353,8 +353,8 @@ std::tuple<eth::State, ImportTest::ExecOutput, eth::ChangeLog> ImportTest::execu
             StandardTrace st;
             st.setShowMnemonics();
             st.setOptions(Options::get().jsontraceOptions);
+            st.setOutput(cout);
             out = initialState.execute(_env, *se.get(), _tr, Permanence::Committed, st.onOp());
-            cout << st.multilineTrace();
             cout << "{\"stateRoot\": \"" << initialState.rootHash().hex() << "\"}";
         }
         else
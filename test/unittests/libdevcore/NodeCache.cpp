@@ -0,0 +1,77 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libdevcore/MemoryDB.h>
+#include <libdevcore/NodeCache.h>
+#include <libdevcore/OverlayDB.h>
+#include <libdevcore/SHA3.h>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace dev;
+
+TEST(NodeCache, lookupCountsHitsAndMisses)
+{
+    NodeCache cache(1024 * 1024);
+    h256 const key = sha3("node");
+    EXPECT_EQ(cache.lookup(key), "");
+
+    cache.insert(key, "value");
+    EXPECT_EQ(cache.lookup(key), "value");
+    EXPECT_TRUE(cache.contains(key));
+
+    NodeCache::Stats const stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.entries, 1);
+    EXPECT_DOUBLE_EQ(stats.hitRate(), 0.5);
+}
+
+TEST(NodeCache, evictsLeastRecentlyUsedWithinBudget)
+{
+    // 16 shards of 1 KB each.
+    NodeCache cache(16 * 1024);
+    string const value(200, 'x');
+
+    vector<h256> keys;
+    for (unsigned i = 0; i < 1000; ++i)
+    {
+        keys.push_back(sha3(to_string(i)));
+        cache.insert(keys.back(), value);
+        // Keep the first key hot.
+        cache.lookup(keys.front());
+    }
+
+    EXPECT_LE(cache.stats().bytes, cache.capacity());
+    EXPECT_TRUE(cache.contains(keys.front()));
+    EXPECT_FALSE(cache.contains(keys[1]));
+    EXPECT_TRUE(cache.contains(keys.back()));
+}
+
+TEST(NodeCache, skipsValuesLargerThanShard)
+{
+    NodeCache cache(16 * 1024);
+    h256 const key = sha3("big");
+    cache.insert(key, string(2048, 'x'));
+    EXPECT_FALSE(cache.contains(key));
+}
+
+TEST(NodeCache, overlayReadsThroughCache)
+{
+    OverlayDB db(unique_ptr<db::DatabaseFace>(new db::MemoryDB), 1024 * 1024);
+    string const value = "trie node";
+    h256 const key = sha3(value);
+    db.insert(key, &value);
+    db.commit();
+
+    // Committed nodes are cached and copies share the cache.
+    OverlayDB copy = db;
+    EXPECT_EQ(copy.lookup(key), value);
+    EXPECT_TRUE(copy.exists(key));
+    EXPECT_EQ(db.cacheStats().hits, 1);
+    EXPECT_EQ(db.cacheStats().misses, 0);
+
+    OverlayDB uncached(unique_ptr<db::DatabaseFace>(new db::MemoryDB));
+    EXPECT_EQ(uncached.cacheStats().entries, 0);
+}
@@ -0,0 +1,111 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libdevcore/ShardedLruCache.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace std;
+using namespace dev;
+
+namespace
+{
+/// Puts keys 0, 16, 32... into the same shard.
+struct Identity
+{
+    size_t operator()(unsigned _key) const { return _key; }
+};
+
+struct Parity
+{
+    static constexpr unsigned size = 2;
+    unsigned operator()(unsigned _key) const { return _key % 2; }
+};
+
+using Cache = ShardedLruCache<unsigned, string, Identity>;
+using GroupedCache = ShardedLruCache<unsigned, string, Identity, Parity>;
+}  // namespace
+
+TEST(ShardedLruCache, insertKeepsOrReplaces)
+{
+    Cache cache(16 * 1024);
+    cache.insert(1, "a", 10);
+    cache.insert(1, "b", 20, false);
+
+    string value;
+    ASSERT_TRUE(cache.lookup(1, value));
+    EXPECT_EQ(value, "a");
+    EXPECT_EQ(cache.stats().bytes, 10);
+
+    cache.insert(1, "c", 30);
+    ASSERT_TRUE(cache.lookup(1, value));
+    EXPECT_EQ(value, "c");
+    EXPECT_EQ(cache.stats().bytes, 30);
+    EXPECT_EQ(cache.stats().entries, 1);
+}
+
+TEST(ShardedLruCache, evictsLeastRecentlyUsedOfShard)
+{
+    // 16 shards of 100 bytes each.
+    Cache cache(1600);
+    cache.insert(0, "0", 40);
+    cache.insert(16, "16", 40);
+    string value;
+    EXPECT_TRUE(cache.lookup(0, value));
+    cache.insert(32, "32", 40);
+
+    EXPECT_TRUE(cache.contains(0));
+    EXPECT_FALSE(cache.contains(16));
+    EXPECT_TRUE(cache.contains(32));
+    EXPECT_EQ(cache.stats().bytes, 80);
+
+    // Bigger than a shard's part of the budget.
+    cache.insert(48, "48", 101);
+    EXPECT_FALSE(cache.contains(48));
+}
+
+TEST(ShardedLruCache, shrinksOnNextInsertion)
+{
+    Cache cache(1600);
+    cache.insert(0, "0", 40);
+    cache.insert(16, "16", 40);
+    cache.setCapacity(800);
+    EXPECT_EQ(cache.capacity(), 800);
+    EXPECT_EQ(cache.stats().bytes, 80);
+
+    cache.insert(32, "32", 40);
+    EXPECT_EQ(cache.stats().entries, 1);
+    EXPECT_TRUE(cache.contains(32));
+}
+
+TEST(ShardedLruCache, countsPerGroup)
+{
+    GroupedCache cache(16 * 1024);
+    for (unsigned i = 0; i < 10; ++i)
+        cache.insert(i, to_string(i), 10 + i % 2);
+
+    string value;
+    EXPECT_TRUE(cache.lookup(1, value));
+    EXPECT_FALSE(cache.lookup(11, value));
+    EXPECT_FALSE(cache.lookup(13, value));
+
+    GroupedCache::Stats const odd = cache.stats(1);
+    EXPECT_EQ(odd.entries, 5);
+    EXPECT_EQ(odd.bytes, 55);
+    EXPECT_EQ(odd.hits, 1);
+    EXPECT_EQ(odd.misses, 2);
+    EXPECT_EQ(cache.stats(0).bytes, 50);
+    EXPECT_EQ(cache.stats().entries, 10);
+
+    cache.clear(1);
+    EXPECT_EQ(cache.stats(1).entries, 0);
+    EXPECT_EQ(cache.stats().entries, 5);
+    EXPECT_TRUE(cache.contains(2));
+
+    cache.erase(2);
+    EXPECT_FALSE(cache.contains(2));
+    cache.clear();
+    EXPECT_EQ(cache.stats().bytes, 0);
+}
@@ -0,0 +1,52 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libdevcore/ThreadPool.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+
+using namespace std;
+using namespace dev;
+
+TEST(ThreadPool, parallelForVisitsEveryIndexOnce)
+{
+    ThreadPool pool(4);
+    vector<atomic<unsigned>> visits(1000);
+    for (auto& v : visits)
+        v = 0;
+
+    pool.parallelFor(visits.size(), [&](size_t _i) {
+        ++visits[_i];
+        return true;
+    });
+
+    for (auto const& v : visits)
+        EXPECT_EQ(v, 1u);
+}
+
+TEST(ThreadPool, parallelForStopsEarly)
+{
+    ThreadPool pool(4);
+    atomic<size_t> calls{0};
+    pool.parallelFor(100000, [&](size_t) { return ++calls < 10; });
+
+    // Items already handed out when the stop was requested still run, but no new ones.
+    EXPECT_GE(calls, 10u);
+    EXPECT_LT(calls, 100000u);
+}
+
+TEST(ThreadPool, parallelForFromPoolThread)
+{
+    ThreadPool pool(1);
+    atomic<size_t> inner{0};
+    pool.parallelFor(4, [&](size_t) {
+        pool.parallelFor(8, [&](size_t) {
+            ++inner;
+            return true;
+        });
+        return true;
+    });
+    EXPECT_EQ(inner, 32u);
+}
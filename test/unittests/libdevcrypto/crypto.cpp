@@ -148,6 +148,40 @@ BOOST_AUTO_TEST_CASE(SignAndRecoverLoop)
     }
 }
 
+BOOST_AUTO_TEST_CASE(verifyBatchQuorum)
+{
+    auto const msg = h256::random();
+    vector<pair<Public, Signature>> sigs;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        auto const kp = KeyPair::create();
+        // Every fourth signature is made over a different message.
+        auto const sig = sign(kp.secret(), i % 4 ? msg : sha3(msg));
+        sigs.emplace_back(kp.pub(), sig);
+    }
+
+    BOOST_CHECK_EQUAL(verifyBatch(sigs, msg), 12);
+    BOOST_CHECK_EQUAL(verifyBatch(sigs, msg, 5), 5);
+    BOOST_CHECK_EQUAL(verifyBatch(sigs, msg, 13), 12);
+    BOOST_CHECK_EQUAL(verifyBatch({}, msg), 0);
+}
+
+BOOST_AUTO_TEST_CASE(verifyBatchCountsKeysOnce)
+{
+    auto const msg = h256::random();
+    auto const a = KeyPair::create();
+    auto const b = KeyPair::create();
+    auto const sigA = sign(a.secret(), msg);
+
+    BOOST_CHECK_EQUAL(verifyBatch({{a.pub(), sigA}, {a.pub(), sigA}}, msg), 1);
+    // A key counts if any of its signatures is valid.
+    BOOST_CHECK_EQUAL(verifyBatch({{a.pub(), sigA}, {b.pub(), sign(b.secret(), sha3(msg))},
+                                      {b.pub(), sign(b.secret(), msg)}},
+                          msg),
+        2);
+    BOOST_CHECK_EQUAL(verifyBatch({{a.pub(), sigA}, {b.pub(), sign(b.secret(), sha3(msg))}}, msg), 1);
+}
+
 BOOST_AUTO_TEST_CASE(cryptopp_patch)
 {
     KeyPair k = KeyPair::create();
@@ -66,6 +66,80 @@ BOOST_AUTO_TEST_CASE(Mining_1_mineBlockWithTransaction)
     BOOST_REQUIRE(bc.getInterface().transactions().size() > 0);
 }
 
+BOOST_AUTO_TEST_CASE(logIndex)
+{
+    auto const preLogIndex = logIndexEnabled();
+    setLogIndexEnabled(true);
+
+    TestBlockChain bc(TestBlockChain::defaultGenesisBlock());
+
+    // Creates a contract whose init code logs topic 0xaa: PUSH1 0xaa PUSH1 0 PUSH1 0 LOG1
+    TestTransaction defaultTr = TestTransaction::defaultTransaction(1, 1, 100000);
+    json_spirit::mObject txObj = defaultTr.jsonObject();
+    txObj["to"] = "";
+    txObj["data"] = "0x60aa60006000a1";
+    TestTransaction tr(txObj);
+    TestBlock block;
+    block.addTransaction(tr);
+    block.mine(bc);
+    bc.addBlock(block);
+
+    BlockChain const& chain = bc.getInterface();
+    Transaction const& t = tr.transaction();
+    Address const contract = right160(sha3(rlpList(t.sender(), t.nonce())));
+    BOOST_REQUIRE_EQUAL(chain.logIndexFrom(), 1);
+    BOOST_CHECK(chain.withLogIndex(contract, h256(0xaa), 0, 1) == vector<unsigned>{1});
+    BOOST_CHECK(chain.withLogIndex(contract, h256(), 0, 1) == vector<unsigned>{1});
+    BOOST_CHECK(chain.withLogIndex(contract, h256(0xbb), 0, 1).empty());
+    BOOST_CHECK(chain.withLogIndex(contract, h256(0xaa), 2, 10).empty());
+    BOOST_CHECK(chain.withLogIndex(t.sender(), h256(), 0, 1).empty());
+
+    setLogIndexEnabled(preLogIndex);
+}
+
+BOOST_AUTO_TEST_CASE(logIndexAppendsBlocks)
+{
+    auto const preLogIndex = logIndexEnabled();
+    setLogIndexEnabled(true);
+
+    TestBlockChain bc(TestBlockChain::defaultGenesisBlock());
+    auto const mineWith = [&](json_spirit::mObject const& _txObj) {
+        TestTransaction tr(_txObj);
+        TestBlock block;
+        block.addTransaction(tr);
+        block.mine(bc);
+        bc.addBlock(block);
+        return tr.transaction();
+    };
+
+    // Block 1 deploys code logging topic 0xaa (PUSH1 0xaa PUSH1 0 PUSH1 0 LOG1), which blocks
+    // 2 and 4 call. All of them fall into the same bucket.
+    json_spirit::mObject txObj = TestTransaction::defaultTransaction(1, 1, 100000).jsonObject();
+    txObj["to"] = "";
+    txObj["data"] = "0x6007600c60003960076000f360aa60006000a1";
+    Transaction const deploy = mineWith(txObj);
+    Address const contract = right160(sha3(rlpList(deploy.sender(), deploy.nonce())));
+
+    txObj = TestTransaction::defaultTransaction(2, 1, 100000).jsonObject();
+    txObj["to"] = toHexPrefixed(contract.asBytes());
+    mineWith(txObj);
+
+    TestBlock empty;
+    empty.mine(bc);
+    bc.addBlock(empty);
+
+    txObj["nonce"] = "3";
+    mineWith(txObj);
+
+    BlockChain const& chain = bc.getInterface();
+    BOOST_REQUIRE_EQUAL(chain.number(), 4);
+    BOOST_CHECK(chain.withLogIndex(contract, h256(0xaa), 0, 10) == (vector<unsigned>{2, 4}));
+    BOOST_CHECK(chain.withLogIndex(contract, h256(), 0, 10) == (vector<unsigned>{2, 4}));
+    BOOST_CHECK(chain.withLogIndex(contract, h256(0xaa), 3, 10) == vector<unsigned>{4});
+
+    setLogIndexEnabled(preLogIndex);
+}
+
 BOOST_AUTO_TEST_CASE(Mining_2_mineUncles)
 {
     TestBlockChain bc(TestBlockChain::defaultGenesisBlock());
@@ -366,17 +440,18 @@ BOOST_AUTO_TEST_CASE(updateStats)
     stat = bcRef.usage(true);
     BOOST_CHECK_EQUAL(stat.memBlockHashes, 0);
 
-    unsigned const memBlocksExpected = block.bytes().size() + 64;
+    unsigned const memBlocksExpected = block.bytes().size() + ChainCache::c_entryOverhead;
     BOOST_CHECK_EQUAL(stat.memBlocks, memBlocksExpected);
     unsigned totalExpected = memBlocksExpected;
 
     h256 const genesisHash = bc.testGenesis().blockHeader().hash();
-    unsigned const memDetailsExpected = bcRef.details(genesisHash).size + 64;
+    unsigned const memDetailsExpected = bcRef.details(genesisHash).size + ChainCache::c_entryOverhead;
     BOOST_CHECK_EQUAL(stat.memDetails, memDetailsExpected);
     totalExpected += memDetailsExpected;
 
-    unsigned const memLogBloomsExpected =
-        bcRef.blocksBlooms(0, 0).size + 64 + bcRef.blocksBlooms(1, 0).size + 64;
+    unsigned const memLogBloomsExpected = bcRef.blocksBlooms(0, 0).size +
+                                          bcRef.blocksBlooms(1, 0).size +
+                                          2 * ChainCache::c_entryOverhead;
     BOOST_CHECK_EQUAL(stat.memLogBlooms, memLogBloomsExpected);
     totalExpected += memLogBloomsExpected;
 
@@ -384,8 +459,8 @@ BOOST_AUTO_TEST_CASE(updateStats)
     BOOST_CHECK_EQUAL(stat.memTotal(), totalExpected);
     BOOST_CHECK_EQUAL(stat.memTransactionAddresses, 0);
 
-    //memchache size 33554432 - 3500 blocks before cache to be cleared
     bcRef.garbageCollect(true);
+    BOOST_CHECK_EQUAL(bcRef.usage().memTotal(), 0);
 }
 
 BOOST_AUTO_TEST_CASE(invalidJsonThrows)
@@ -0,0 +1,180 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// BodyRequestTracker tests.
+#include <libethereum/BodyRequestTracker.h>
+#include <test/tools/libtesteth/TestHelper.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+using Clock = BodyRequestTracker::Clock;
+
+p2p::NodeID const c_slowPeer{1};
+p2p::NodeID const c_peerB{2};
+p2p::NodeID const c_peerC{3};
+
+vector<unsigned> blocks(unsigned _first, unsigned _count)
+{
+    vector<unsigned> ret;
+    for (unsigned i = 0; i < _count; ++i)
+        ret.push_back(_first + i);
+    return ret;
+}
+
+/// Gives @a _peer a throughput of @a _count bodies per @a _seconds.
+void measure(BodyRequestTracker& _tracker, p2p::NodeID const& _peer, unsigned _count,
+    double _seconds, Clock::time_point _now)
+{
+    _tracker.requested(_peer, blocks(1, _count), _now);
+    _tracker.received(_peer, _count,
+        _now + chrono::duration_cast<Clock::duration>(chrono::duration<double>(_seconds)));
+    _tracker.remove(_peer);
+}
+
+/// Takes over from the request holding @a _block for @a _peer. @returns the numbers taken.
+vector<unsigned> takeOver(BodyRequestTracker& _tracker, p2p::NodeID const& _peer,
+    unsigned _block, Clock::time_point _now)
+{
+    vector<unsigned> taken;
+    _tracker.takeOver(_peer, _block, _now, [&](unsigned _number) {
+        taken.push_back(_number);
+        return true;
+    });
+    return taken;
+}
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(BodyRequestTrackerSuite, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(requestSizeFollowsThroughput)
+{
+    BodyRequestTracker tracker;
+    auto const now = Clock::now();
+    BOOST_CHECK_EQUAL(tracker.requestSize(c_peerB), BodyRequestTracker::c_initialRequestBodies);
+
+    measure(tracker, c_peerB, 100, 1, now);
+    BOOST_CHECK_EQUAL(tracker.requestSize(c_peerB), 200);
+
+    // The rate is a moving average of the answers
+    measure(tracker, c_peerB, 300, 1, now);
+    BOOST_CHECK_EQUAL(tracker.requestSize(c_peerB), 400);
+
+    measure(tracker, c_slowPeer, 1, 10, now);
+    BOOST_CHECK_EQUAL(tracker.requestSize(c_slowPeer), BodyRequestTracker::c_minRequestBodies);
+
+    measure(tracker, c_peerC, 1024, 0.1, now);
+    BOOST_CHECK_EQUAL(tracker.requestSize(c_peerC), BodyRequestTracker::c_maxRequestBodies);
+
+    tracker.peerGone(c_peerC);
+    BOOST_CHECK_EQUAL(tracker.requestSize(c_peerC), BodyRequestTracker::c_initialRequestBodies);
+}
+
+BOOST_AUTO_TEST_CASE(answerCountsOnlyRequestedBodies)
+{
+    BodyRequestTracker tracker;
+    auto const now = Clock::now();
+    tracker.requested(c_peerB, blocks(1, 16), now);
+    tracker.received(c_peerB, 1000, now + chrono::seconds(1));
+    BOOST_CHECK_EQUAL(tracker.requestSize(c_peerB), BodyRequestTracker::c_minRequestBodies * 2);
+}
+
+BOOST_AUTO_TEST_CASE(lookaheadLimits)
+{
+    BOOST_CHECK_EQUAL(BodyRequestTracker::bodiesEnd(0), 1 + BodyRequestTracker::c_maxBodiesLookahead);
+    BOOST_CHECK_EQUAL(
+        BodyRequestTracker::bodiesEnd(1000), 1001 + BodyRequestTracker::c_maxBodiesLookahead);
+    BOOST_CHECK_EQUAL(
+        BodyRequestTracker::headersEnd(1000), 1001 + BodyRequestTracker::c_maxHeadersLookahead);
+    BOOST_CHECK_LT(BodyRequestTracker::c_maxBodiesLookahead,
+        BodyRequestTracker::c_maxHeadersLookahead);
+}
+
+BOOST_AUTO_TEST_CASE(slowPeerIsTakenOverAfterTimeout)
+{
+    BodyRequestTracker tracker;
+    auto const sent = Clock::now();
+    tracker.requested(c_slowPeer, blocks(1, 16), sent);
+
+    // Unknown throughput is expected to answer within c_targetResponseSeconds
+    BOOST_CHECK(takeOver(tracker, c_peerB, 1, sent + chrono::seconds(3)).empty());
+    BOOST_CHECK(takeOver(tracker, c_peerB, 1, sent + chrono::seconds(4)) == blocks(1, 16));
+
+    // Only one peer at a time takes over
+    BOOST_CHECK(takeOver(tracker, c_peerC, 1, sent + chrono::seconds(5)).empty());
+    // The slow peer doesn't take over its own request
+    BOOST_CHECK(takeOver(tracker, c_slowPeer, 1, sent + chrono::seconds(20)).empty());
+    // Blocks not in the request aren't taken over
+    BOOST_CHECK(takeOver(tracker, c_peerC, 17, sent + chrono::seconds(20)).empty());
+}
+
+BOOST_AUTO_TEST_CASE(slowPeerIsTakenOverAgainAfterAnotherTimeout)
+{
+    BodyRequestTracker tracker;
+    auto const sent = Clock::now();
+    tracker.requested(c_slowPeer, blocks(1, 16), sent);
+    BOOST_CHECK(!takeOver(tracker, c_peerB, 1, sent + chrono::seconds(4)).empty());
+    // c_peerB asks for the blocks too, the slow peer's request is still the one found first
+    tracker.requested(c_peerB, blocks(1, 16), sent + chrono::seconds(4));
+
+    BOOST_CHECK(takeOver(tracker, c_peerC, 1, sent + chrono::seconds(7)).empty());
+    BOOST_CHECK(!takeOver(tracker, c_peerC, 1, sent + chrono::seconds(8)).empty());
+}
+
+BOOST_AUTO_TEST_CASE(nothingPickedIsNotATakeOver)
+{
+    BodyRequestTracker tracker;
+    auto const sent = Clock::now();
+    tracker.requested(c_slowPeer, blocks(1, 16), sent);
+
+    BOOST_CHECK(!tracker.takeOver(
+        c_peerB, 1, sent + chrono::seconds(4), [](unsigned) { return false; }));
+    BOOST_CHECK(takeOver(tracker, c_peerC, 1, sent + chrono::seconds(4)) == blocks(1, 16));
+}
+
+BOOST_AUTO_TEST_CASE(knownThroughputSetsTimeout)
+{
+    BodyRequestTracker tracker;
+    auto const now = Clock::now();
+    // 4 bodies per second, so 64 bodies are expected in 16 s
+    measure(tracker, c_slowPeer, 4, 1, now);
+    tracker.requested(c_slowPeer, blocks(1, 64), now);
+
+    BOOST_CHECK(takeOver(tracker, c_peerB, 1, now + chrono::seconds(31)).empty());
+    BOOST_CHECK(!takeOver(tracker, c_peerB, 1, now + chrono::seconds(32)).empty());
+}
+
+BOOST_AUTO_TEST_CASE(slowerPeerDoesNotTakeOver)
+{
+    BodyRequestTracker tracker;
+    auto const now = Clock::now();
+    measure(tracker, c_peerB, 1, 10, now);
+    tracker.requested(c_slowPeer, blocks(1, 16), now);
+
+    // The slow peer has delivered nothing for 4 s, but 16 bodies in 4 s beat 0.1 per second
+    BOOST_CHECK(takeOver(tracker, c_peerB, 1, now + chrono::seconds(4)).empty());
+    BOOST_CHECK(!takeOver(tracker, c_peerC, 1, now + chrono::seconds(4)).empty());
+}
+
+BOOST_AUTO_TEST_CASE(goneRequestsAreForgotten)
+{
+    BodyRequestTracker tracker;
+    auto const now = Clock::now();
+    measure(tracker, c_peerC, 10, 1, now);
+    tracker.requested(c_slowPeer, blocks(1, 16), now);
+    BOOST_CHECK(!tracker.empty());
+    BOOST_CHECK(tracker.peers() == vector<p2p::NodeID>({c_slowPeer, c_peerC}));
+
+    BOOST_CHECK(tracker.peerGone(c_slowPeer) == blocks(1, 16));
+    BOOST_CHECK(tracker.empty());
+    BOOST_CHECK(takeOver(tracker, c_peerB, 1, now + chrono::seconds(10)).empty());
+    BOOST_CHECK(tracker.peers() == vector<p2p::NodeID>({c_peerC}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
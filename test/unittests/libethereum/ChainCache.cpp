@@ -0,0 +1,88 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libethereum/ChainCache.h>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+TEST(ChainCache, lookupAndStatsPerKind)
+{
+    ChainCache cache(1024 * 1024);
+    h256 const key(1);
+
+    string value;
+    EXPECT_FALSE(cache.lookup(key, 0, value));
+    cache.insert(key, 0, string("details"), 7);
+    cache.insert(key, 1, bytes{1, 2, 3}, 3);
+
+    ASSERT_TRUE(cache.lookup(key, 0, value));
+    EXPECT_EQ(value, "details");
+    bytes b;
+    ASSERT_TRUE(cache.lookup(key, 1, b));
+    EXPECT_EQ(b, (bytes{1, 2, 3}));
+
+    ChainCache::Stats const s = cache.stats(0);
+    EXPECT_EQ(s.hits, 1);
+    EXPECT_EQ(s.misses, 1);
+    EXPECT_EQ(s.entries, 1);
+    EXPECT_EQ(s.bytes, 7 + ChainCache::c_entryOverhead);
+    EXPECT_EQ(cache.stats().entries, 2);
+}
+
+TEST(ChainCache, replaceUpdatesSize)
+{
+    ChainCache cache(1024 * 1024);
+    h256 const key(2);
+    cache.insert(key, 3, 1u, 100);
+    cache.insert(key, 3, 2u, 10);
+
+    unsigned value = 0;
+    ASSERT_TRUE(cache.lookup(key, 3, value));
+    EXPECT_EQ(value, 2u);
+    EXPECT_EQ(cache.stats(3).entries, 1);
+    EXPECT_EQ(cache.stats(3).bytes, 10 + ChainCache::c_entryOverhead);
+
+    cache.populate(key, 3, 3u, 10);
+    ASSERT_TRUE(cache.lookup(key, 3, value));
+    EXPECT_EQ(value, 2u);
+}
+
+TEST(ChainCache, staysWithinBudget)
+{
+    size_t const capacity = 64 * 1024;
+    ChainCache cache(capacity);
+    for (unsigned i = 0; i < 10000; ++i)
+        cache.insert(h256(i), i % 2, i, 100);
+
+    EXPECT_LE(cache.stats().bytes, capacity);
+    // The most recent entries survive.
+    unsigned value = 0;
+    EXPECT_TRUE(cache.lookup(h256(9999), 1, value));
+    EXPECT_FALSE(cache.lookup(h256(0), 0, value));
+}
+
+TEST(ChainCache, eraseAndClearKind)
+{
+    ChainCache cache(1024 * 1024);
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        cache.insert(h256(i), 0, i, 10);
+        cache.insert(h256(i), 1, i, 10);
+    }
+
+    cache.erase(h256(3), 0);
+    EXPECT_FALSE(cache.contains(h256(3), 0));
+    EXPECT_TRUE(cache.contains(h256(3), 1));
+
+    cache.clear(1);
+    EXPECT_EQ(cache.stats(1).entries, 0);
+    EXPECT_EQ(cache.stats(1).bytes, 0);
+    EXPECT_EQ(cache.stats(0).entries, 9);
+
+    cache.clear();
+    EXPECT_EQ(cache.stats().bytes, 0);
+}
@@ -5,6 +5,7 @@
 #include <boost/test/unit_test.hpp>
 #include <libdevcore/CommonJS.h>
 #include <libethashseal/Ethash.h>
+#include <test/tools/libtesteth/BlockChainHelper.h>
 #include <test/tools/libtesteth/TestOutputHelper.h>
 #include <test/tools/libtesteth/TestUtils.h>
 #include <test/tools/libtestutils/FixedClient.h>
@@ -205,3 +206,61 @@ BOOST_AUTO_TEST_CASE(blocks)
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_FIXTURE_TEST_SUITE(ClientBaseLogsSuite, FrontierNoProofTestFixture)
+
+BOOST_AUTO_TEST_CASE(logsPagedByWholeBlocks)
+{
+	TestBlockChain bc(TestBlockChain::defaultGenesisBlock());
+	for (unsigned nonce = 1; nonce <= 3; ++nonce)
+	{
+		// Creates a contract whose init code logs topic 0xaa twice.
+		json_spirit::mObject txObj = TestTransaction::defaultTransaction(nonce, 1, 100000).jsonObject();
+		txObj["to"] = "";
+		txObj["data"] = "0x60aa60006000a160aa60006000a1";
+		TestBlock block;
+		block.addTransaction(TestTransaction(txObj));
+		block.mine(bc);
+		bc.addBlock(block);
+	}
+
+	FixedClient client(bc.getInterface(), Block(Block::Null));
+	LogFilter const filter = LogFilter().withLatest(LatestBlockHash);
+	BOOST_REQUIRE_EQUAL(client.logs(filter).size(), 6);
+
+	// A page of three entries cannot take a second block of two.
+	vector<unsigned> pageBlocks;
+	boost::optional<unsigned> cursor;
+	do
+	{
+		LocalisedLogEntries const page = client.logs(filter, 3, cursor);
+		BOOST_REQUIRE_EQUAL(page.size(), 2);
+		BOOST_CHECK_EQUAL(page.front().blockNumber, page.back().blockNumber);
+		pageBlocks.push_back(page.front().blockNumber);
+	} while (cursor);
+	BOOST_CHECK(pageBlocks == (vector<unsigned>{1, 2, 3}));
+
+	// A block larger than the limit still makes a page of its own.
+	cursor = boost::none;
+	BOOST_CHECK_EQUAL(client.logs(filter, 1, cursor).size(), 2);
+	BOOST_REQUIRE(cursor);
+	BOOST_CHECK_EQUAL(*cursor, 2);
+
+	// Without a cap everything fits the first page, which is also the last.
+	cursor = boost::none;
+	BOOST_CHECK_EQUAL(client.logs(filter, 0, cursor).size(), 6);
+	BOOST_CHECK(!cursor);
+}
+
+BOOST_AUTO_TEST_CASE(logsResumeAtGenesis)
+{
+	TestBlockChain bc(TestBlockChain::defaultGenesisBlock());
+	FixedClient client(bc.getInterface(), Block(Block::Null));
+
+	// A cursor of 0 resumes at the genesis block instead of meaning the last page.
+	boost::optional<unsigned> cursor = 0u;
+	BOOST_CHECK(client.logs(LogFilter().withLatest(LatestBlockHash), 1, cursor).empty());
+	BOOST_CHECK(!cursor);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,108 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// EIP-2124 fork id tests.
+#include <libethereum/ForkId.h>
+#include <test/tools/libtesteth/TestHelper.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+h256 const c_mainnetGenesis{"d4e56740f876aef8c010b86a40d5f56745a118d0906a34e69aec8c0db1cb8fa3"};
+// Homestead, DAO, EIP150, EIP158, Byzantium, Constantinople and Petersburg, Istanbul,
+// Muir Glacier.
+vector<uint64_t> const c_mainnetForks{
+    1150000, 1920000, 2463000, 2675000, 4370000, 7280000, 7280000, 9069000, 9200000};
+// The same chain as known by a node that doesn't know Istanbul and later.
+vector<uint64_t> const c_petersburgForks{
+    1150000, 1920000, 2463000, 2675000, 4370000, 7280000, 7280000};
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(ForkIdSuite, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(mainnetForkIds)
+{
+    ForkIds const ids{c_mainnetGenesis, c_mainnetForks};
+
+    BOOST_CHECK_EQUAL(ids.at(0), (ForkId{0xfc64ec04, 1150000}));
+    BOOST_CHECK_EQUAL(ids.at(1149999), (ForkId{0xfc64ec04, 1150000}));
+    BOOST_CHECK_EQUAL(ids.at(1150000), (ForkId{0x97c2c34c, 1920000}));
+    BOOST_CHECK_EQUAL(ids.at(1919999), (ForkId{0x97c2c34c, 1920000}));
+    BOOST_CHECK_EQUAL(ids.at(1920000), (ForkId{0x91d1f948, 2463000}));
+    BOOST_CHECK_EQUAL(ids.at(2463000), (ForkId{0x7a64da13, 2675000}));
+    BOOST_CHECK_EQUAL(ids.at(2675000), (ForkId{0x3edd5b10, 4370000}));
+    BOOST_CHECK_EQUAL(ids.at(4370000), (ForkId{0xa00bc324, 7280000}));
+    BOOST_CHECK_EQUAL(ids.at(7279999), (ForkId{0xa00bc324, 7280000}));
+    BOOST_CHECK_EQUAL(ids.at(7280000), (ForkId{0x668db0af, 9069000}));
+    BOOST_CHECK_EQUAL(ids.at(9069000), (ForkId{0x879d6e30, 9200000}));
+    BOOST_CHECK_EQUAL(ids.at(9200000), (ForkId{0xe029e991, 0}));
+    BOOST_CHECK_EQUAL(ids.at(10000000), (ForkId{0xe029e991, 0}));
+}
+
+BOOST_AUTO_TEST_CASE(forkIdRlp)
+{
+    ForkId const id{0xe029e991, 9200000};
+    RLPStream s;
+    id.streamRLP(s);
+    BOOST_CHECK_EQUAL(toHex(s.out()), "c984e029e991838c6180");
+    BOOST_CHECK_EQUAL(ForkId::fromRLP(RLP(s.out())), id);
+
+    bytes const shortHash = fromHex("c883e029e9838c6180");
+    BOOST_CHECK_THROW(ForkId::fromRLP(RLP(shortHash)), RLPException);
+}
+
+BOOST_AUTO_TEST_CASE(acceptsSameForks)
+{
+    ForkIds const ids{c_mainnetGenesis, c_mainnetForks};
+
+    BOOST_CHECK(ids.check(ids.at(7987396), 7987396).empty());
+    // The peer knows a later fork we don't pass yet.
+    ForkIds const petersburg{c_mainnetGenesis, c_petersburgForks};
+    BOOST_CHECK(petersburg.check(ids.at(7987396), 7987396).empty());
+    // We know a fork the peer doesn't, but haven't passed it.
+    BOOST_CHECK(ids.check(petersburg.at(7987396), 7987396).empty());
+}
+
+BOOST_AUTO_TEST_CASE(rejectsPassedNextFork)
+{
+    // The peer expects a fork at a block we have passed without it: we would need an update.
+    ForkIds const petersburg{c_mainnetGenesis, c_petersburgForks};
+    BOOST_CHECK(!petersburg.check(ForkId{0x668db0af, 9069000}, 9069000).empty());
+    BOOST_CHECK(petersburg.check(ForkId{0x668db0af, 9069000}, 9068999).empty());
+}
+
+BOOST_AUTO_TEST_CASE(acceptsSyncingPeer)
+{
+    ForkIds const ids{c_mainnetGenesis, c_mainnetForks};
+
+    // The peer is behind and knows the next fork.
+    BOOST_CHECK(ids.check(ForkId{0x91d1f948, 2463000}, 7987396).empty());
+    // It is behind and doesn't know the fork it is about to pass.
+    BOOST_CHECK(!ids.check(ForkId{0x91d1f948, 0}, 7987396).empty());
+    BOOST_CHECK(!ids.check(ForkId{0x91d1f948, 2500000}, 7987396).empty());
+}
+
+BOOST_AUTO_TEST_CASE(acceptsPeerAheadOfUs)
+{
+    ForkIds const ids{c_mainnetGenesis, c_mainnetForks};
+
+    BOOST_CHECK(ids.check(ForkId{0xe029e991, 0}, 0).empty());
+    BOOST_CHECK(ids.check(ForkId{0x668db0af, 9069000}, 4370000).empty());
+}
+
+BOOST_AUTO_TEST_CASE(rejectsOtherChain)
+{
+    ForkIds const ids{c_mainnetGenesis, c_mainnetForks};
+    ForkIds const other{h256{1}, c_mainnetForks};
+
+    BOOST_CHECK(!ids.check(other.at(7987396), 7987396).empty());
+    BOOST_CHECK(!ids.check(ForkId{0xafec6b27, 0}, 7987396).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,99 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// PooledTransactionFetcher tests.
+#include <libethereum/PooledTransactionFetcher.h>
+#include <test/tools/libtesteth/TestHelper.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+p2p::NodeID const c_peerA{1};
+p2p::NodeID const c_peerB{2};
+p2p::NodeID const c_peerC{3};
+h256 const c_tx1{1};
+h256 const c_tx2{2};
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(PooledTransactionFetcherSuite, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(requestsEachTransactionOnce)
+{
+    PooledTransactionFetcher fetcher;
+    auto const now = PooledTransactionFetcher::Clock::now();
+
+    BOOST_CHECK(fetcher.request(c_peerA, {c_tx1, c_tx2, c_tx1}, now) == h256s({c_tx1, c_tx2}));
+    BOOST_CHECK(fetcher.request(c_peerB, {c_tx1, c_tx2}, now).empty());
+    BOOST_CHECK_EQUAL(fetcher.inFlight(), 2);
+
+    fetcher.delivered(c_tx1);
+    BOOST_CHECK_EQUAL(fetcher.inFlight(), 1);
+    BOOST_CHECK(fetcher.request(c_peerB, {c_tx1, c_tx2}, now) == h256s({c_tx1}));
+}
+
+BOOST_AUTO_TEST_CASE(asksNextAnnouncerAfterTimeout)
+{
+    PooledTransactionFetcher fetcher;
+    auto const now = PooledTransactionFetcher::Clock::now();
+    auto const timeout = chrono::seconds(PooledTransactionFetcher::c_requestTimeout);
+
+    fetcher.request(c_peerA, {c_tx1, c_tx2}, now);
+    BOOST_CHECK(fetcher.request(c_peerB, {c_tx1}, now).empty());
+    BOOST_CHECK(fetcher.request(c_peerC, {c_tx1}, now).empty());
+
+    BOOST_CHECK(fetcher.expire(now + timeout - chrono::seconds(1)).empty());
+    BOOST_CHECK_EQUAL(fetcher.inFlight(), 2);
+
+    // tx2 had no other announcer and is dropped.
+    auto retries = fetcher.expire(now + timeout);
+    BOOST_CHECK(retries == PooledTransactionFetcher::Retries({{c_peerB, {c_tx1}}}));
+    BOOST_CHECK_EQUAL(fetcher.inFlight(), 1);
+
+    retries = fetcher.expire(now + 2 * timeout);
+    BOOST_CHECK(retries == PooledTransactionFetcher::Retries({{c_peerC, {c_tx1}}}));
+
+    BOOST_CHECK(fetcher.expire(now + 3 * timeout).empty());
+    BOOST_CHECK_EQUAL(fetcher.inFlight(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(asksNextAnnouncerWhenPeerLeaves)
+{
+    PooledTransactionFetcher fetcher;
+    auto const now = PooledTransactionFetcher::Clock::now();
+
+    fetcher.request(c_peerA, {c_tx1}, now);
+    fetcher.request(c_peerB, {c_tx2}, now);
+    fetcher.request(c_peerB, {c_tx1}, now);
+    fetcher.request(c_peerC, {c_tx1, c_tx2}, now);
+
+    // Leaving as an announcer only doesn't move anything.
+    BOOST_CHECK(fetcher.peerGone(c_peerC, now).empty());
+
+    auto const retries = fetcher.peerGone(c_peerA, now);
+    BOOST_CHECK(retries == PooledTransactionFetcher::Retries({{c_peerB, {c_tx1}}}));
+    BOOST_CHECK_EQUAL(fetcher.inFlight(), 2);
+
+    BOOST_CHECK(fetcher.peerGone(c_peerB, now).empty());
+    BOOST_CHECK_EQUAL(fetcher.inFlight(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(deliveredStopsRetries)
+{
+    PooledTransactionFetcher fetcher;
+    auto const now = PooledTransactionFetcher::Clock::now();
+
+    fetcher.request(c_peerA, {c_tx1}, now);
+    fetcher.request(c_peerB, {c_tx1}, now);
+    fetcher.delivered(c_tx1);
+    BOOST_CHECK(fetcher.peerGone(c_peerA, now).empty());
+    BOOST_CHECK(
+        fetcher.expire(now + chrono::seconds(PooledTransactionFetcher::c_requestTimeout)).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
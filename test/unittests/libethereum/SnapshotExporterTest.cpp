@@ -0,0 +1,163 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libdevcore/TransientDirectory.h>
+#include <libethereum/BlockChain.h>
+#include <libethereum/BlockChainImporter.h>
+#include <libethereum/SnapshotExporter.h>
+#include <libethereum/SnapshotImporter.h>
+#include <libethereum/SnapshotStorage.h>
+#include <libethereum/State.h>
+#include <libethereum/StateImporter.h>
+#include <test/tools/libtesteth/BlockChainHelper.h>
+#include <test/tools/libtesteth/TestHelper.h>
+
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+class NoBlocksImporter : public BlockChainImporterFace
+{
+public:
+    void importBlock(BlockHeader const&, RLP, RLP, RLP, RLP, u256 const&) override { ++blocks; }
+    void setChainStartBlockNumber(u256 const&) override {}
+
+    unsigned blocks = 0;
+};
+
+class RecordingImporter : public BlockChainImporterFace
+{
+public:
+    struct Block
+    {
+        BlockHeader header;
+        bytes transactions;
+        bytes uncles;
+        size_t extraItems;
+        bytes receipts;
+        u256 totalDifficulty;
+    };
+
+    void importBlock(BlockHeader const& _header, RLP _transactions, RLP _uncles, RLP _extraItems,
+        RLP _receipts, u256 const& _totalDifficulty) override
+    {
+        blocks.push_back({_header, _transactions.data().toBytes(), _uncles.data().toBytes(),
+            _extraItems.itemCount(), _receipts.data().toBytes(), _totalDifficulty});
+    }
+    void setChainStartBlockNumber(u256 const& _number) override { chainStart = _number; }
+
+    std::vector<Block> blocks;
+    u256 chainStart;
+};
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(SnapshotExporterSuite, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(exportedStateImportsToSameRoot)
+{
+    State state{0};
+    bytes const code = fromHex("6001600055");
+    for (unsigned i = 1; i <= 6; ++i)
+    {
+        Address const a{i};
+        state.addBalance(a, i * 1000);
+        // Two contracts share their code, which is written only once.
+        if (i <= 2)
+            state.setCode(a, bytes(code), 0);
+    }
+    // Storage too big for one chunk, so the account gets split.
+    for (unsigned j = 1; j <= 200; ++j)
+        state.setStorage(Address{1}, j, j);
+    state.commit(State::CommitBehaviour::KeepEmptyAccounts);
+
+    TransientDirectory dir;
+    SnapshotExporter exporter(dir.path(), 1024);
+    h256s const stateChunks = exporter.exportStateChunks(state.db(), state.rootHash());
+    BOOST_CHECK_GT(stateChunks.size(), 1);
+    exporter.writeManifest(stateChunks, {}, state.rootHash(), 1, h256{1});
+
+    OverlayDB importedDb;
+    auto stateImporter = createStateImporter(importedDb);
+    NoBlocksImporter blocksImporter;
+    SnapshotImporter importer(*stateImporter, blocksImporter);
+    importer.import(*createSnapshotStorage(dir.path()), h256{});
+
+    BOOST_CHECK_EQUAL(stateImporter->stateRoot(), state.rootHash());
+    BOOST_CHECK_EQUAL(blocksImporter.blocks, 0);
+}
+
+BOOST_AUTO_TEST_CASE(exportedBlocksImportToSameChain)
+{
+    TestBlockChain testBc(TestBlockChain::defaultGenesisBlock());
+    for (unsigned i = 1; i <= 5; ++i)
+    {
+        TestBlock block;
+        // Some blocks with a transaction, so that there are receipts to carry.
+        if (i % 2 == 0)
+            block.addTransaction(TestTransaction::defaultTransaction(i / 2));
+        block.mine(testBc);
+        testBc.addBlock(block);
+    }
+    BlockChain const& bc = testBc.getInterface();
+    BOOST_REQUIRE_EQUAL(bc.number(), 5);
+
+    State state{0};
+    state.addBalance(Address{1}, 1000);
+    state.commit(State::CommitBehaviour::KeepEmptyAccounts);
+
+    TransientDirectory dir;
+    // Every block gets a chunk of its own.
+    SnapshotExporter exporter(dir.path(), 1);
+    h256s const stateChunks = exporter.exportStateChunks(state.db(), state.rootHash());
+    h256s const blockChunks = exporter.exportBlockChunks(bc, bc.currentHash(), 10);
+    BOOST_CHECK_EQUAL(blockChunks.size(), 4);
+    exporter.writeManifest(stateChunks, blockChunks, state.rootHash(), 5, bc.currentHash());
+    BOOST_CHECK_NO_THROW(verifySnapshot(*createSnapshotStorage(dir.path())));
+
+    OverlayDB importedDb;
+    auto stateImporter = createStateImporter(importedDb);
+    RecordingImporter blocksImporter;
+    SnapshotImporter importer(*stateImporter, blocksImporter);
+    importer.import(*createSnapshotStorage(dir.path()), bc.genesisHash());
+
+    // Blocks 2 to 5, with the seal fields of the chain's seal engine.
+    BOOST_REQUIRE_EQUAL(blocksImporter.blocks.size(), 4);
+    BOOST_CHECK_EQUAL(blocksImporter.chainStart, 2);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        auto const& imported = blocksImporter.blocks[i];
+        h256 const hash = bc.numberHash(i + 2);
+        bytes const block = bc.block(hash);
+        RLP const blockRlp(block);
+
+        BOOST_CHECK_EQUAL(imported.header.number(), i + 2);
+        BOOST_CHECK_EQUAL(imported.header.hash(), hash);
+        BOOST_CHECK(imported.transactions == blockRlp[1].data().toBytes());
+        BOOST_CHECK(imported.uncles == blockRlp[2].data().toBytes());
+        BOOST_CHECK_EQUAL(imported.extraItems, 0);
+        BOOST_CHECK(imported.receipts == bc.receipts(hash).rlp());
+        BOOST_CHECK_EQUAL(imported.totalDifficulty, bc.details(hash).totalDifficulty);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(verifySnapshotFindsCorruptChunk)
+{
+    State state{0};
+    state.addBalance(Address{1}, 1000);
+    state.commit(State::CommitBehaviour::KeepEmptyAccounts);
+
+    TransientDirectory dir;
+    SnapshotExporter exporter(dir.path());
+    h256s const stateChunks = exporter.exportStateChunks(state.db(), state.rootHash());
+    BOOST_REQUIRE_EQUAL(stateChunks.size(), 1);
+    exporter.writeManifest(stateChunks, {}, state.rootHash(), 1, h256{1});
+    BOOST_CHECK_NO_THROW(verifySnapshot(*createSnapshotStorage(dir.path())));
+
+    writeFile(boost::filesystem::path(dir.path()) / toHex(stateChunks[0]), bytes{1, 2, 3});
+    BOOST_CHECK_THROW(verifySnapshot(*createSnapshotStorage(dir.path())), ChunkDataCorrupted);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -58,6 +58,7 @@ namespace
 		BlockHeader header;
 		bytes transactions;
 		bytes uncles;
+		bytes extraItems;
 		bytes receipts;
 		u256 totalDifficulty;
 	};
@@ -65,9 +66,9 @@ namespace
 	class MockBlockChainImporter: public BlockChainImporterFace
 	{
 	public:
-		void importBlock(BlockHeader const& _header, RLP _transactions, RLP _uncles, RLP _receipts, u256 const& _totalDifficulty) override
+		void importBlock(BlockHeader const& _header, RLP _transactions, RLP _uncles, RLP _extraItems, RLP _receipts, u256 const& _totalDifficulty) override
 		{
-			importedBlocks.push_back({_header, _transactions.data().toBytes(), _uncles.data().toBytes(), _receipts.data().toBytes(), _totalDifficulty});
+			importedBlocks.push_back({_header, _transactions.data().toBytes(), _uncles.data().toBytes(), _extraItems.data().toBytes(), _receipts.data().toBytes(), _totalDifficulty});
 		}
 		void setChainStartBlockNumber(u256 const& _number) override { chainStartBlockNumber = _number; }
 
@@ -297,26 +298,24 @@ BOOST_AUTO_TEST_CASE(SnapshotImporterSuite_importAccountsWithEqualCode)
 	BOOST_CHECK_EQUAL_COLLECTIONS(importedCode.begin(), importedCode.end(), code.begin(), code.end());
 }
 
-BOOST_AUTO_TEST_CASE(SnapshotImporterSuite_commitStateOnceEveryChunk)
+BOOST_AUTO_TEST_CASE(SnapshotImporterSuite_commitStateOncePerBatchOfChunks)
 {
-	h256 stateChunk1 = sha3("123");
-	h256 stateChunk2 = sha3("789");
-	snapshotStorage.manifest = createManifest(2, {stateChunk1, stateChunk2}, {}, h256{}, 0, h256{});
-
-	h256 addressHash1 = sha3("456");
-	bytes accountPart1 = createAccount(2, 10, 0, {0x80}, {});
-	bytes chunk1 = createStateChunk({{addressHash1, accountPart1}});
-	snapshotStorage.chunks[stateChunk1] = chunk1;
-
-	h256 addressHash2 = sha3("345");
-	bytes accountPart2 = createAccount(2, 10, 0, {0x80}, {});
-	bytes chunk2 = createStateChunk({{addressHash2, accountPart2}});
-	snapshotStorage.chunks[stateChunk2] = chunk2;
+    // One full batch and one chunk more
+    unsigned const chunkCount = SnapshotImporter::c_chunksPerCommit + 1;
+    h256s stateChunks;
+    for (unsigned i = 0; i < chunkCount; ++i)
+    {
+        h256 const stateChunk = sha3("chunk" + toString(i));
+        bytes const account = createAccount(2, 10, 0, {0x80}, {});
+        snapshotStorage.chunks[stateChunk] = createStateChunk({{sha3("account" + toString(i)), account}});
+        stateChunks.push_back(stateChunk);
+    }
+    snapshotStorage.manifest = createManifest(2, stateChunks, {}, h256{}, 0, h256{});
 
     snapshotImporter.import(snapshotStorage, h256{});
 
-    BOOST_REQUIRE_EQUAL(stateImporter.importedAccounts.size(), 2);
-	BOOST_REQUIRE_EQUAL(stateImporter.commitCounter, 2);
+    BOOST_REQUIRE_EQUAL(stateImporter.importedAccounts.size(), chunkCount);
+    BOOST_REQUIRE_EQUAL(stateImporter.commitCounter, 2);
 }
 
 
@@ -387,4 +386,72 @@ BOOST_AUTO_TEST_CASE(SnapshotImporterSuite_importBlockWithTransactions)
 	BOOST_CHECK_EQUAL_COLLECTIONS(importedBlock.receipts.begin(), importedBlock.receipts.end(), receipts.begin(), receipts.end());
 }
 
+BOOST_AUTO_TEST_CASE(SnapshotImporterSuite_importBlockWithoutSealFields)
+{
+	h256 blockChunk = sha3("123");
+	snapshotStorage.manifest = createManifest(2, {}, {blockChunk}, h256{}, 0, h256{});
+
+	// A chain whose seal engine uses no seal fields, like Qpos.
+	RLPStream abridged(10);
+	abridged << Address("111") << h256(sha3("222")) << h2048(333) << u256(1) << u256(555)
+		<< u256(0) << u256(777) << bytes{};
+	abridged.appendRaw(RLPEmptyList).appendRaw(RLPEmptyList);
+	snapshotStorage.chunks[blockChunk] = createSingleBlockChunk(345, sha3("678"), 910, abridged.out(), RLPEmptyList);
+
+	snapshotImporter.import(snapshotStorage, h256{});
+
+	BOOST_REQUIRE_EQUAL(blockChainImporter.importedBlocks.size(), 1);
+	BlockHeader const& header = blockChainImporter.importedBlocks.front().header;
+	RLPStream headerRlp;
+	header.streamRLP(headerRlp);
+	BOOST_CHECK_EQUAL(RLP(headerRlp.out()).itemCount(), BlockHeader::BasicFields);
+	BOOST_CHECK(blockChainImporter.importedBlocks.front().extraItems.empty());
+}
+
+BOOST_AUTO_TEST_CASE(SnapshotImporterSuite_importBlockWithExtraItems)
+{
+	h256 blockChunk = sha3("123");
+	snapshotStorage.manifest = createManifest(2, {}, {blockChunk}, h256{}, 0, h256{});
+
+	// Two seal fields, then the block's items after the uncles, like Qpos' signature list.
+	RLPStream signatures(2);
+	signatures << 1;
+	signatures.appendList(1) << h512(1);
+	RLPStream extraItems(1);
+	extraItems.appendRaw(signatures.out());
+
+	RLPStream abridged(13);
+	abridged << Address("111") << h256(sha3("222")) << h2048(333) << u256(1) << u256(555)
+		<< u256(0) << u256(777) << bytes{};
+	abridged.appendRaw(RLPEmptyList).appendRaw(RLPEmptyList);
+	abridged << h256(sha3("mix")) << h64(42);
+	abridged.appendRaw(extraItems.out());
+	snapshotStorage.chunks[blockChunk] = createSingleBlockChunk(345, sha3("678"), 910, abridged.out(), RLPEmptyList);
+
+	snapshotImporter.import(snapshotStorage, h256{});
+
+	BOOST_REQUIRE_EQUAL(blockChainImporter.importedBlocks.size(), 1);
+	ImportedBlock const& imported = blockChainImporter.importedBlocks.front();
+	RLPStream headerRlp;
+	imported.header.streamRLP(headerRlp);
+	BOOST_CHECK_EQUAL(RLP(headerRlp.out()).itemCount(), BlockHeader::BasicFields + 2);
+	BOOST_CHECK(imported.extraItems == extraItems.out());
+}
+
+BOOST_AUTO_TEST_CASE(SnapshotImporterSuite_importBlockWithListSealFieldFails)
+{
+	h256 blockChunk = sha3("123");
+	snapshotStorage.manifest = createManifest(2, {}, {blockChunk}, h256{}, 0, h256{});
+
+	// Only the last item may be a list.
+	RLPStream abridged(12);
+	abridged << Address("111") << h256(sha3("222")) << h2048(333) << u256(1) << u256(555)
+		<< u256(0) << u256(777) << bytes{};
+	abridged.appendRaw(RLPEmptyList).appendRaw(RLPEmptyList).appendRaw(RLPEmptyList);
+	abridged << h64(42);
+	snapshotStorage.chunks[blockChunk] = createSingleBlockChunk(345, sha3("678"), 910, abridged.out(), RLPEmptyList);
+
+	BOOST_CHECK_THROW(snapshotImporter.import(snapshotStorage, h256{}), InvalidBlockChunkData);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,7 @@
 #include <test/tools/libtesteth/TestHelper.h>
 #include <libethereum/BlockChain.h>
 #include <libethereum/Block.h>
+#include <libethereum/StateCheckpoints.h>
 #include <libethcore/BasicAuthority.h>
 
 using namespace std;
@@ -107,6 +108,67 @@ BOOST_AUTO_TEST_CASE(SetEmptyCodeNonZeroVersion)
     BOOST_CHECK(!s.db().exists(EmptySHA3));
 }
 
+BOOST_AUTO_TEST_CASE(StateCheckpointsNearest)
+{
+    Address addr{"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"};
+    h256 const block{1};
+    StateCheckpoints checkpoints;
+    State s{0};
+
+    // Off by default.
+    checkpoints.record(block, 4, s);
+    BOOST_CHECK_EQUAL(checkpoints.nearest(block, 4, s), 0);
+
+    checkpoints.setInterval(4);
+    for (unsigned i = 1; i <= 10; ++i)
+    {
+        s.addBalance(addr, 1);
+        s.commit(State::CommitBehaviour::KeepEmptyAccounts);
+        checkpoints.record(block, i, s);
+    }
+
+    State r{0};
+    BOOST_CHECK_EQUAL(checkpoints.nearest(block, 3, r), 0);
+    BOOST_CHECK_EQUAL(checkpoints.nearest(block, 7, r), 4);
+    BOOST_CHECK_EQUAL(r.balance(addr), 4);
+    BOOST_CHECK_EQUAL(checkpoints.nearest(block, 10, r), 8);
+    BOOST_CHECK_EQUAL(r.balance(addr), 8);
+    BOOST_CHECK_EQUAL(checkpoints.nearest(h256{2}, 10, r), 0);
+
+    checkpoints.setInterval(0);
+    BOOST_CHECK_EQUAL(checkpoints.nearest(block, 10, r), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelStorageCommitMatchesSequential)
+{
+    // Committing all accounts at once builds their storage tries in parallel; committing them
+    // one by one builds each trie directly in the state DB.
+    State parallel{0};
+    State sequential{0};
+    for (unsigned round = 1; round <= 2; ++round)
+    {
+        for (unsigned i = 1; i <= 8; ++i)
+        {
+            Address const a{i};
+            for (State* s : {&parallel, &sequential})
+            {
+                s->addBalance(a, 1);
+                for (unsigned j = 1; j <= 5; ++j)
+                    // The second round clears the first slot of every account.
+                    s->setStorage(a, j, j == 1 && round == 2 ? 0 : i * j * round);
+            }
+            sequential.commit(State::CommitBehaviour::KeepEmptyAccounts);
+        }
+        parallel.commit(State::CommitBehaviour::KeepEmptyAccounts);
+        BOOST_CHECK_EQUAL(parallel.rootHash(), sequential.rootHash());
+    }
+
+    State reopened{0, parallel.db()};
+    reopened.setRoot(parallel.rootHash());
+    BOOST_CHECK_EQUAL(reopened.storage(Address{3}, 1), 0);
+    BOOST_CHECK_EQUAL(reopened.storage(Address{3}, 5), 30);
+}
+
 class AddressRangeTestFixture : public TestOutputHelperFixture
 {
 public:
@@ -242,4 +242,26 @@ BOOST_AUTO_TEST_CASE(CheckLowSForUnsignedTransactionThrows)
     BOOST_REQUIRE_THROW(tx.checkLowS(), TransactionIsUnsigned);
 }
 
+BOOST_AUTO_TEST_CASE(RecoverSendersInParallel)
+{
+    Transactions txs;
+    std::vector<Address> senders;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        KeyPair const key = KeyPair::create();
+        Transaction const signedTx(0, 0, 21000, Address(i + 1), bytes(), i, key.secret());
+        RLPStream s;
+        signedTx.streamRLP(s);
+        txs.emplace_back(s.out(), CheckTransaction::Cheap);
+        senders.push_back(key.address());
+    }
+    txs.emplace_back(0, 0, 21000, Address(1), bytes(), 0);
+
+    recoverSenders(txs);
+
+    for (size_t i = 0; i < senders.size(); ++i)
+        BOOST_CHECK_EQUAL(txs[i].sender(), senders[i]);
+    BOOST_REQUIRE_THROW(txs.back().sender(), TransactionIsUnsigned);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
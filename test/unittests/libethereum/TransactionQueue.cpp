@@ -222,6 +222,18 @@ BOOST_AUTO_TEST_CASE(tqDrop)
     BOOST_REQUIRE(tq.topTransactions(4).size() == 0);
 }
 
+BOOST_AUTO_TEST_CASE(tqTransactionByHash)
+{
+    TransactionQueue tq;
+    TestTransaction testTransaction = TestTransaction::defaultTransaction();
+    h256 const hash = testTransaction.transaction().sha3();
+    BOOST_CHECK(!tq.transaction(hash));
+    tq.import(testTransaction.transaction().rlp());
+    BOOST_CHECK(tq.transaction(hash) == testTransaction.transaction());
+    tq.drop(hash);
+    BOOST_CHECK(!tq.transaction(hash));
+}
+
 BOOST_AUTO_TEST_CASE(tqLimit)
 {
     TransactionQueue tq(5, 3);
@@ -260,6 +272,40 @@ BOOST_AUTO_TEST_CASE(tqLimit)
     BOOST_REQUIRE(topTr.size() == 1); // 1 imported transaction
 }
 
+BOOST_AUTO_TEST_CASE(tqConcurrentImport)
+{
+    TransactionQueue tq;
+    Transactions txs;
+    for (size_t i = 0; i < 64; ++i)
+        txs.push_back(TestTransaction::defaultTransaction(i).transaction());
+
+    // Every thread imports every transaction, each must be imported exactly once. Each thread
+    // gets its own copies, as a Transaction caches its hash and sender unsynchronized.
+    std::atomic<unsigned> imported{0};
+    std::atomic<unsigned> unexpected{0};
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 4; ++t)
+        threads.emplace_back([&tq, &imported, &unexpected, txs]() {
+            for (auto const& tx : txs)
+            {
+                ImportResult const res = tq.import(tx);
+                if (res == ImportResult::Success)
+                    ++imported;
+                else if (res != ImportResult::AlreadyKnown)
+                    ++unexpected;
+            }
+        });
+    for (auto& t : threads)
+        t.join();
+
+    BOOST_CHECK_EQUAL(imported.load(), txs.size());
+    BOOST_CHECK_EQUAL(unexpected.load(), 0);
+    BOOST_CHECK_EQUAL(tq.knownTransactions().size(), txs.size());
+    BOOST_CHECK_EQUAL(tq.topTransactions(100).size(), txs.size());
+    for (auto const& tx : txs)
+        BOOST_CHECK(tq.isKnown(tx.sha3()));
+}
+
 BOOST_AUTO_TEST_CASE(tqEqueue)
 {
     TransactionQueue tq;
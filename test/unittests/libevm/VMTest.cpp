@@ -2,10 +2,12 @@
 // Copyright 2018-2019 Aleth Authors.
 // Licensed under the GNU General Public License, Version 3.
 
+#include <libaleth-interpreter/CodeAnalysisCache.h>
 #include <libaleth-interpreter/interpreter.h>
 #include <libethereum/LastBlockHashesFace.h>
 #include <libevm/EVMC.h>
 #include <libevm/LegacyVM.h>
+#include <libevm/VMFactory.h>
 #include <test/tools/jsontests/vm.h>
 #include <test/tools/libtesteth/BlockChainHelper.h>
 #include <test/tools/libtesteth/TestOutputHelper.h>
@@ -597,6 +599,21 @@ public:
     }
 
 
+    void testChainIDWorksInRecycledFrame(VMKind _kind)
+    {
+        ExtVM extVm(state, envInfo, *se, address, address, address, value, gasPrice, {}, ref(code),
+            sha3(code), version, depth, isCreate, staticCall);
+
+        // The second frame runs on the instance the first one gave back to the pool.
+        for (int i = 0; i < 2; ++i)
+        {
+            VMPtr frame = VMFactory::create(_kind);
+            u256 frameGas = gas;
+            owning_bytes_ref ret = frame->exec(frameGas, extVm, OnOpFunc{});
+            BOOST_REQUIRE_EQUAL(fromBigEndian<int>(ret), 1);
+        }
+    }
+
     BlockHeader blockHeader{initBlockHeader()};
     LastBlockHashes lastBlockHashes;
     Address address{KeyPair::create().address()};
@@ -740,6 +757,160 @@ public:
     std::unique_ptr<VMFace> vm;
 };
 
+class AnalysisCacheFixture : public TestOutputHelperFixture
+{
+public:
+    AnalysisCacheFixture() { state.addBalance(address, 1 * ether); }
+
+    void run(bytes const& _code, h256 const& _codeHash, bool _isCreate = false)
+    {
+        ExtVM extVm(state, envInfo, *se, address, address, address, value, gasPrice, {},
+            ref(_code), _codeHash, version, depth, _isCreate, staticCall);
+        u256 g = gas;
+        vm->exec(g, extVm, OnOpFunc{});
+    }
+
+    uint64_t hits() const { return CodeAnalysisCache::instance().hits() - hitsBefore; }
+    uint64_t misses() const { return CodeAnalysisCache::instance().misses() - missesBefore; }
+
+    void testSecondCallHits()
+    {
+        run(code, sha3(code));
+        BOOST_CHECK_EQUAL(misses(), 1);
+        BOOST_CHECK_EQUAL(hits(), 0);
+
+        run(code, sha3(code));
+        BOOST_CHECK_EQUAL(misses(), 1);
+        BOOST_CHECK_EQUAL(hits(), 1);
+    }
+
+    void testKeyedByCode()
+    {
+        // The analysis is found by the code, whatever hash the account claims for it.
+        run(code, h256{1});
+        run(code, sha3(code));
+        BOOST_CHECK_EQUAL(misses(), 1);
+        BOOST_CHECK_EQUAL(hits(), 1);
+
+        // Other code under the same claimed hash gets its own analysis.
+        bytes const otherCode = fromHex("7f") + h256::random().asBytes() + fromHex("50");
+        run(otherCode, h256{1});
+        BOOST_CHECK_EQUAL(misses(), 2);
+        BOOST_CHECK_EQUAL(hits(), 1);
+    }
+
+    void testInitCodeNotCached()
+    {
+        run(code, sha3(code), true);
+        run(code, sha3(code), true);
+        BOOST_CHECK_EQUAL(misses(), 0);
+        BOOST_CHECK_EQUAL(hits(), 0);
+    }
+
+    BlockHeader blockHeader{initBlockHeader()};
+    LastBlockHashes lastBlockHashes;
+    Address address{KeyPair::create().address()};
+    State state{0};
+    std::unique_ptr<SealEngineFace> se{
+        ChainParams(genesisInfo(Network::IstanbulTest)).createSealEngine()};
+    EnvInfo envInfo{blockHeader, lastBlockHashes, 0, se->chainParams().chainID};
+
+    u256 value = 0;
+    u256 gasPrice = 1;
+    u256 version = IstanbulSchedule.accountVersion;
+    int depth = 0;
+    bool staticCall = false;
+    u256 gas = 1000000;
+
+    // PUSH32 <random> POP, so that no other test has put it into the shared cache.
+    bytes code = fromHex("7f") + h256::random().asBytes() + fromHex("50");
+    uint64_t hitsBefore = CodeAnalysisCache::instance().hits();
+    uint64_t missesBefore = CodeAnalysisCache::instance().misses();
+
+    std::unique_ptr<VMFace> vm{new EVMC{evmc_create_interpreter()}};
+};
+
+/// Runs code through the interpreter, which meters gas and checks the stack once per basic block,
+/// and through LegacyVM, which does so for every instruction, with every amount of gas up to
+/// what the code needs. Exceptional halts all cost the whole gas and are not told apart.
+class BlockMeteringFixture : public TestOutputHelperFixture
+{
+public:
+    struct Outcome
+    {
+        bool success;
+        u256 gasLeft;
+        bytes output;
+
+        bool operator==(Outcome const& _o) const
+        {
+            return success == _o.success && gasLeft == _o.gasLeft && output == _o.output;
+        }
+    };
+
+    Outcome run(VMFace& _vm, bytes const& _code, u256 _gas)
+    {
+        State state{0};
+        state.addBalance(myAddress, 1 * ether);
+        state.setCode(calleeAddress, bytes{calleeCode}, version);
+        ExtVM extVm{state, envInfo, *se, myAddress, myAddress, myAddress, value, gasPrice, {},
+            ref(_code), sha3(_code), version, depth, false, false};
+        try
+        {
+            owning_bytes_ref const output = _vm.exec(_gas, extVm, OnOpFunc{});
+            return {true, _gas, output.toBytes()};
+        }
+        catch (VMException const&)
+        {
+            return {false, 0, {}};
+        }
+    }
+
+    /// Compares both VMs with every amount of gas up to a little more than the code needs.
+    /// @returns the outcome with plenty of gas.
+    Outcome checkSameAsLegacy(bytes const& _code)
+    {
+        Outcome const full = run(*legacy, _code, gas);
+        BOOST_REQUIRE(run(*interpreter, _code, gas) == full);
+
+        u256 const needed = full.success ? gas - full.gasLeft : gas;
+        for (u256 g = 0; g <= needed + 2 && g <= c_maxSweep; ++g)
+            BOOST_CHECK_MESSAGE(
+                run(*interpreter, _code, g) == run(*legacy, _code, g), "gas " << g);
+        // Around the limit of longer code.
+        for (u256 g = max<u256>(needed, 2) - 2; g <= needed + 2; ++g)
+            BOOST_CHECK_MESSAGE(
+                run(*interpreter, _code, g) == run(*legacy, _code, g), "gas " << g);
+        return full;
+    }
+
+    static u256 word(bytes const& _output) { return fromBigEndian<u256>(_output); }
+
+    static constexpr unsigned c_maxSweep = 4000;
+
+    BlockHeader blockHeader{initBlockHeader()};
+    LastBlockHashes lastBlockHashes;
+    Address myAddress{KeyPair::create().address()};
+    Address calleeAddress{KeyPair::create().address()};
+    std::unique_ptr<SealEngineFace> se{
+        ChainParams(genesisInfo(Network::IstanbulTest)).createSealEngine()};
+    EnvInfo envInfo{blockHeader, lastBlockHashes, 0, se->chainParams().chainID};
+
+    u256 value = 0;
+    u256 gasPrice = 1;
+    u256 version = IstanbulSchedule.accountVersion;
+    int depth = 0;
+    u256 gas = 1000000;
+
+    // mstore(0, gas()) return(0, 32)
+    bytes calleeCode = fromHex("5a60005260206000f3");
+
+    std::unique_ptr<VMFace> legacy{new LegacyVM};
+    std::unique_ptr<VMFace> interpreter{new EVMC{evmc_create_interpreter()}};
+};
+
+constexpr unsigned BlockMeteringFixture::c_maxSweep;
+
 class LegacyVMBalanceFixture : public BalanceFixture
 {
 public:
@@ -1174,6 +1345,11 @@ BOOST_AUTO_TEST_CASE(LegacyVMChainIDisInvalidBeforeIstanbul)
 {
     testChainIDisInvalidBeforeIstanbul();
 }
+
+BOOST_AUTO_TEST_CASE(LegacyVMChainIDworksInRecycledFrame)
+{
+    testChainIDWorksInRecycledFrame(VMKind::Legacy);
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_FIXTURE_TEST_SUITE(LegacyVMBalanceSuite, LegacyVMBalanceFixture)
@@ -1382,6 +1558,11 @@ BOOST_AUTO_TEST_CASE(AlethInterpreterChainIDisInvalidBeforeIstanbul)
 {
     testChainIDisInvalidBeforeIstanbul();
 }
+
+BOOST_AUTO_TEST_CASE(AlethInterpreterChainIDworksInRecycledFrame)
+{
+    testChainIDWorksInRecycledFrame(VMKind::Interpreter);
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_FIXTURE_TEST_SUITE(AlethInterpreterBalanceSuite, AlethInterpreterBalanceFixture)
@@ -1397,4 +1578,100 @@ BOOST_AUTO_TEST_CASE(AlethInterpreterSelfBalanceisInvalidBeforeIstanbul)
 }
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_FIXTURE_TEST_SUITE(AlethInterpreterAnalysisCacheSuite, AnalysisCacheFixture)
+
+BOOST_AUTO_TEST_CASE(AlethInterpreterAnalysisCacheSecondCallHits)
+{
+    testSecondCallHits();
+}
+
+BOOST_AUTO_TEST_CASE(AlethInterpreterAnalysisCacheKeyedByCode)
+{
+    testKeyedByCode();
+}
+
+BOOST_AUTO_TEST_CASE(AlethInterpreterAnalysisCacheInitCodeNotCached)
+{
+    testInitCodeNotCached();
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_FIXTURE_TEST_SUITE(AlethInterpreterBlockMeteringSuite, BlockMeteringFixture)
+
+BOOST_AUTO_TEST_CASE(AlethInterpreterOutOfGasAtBlockBoundary)
+{
+    // mstore(0, add(1, 2)) JUMPDEST return(0, 32): two blocks, split at the JUMPDEST.
+    Outcome const full = checkSameAsLegacy(fromHex("60016002016000525b60206000f3"));
+    BOOST_CHECK(full.success);
+    BOOST_CHECK_EQUAL(word(full.output), 3);
+}
+
+BOOST_AUTO_TEST_CASE(AlethInterpreterJumpiNotTaken)
+{
+    // jumpi(15, 0) mstore(0, 7) return(0, 32) 15: JUMPDEST STOP
+    Outcome const notTaken = checkSameAsLegacy(fromHex("6000600f57600760005260206000f35b00"));
+    BOOST_CHECK_EQUAL(word(notTaken.output), 7);
+
+    // The same jumping.
+    Outcome const taken = checkSameAsLegacy(fromHex("6001600f57600760005260206000f35b00"));
+    BOOST_CHECK(taken.success);
+    BOOST_CHECK(taken.output.empty());
+}
+
+BOOST_AUTO_TEST_CASE(AlethInterpreterGasMidBlock)
+{
+    // pop(1) mstore(0, gas()) pop(add(1, 2)) return(0, 32)
+    checkSameAsLegacy(fromHex("6001505a60005260016002015060206000f3"));
+}
+
+BOOST_AUTO_TEST_CASE(AlethInterpreterSstoreMidBlock)
+{
+    // sstore(0, 1) pop(add(1, 2)) STOP: SSTORE needs more than the 2300 stipend left.
+    checkSameAsLegacy(fromHex("600160005560016002015000"));
+}
+
+BOOST_AUTO_TEST_CASE(AlethInterpreterCallMidBlock)
+{
+    // call(gas(), callee, 0, 0, 0, 0, 32) pop(add(1, 2)) return(0, 32): the callee returns the
+    // gas it was given, all but 1/64 of what the caller had left.
+    bytes const code = fromHex("6020600060006000600073") + calleeAddress.asBytes() +
+                       fromHex("5af15060016002015060206000f3");
+    Outcome const full = checkSameAsLegacy(code);
+    BOOST_CHECK(full.success);
+    BOOST_CHECK(word(full.output) > 0);
+}
+
+BOOST_AUTO_TEST_CASE(AlethInterpreterStackUnderflowInBlock)
+{
+    // add(1, <nothing>)
+    BOOST_CHECK(!checkSameAsLegacy(fromHex("600101")).success);
+    // swap1 with one item, a fusion candidate.
+    BOOST_CHECK(!checkSameAsLegacy(fromHex("60019050")).success);
+}
+
+BOOST_AUTO_TEST_CASE(AlethInterpreterStackOverflowInBlock)
+{
+    bytes pushes;
+    for (unsigned i = 0; i < 1024; ++i)
+        pushes += fromHex("6001");
+
+    BOOST_CHECK(checkSameAsLegacy(pushes + fromHex("00")).success);
+    BOOST_CHECK(!checkSameAsLegacy(pushes + fromHex("600100")).success);
+}
+
+BOOST_AUTO_TEST_CASE(AlethInterpreterFusedSwap1Pop)
+{
+    // swap1 pop of 1 2 leaves 2.
+    Outcome const full = checkSameAsLegacy(fromHex("60016002905060005260206000f3"));
+    BOOST_CHECK_EQUAL(word(full.output), 2);
+}
+
+BOOST_AUTO_TEST_CASE(AlethInterpreterFusedPop2)
+{
+    // pop pop of 1 2 3 leaves 1.
+    Outcome const full = checkSameAsLegacy(fromHex("600160026003505060005260206000f3"));
+    BOOST_CHECK_EQUAL(word(full.output), 1);
+}
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -492,3 +492,35 @@ TEST_F(rlpx, ecies_interop_test_primitives)
     ASSERT_TRUE(s_secp256k1->decryptECIES(kenc.secret(), plainTest3));
     ASSERT_EQ(plainTest3, expectedPlain3);
 }
+
+TEST_F(rlpx, frameCoderReusesOutputBuffer)
+{
+    KeyPair const initiatorKey = KeyPair::create();
+    KeyPair const recipientKey = KeyPair::create();
+    h256 const initiatorNonce = h256::random();
+    h256 const recipientNonce = h256::random();
+    bytes const auth(194, 0xaa);
+    bytes const ack(97, 0xbb);
+    RLPXFrameCoder egress(
+        true, recipientKey.pub(), recipientNonce, initiatorKey, initiatorNonce, &ack, &auth);
+    RLPXFrameCoder ingress(
+        false, initiatorKey.pub(), initiatorNonce, recipientKey, recipientNonce, &ack, &auth);
+
+    // The second packet is framed into the buffer of the first one, which is longer, so stale
+    // bytes would show up in its padding or MAC.
+    bytes frame;
+    for (bytes const& packet : {bytes(100, 0x11), bytes(5, 0x22)})
+    {
+        egress.writeSingleFramePacket(&packet, frame);
+
+        bytesRef header(frame.data(), h256::size);
+        ASSERT_TRUE(ingress.authAndDecryptHeader(header));
+        RLPXFrameInfo const info(header);
+        EXPECT_EQ(packet.size(), info.length);
+        ASSERT_EQ(frame.size(), h256::size + info.length + info.padding + h128::size);
+
+        bytesRef body(frame.data() + h256::size, frame.size() - h256::size);
+        ASSERT_TRUE(ingress.authAndDecryptFrame(body));
+        EXPECT_EQ(packet, bytes(body.data(), body.data() + info.length));
+    }
+}
@@ -0,0 +1,127 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// MinerSetCache and miner quorum tests.
+#include <libethereum/State.h>
+#include <libqpos/MinerSetCache.h>
+#include <test/tools/libtesteth/TestHelper.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+Address const c_nodeContract{9};
+
+set<p2p::NodeID> readMiners(set<p2p::NodeID> const& _miners, unsigned& io_reads)
+{
+    ++io_reads;
+    return _miners;
+}
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(MinerSetCacheSuite, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(changeOfNodeContractIsSeenByNextLookup)
+{
+    State state{0};
+    state.setCode(c_nodeContract, fromHex("6001600055"), 0);
+    state.setStorage(c_nodeContract, 0, 1);
+    state.commit(State::CommitBehaviour::KeepEmptyAccounts);
+
+    MinerSetCache cache;
+    set<p2p::NodeID> const oldMiners{p2p::NodeID{1}, p2p::NodeID{2}};
+    set<p2p::NodeID> const newMiners{p2p::NodeID{3}};
+    unsigned reads = 0;
+    auto const lookup = [&](set<p2p::NodeID> const& _contractMiners) {
+        return cache.get(nodeContractStateKey(state, c_nodeContract), [&](set<p2p::NodeID>& o_miners) {
+            o_miners = readMiners(_contractMiners, reads);
+            return true;
+        });
+    };
+
+    BOOST_CHECK(lookup(oldMiners) == oldMiners);
+    BOOST_CHECK(lookup(oldMiners) == oldMiners);
+    BOOST_CHECK_EQUAL(reads, 1);
+
+    // A block changing something else keeps the key of the node contract.
+    state.addBalance(Address{1}, 100);
+    state.commit(State::CommitBehaviour::KeepEmptyAccounts);
+    BOOST_CHECK(lookup(oldMiners) == oldMiners);
+    BOOST_CHECK_EQUAL(reads, 1);
+
+    // The next block changes the node contract: the lookup at the new head reads the new set.
+    state.setStorage(c_nodeContract, 0, 2);
+    state.commit(State::CommitBehaviour::KeepEmptyAccounts);
+    BOOST_CHECK(lookup(newMiners) == newMiners);
+    BOOST_CHECK_EQUAL(reads, 2);
+    BOOST_CHECK_EQUAL(cache.hits(), 2);
+    BOOST_CHECK_EQUAL(cache.misses(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(uncacheableReadIsReadAgain)
+{
+    MinerSetCache cache;
+    h256 const key{1};
+    unsigned reads = 0;
+    auto const read = [&](set<p2p::NodeID>& o_miners) {
+        o_miners = readMiners({p2p::NodeID{1}}, reads);
+        return false;
+    };
+
+    cache.get(key, read);
+    cache.get(key, read);
+    BOOST_CHECK_EQUAL(reads, 2);
+    BOOST_CHECK_EQUAL(cache.hits(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(minerQuorumAtBoundary)
+{
+    auto const hash = h256::random();
+    vector<KeyPair> miners;
+    set<p2p::NodeID> minerIds;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        miners.push_back(KeyPair::create());
+        minerIds.insert(miners.back().pub());
+    }
+
+    // Four miners need two signatures.
+    vector<pair<p2p::NodeID, Signature>> signs{{miners[0].pub(), sign(miners[0].secret(), hash)}};
+    BOOST_CHECK(!minerQuorumSigned(minerIds, signs, hash));
+    signs.emplace_back(miners[1].pub(), sign(miners[1].secret(), hash));
+    BOOST_CHECK(minerQuorumSigned(minerIds, signs, hash));
+
+    // Nobody needs to sign for an empty set.
+    BOOST_CHECK(minerQuorumSigned({}, {}, hash));
+}
+
+BOOST_AUTO_TEST_CASE(minerQuorumCountsEveryMinerOnce)
+{
+    auto const hash = h256::random();
+    auto const a = KeyPair::create();
+    auto const b = KeyPair::create();
+    auto const c = KeyPair::create();
+    set<p2p::NodeID> const minerIds{a.pub(), b.pub(), c.pub()};
+    auto const signA = sign(a.secret(), hash);
+
+    // The same miner twice does not make two out of three.
+    BOOST_CHECK(!minerQuorumSigned(minerIds, {{a.pub(), signA}, {a.pub(), signA}}, hash));
+
+    // Nor does a signature of a node that is no miner.
+    auto const outsider = KeyPair::create();
+    BOOST_CHECK(!minerQuorumSigned(
+        minerIds, {{a.pub(), signA}, {outsider.pub(), sign(outsider.secret(), hash)}}, hash));
+
+    // An invalid signature is ignored, even when listed before a valid one of the same miner.
+    auto const badB = sign(b.secret(), sha3(hash));
+    BOOST_CHECK(!minerQuorumSigned(minerIds, {{a.pub(), signA}, {b.pub(), badB}}, hash));
+    BOOST_CHECK(minerQuorumSigned(
+        minerIds, {{a.pub(), signA}, {b.pub(), badB}, {b.pub(), sign(b.secret(), hash)}}, hash));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
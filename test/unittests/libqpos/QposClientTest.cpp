@@ -0,0 +1,39 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Tests of how pipelined Qpos sealing follows the block it builds on.
+#include <libqpos/QposClient.h>
+#include <test/tools/libtesteth/TestHelper.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+BOOST_FIXTURE_TEST_SUITE(QposClientSuite, TestOutputHelperFixture)
+
+BOOST_AUTO_TEST_CASE(pipelineParentOk)
+{
+    BOOST_CHECK(pipelineParentOutcome(QueueStatus::Ready, false, false) == PipelineParent::Pending);
+    BOOST_CHECK(pipelineParentOutcome(QueueStatus::Importing, false, false) == PipelineParent::Pending);
+    BOOST_CHECK(pipelineParentOutcome(QueueStatus::UnknownParent, false, false) == PipelineParent::Pending);
+    // Once imported the parent is gone from the queue.
+    BOOST_CHECK(pipelineParentOutcome(QueueStatus::Unknown, true, false) == PipelineParent::Imported);
+}
+
+BOOST_AUTO_TEST_CASE(pipelineParentBad)
+{
+    BOOST_CHECK(pipelineParentOutcome(QueueStatus::Bad, false, false) == PipelineParent::Failed);
+}
+
+BOOST_AUTO_TEST_CASE(pipelineParentDropped)
+{
+    // Neither queued nor imported.
+    BOOST_CHECK(pipelineParentOutcome(QueueStatus::Unknown, false, false) == PipelineParent::Failed);
+    // Another block of the same number made it into the chain first.
+    BOOST_CHECK(pipelineParentOutcome(QueueStatus::Ready, false, true) == PipelineParent::Failed);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,154 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#if !defined(_WIN32)
+
+#include <libdevcore/FileSystem.h>
+#include <libdevcore/TransientDirectory.h>
+#include <libweb3jsonrpc/UnixSocketServer.h>
+
+#include <json/json.h>
+#include <jsonrpccpp/server/iclientconnectionhandler.h>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace std;
+using namespace dev;
+using local = boost::asio::local::stream_protocol;
+
+namespace
+{
+/// eth_sendRawTransaction slowly stores its parameter, every method answers with what is stored.
+class StoringHandler : public jsonrpc::IClientConnectionHandler
+{
+public:
+    void HandleRequest(string const& _request, string& o_response) override
+    {
+        Json::Value call;
+        Json::Reader().parse(_request, call, false);
+        if (call["method"].asString() == "eth_sendRawTransaction")
+        {
+            this_thread::sleep_for(chrono::milliseconds(100));
+            m_value = call["params"][0].asInt();
+        }
+        Json::Value response;
+        response["jsonrpc"] = "2.0";
+        response["id"] = call["id"];
+        response["result"] = m_value.load();
+        o_response = Json::FastWriter().write(response);
+    }
+
+private:
+    atomic<int> m_value{0};
+};
+
+class UnixSocketServerTest : public testing::Test
+{
+protected:
+    UnixSocketServerTest()
+    {
+        setIpcPath(m_dir.path());
+        m_server.reset(new UnixDomainSocketServer("test"));
+        m_server->SetHandler(&m_handler);
+        EXPECT_TRUE(m_server->StartListening());
+        m_socket.connect(local::endpoint(m_dir.path() + "/test.ipc"));
+    }
+
+    ~UnixSocketServerTest() override
+    {
+        m_server->StopListening();
+        setIpcPath({});
+    }
+
+    void send(string const& _data) { boost::asio::write(m_socket, boost::asio::buffer(_data)); }
+
+    Json::Value receive()
+    {
+        boost::asio::read_until(m_socket, m_received, '\n');
+        istream in(&m_received);
+        string line;
+        getline(in, line);
+        Json::Value response;
+        Json::Reader().parse(line, response, false);
+        return response;
+    }
+
+    /// @returns true if the server closes the connection without sending anything.
+    bool closedByServer()
+    {
+        char c;
+        boost::system::error_code ec;
+        boost::asio::read(m_socket, boost::asio::buffer(&c, 1), ec);
+        return ec == boost::asio::error::eof || ec == boost::asio::error::connection_reset;
+    }
+
+    TransientDirectory m_dir;
+    StoringHandler m_handler;
+    unique_ptr<UnixDomainSocketServer> m_server;
+    boost::asio::io_context m_io;
+    local::socket m_socket{m_io};
+    boost::asio::streambuf m_received;
+};
+
+string call(int _id, string const& _method, int _param = 0)
+{
+    return R"({"jsonrpc":"2.0","id":)" + to_string(_id) + R"(,"method":")" + _method +
+           R"(","params":[)" + to_string(_param) + "]}";
+}
+}  // namespace
+
+TEST_F(UnixSocketServerTest, readsSeeEarlierWritesOfTheConnection)
+{
+    send(call(1, "eth_blockNumber") + call(2, "eth_sendRawTransaction", 7) +
+         call(3, "eth_blockNumber") + call(4, "eth_sendRawTransaction", 8) +
+         call(5, "eth_blockNumber"));
+
+    int const expected[] = {0, 7, 7, 8, 8};
+    for (int id = 1; id <= 5; ++id)
+    {
+        Json::Value const response = receive();
+        EXPECT_EQ(response["id"].asInt(), id);
+        EXPECT_EQ(response["result"].asInt(), expected[id - 1]);
+    }
+}
+
+TEST_F(UnixSocketServerTest, requestsSplitAcrossReads)
+{
+    string const request = call(1, R"(eth_{\"[blockNumber)");
+    send(request.substr(0, 10));
+    this_thread::sleep_for(chrono::milliseconds(20));
+    send(request.substr(10) + "\n" + call(2, "eth_blockNumber"));
+
+    EXPECT_EQ(receive()["id"].asInt(), 1);
+    EXPECT_EQ(receive()["id"].asInt(), 2);
+}
+
+TEST_F(UnixSocketServerTest, strayClosingBracketClosesConnection)
+{
+    send("}" + call(1, "eth_blockNumber"));
+    EXPECT_TRUE(closedByServer());
+}
+
+TEST_F(UnixSocketServerTest, overlongRequestClosesConnection)
+{
+    send("[");
+    string const filler(64 * 1024, ' ');
+    boost::system::error_code ec;
+    for (size_t sent = 0; sent <= UnixDomainSocketServer::c_maxRequestSize && !ec;
+         sent += filler.size())
+        boost::asio::write(m_socket, boost::asio::buffer(filler), ec);
+    EXPECT_TRUE(ec || closedByServer());
+}
+
+#endif
@@ -855,4 +855,40 @@ BOOST_AUTO_TEST_CASE(call_from_parameter)
         responseString, "0x000000000000000000000000112233445566778899aabbccddeeff0011223344");
 }
 
+BOOST_AUTO_TEST_CASE(jsonrpc_batchThreads)
+{
+    // The count includes the thread handling the request.
+    rpcServer->setBatchThreads(4);
+    BOOST_CHECK_EQUAL(rpcServer->batchThreads(), 4);
+    rpcServer->setBatchThreads(1);
+    BOOST_CHECK_EQUAL(rpcServer->batchThreads(), 1);
+    rpcServer->setBatchThreads(0);
+    BOOST_CHECK_EQUAL(rpcServer->batchThreads(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(jsonrpc_batchRequest)
+{
+    rpcServer->setBatchThreads(4);
+    BOOST_REQUIRE_EQUAL(rpcServer->batchThreads(), 4);
+
+    string response;
+    client->SendRPCMessage(R"([{"jsonrpc":"2.0","id":1,"method":"eth_gasPrice","params":[]},)"
+                           R"({"jsonrpc":"2.0","id":2,"method":"eth_noSuchMethod","params":[]},)"
+                           R"({"jsonrpc":"2.0","method":"eth_gasPrice","params":[]},)"
+                           R"({"jsonrpc":"2.0","id":3,"method":"net_listening","params":[]}])",
+        response);
+
+    // The notification gets no response, the others keep their order.
+    Json::Value batch;
+    BOOST_REQUIRE(Json::Reader().parse(response, batch));
+    BOOST_REQUIRE(batch.isArray());
+    BOOST_REQUIRE_EQUAL(batch.size(), 3);
+    BOOST_CHECK_EQUAL(batch[0]["id"].asInt(), 1);
+    BOOST_CHECK_EQUAL(batch[0]["result"].asString(), toJS(20 * dev::eth::shannon));
+    BOOST_CHECK_EQUAL(batch[1]["id"].asInt(), 2);
+    BOOST_CHECK(batch[1].isMember("error"));
+    BOOST_CHECK_EQUAL(batch[2]["id"].asInt(), 3);
+    BOOST_CHECK(batch[2].isMember("result"));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -25,7 +25,7 @@ ifdef SOLC
 	SOLC_ASM_= $(SOLC) --assemble $*.asm | grep '^[0-9a-f]\+$\' > $*.bin
 endif
 ifdef ETHVM
-	ETHVM_ = $(call STATS,ethvm) $(ETHVM) $*.bin test; touch $*.ran
+	ETHVM_ = $(call STATS,ethvm) $(ETHVM) $(ETHVM_FLAGS) $*.bin test; touch $*.ran
 endif
 ifdef EVM
 	EVM_ = $(call STATS,evm) $(EVM) --codefile $*.bin run; touch $*.ran
@@ -92,6 +92,16 @@ ops : \
 	div256.ran \
 	exp.ran
 
+# full-width arithmetic only, for comparing VMs or builds before and after a change
+#
+#     make -f tests.mk SOLC=solc ETHVM=ethvm ETHVM_FLAGS="--vm legacy" arith
+#     make -f tests.mk SOLC=solc ETHVM=ethvm ETHVM_FLAGS="--vm interpreter" rerun arith
+arith : \
+	add256.ran \
+	mul256.ran \
+	div256.ran \
+	exp.ran
+
 # C versions for comparison
 C : \
 	popincc.ran \